@@ -11,25 +11,47 @@
 #include "Log.h"
 #include "MemX.h"
 #include "Mqtt.h"
+#include "Playlist.h"
 #include "Port.h"
 #include "Queues.h"
 #include "Rfid.h"
 #include "RotaryEncoder.h"
 #include "SdCard.h"
 #include "System.h"
+#include "TapTrace.h"
 #include "Web.h"
 #include "Wlan.h"
 #include "main.h"
 
+#include <atomic>
 #include <esp_task_wdt.h>
 #include <freertos/task.h>
+#include <new>
 
 #define AUDIOPLAYER_VOLUME_MAX	21u
 #define AUDIOPLAYER_VOLUME_MIN	0u
 #define AUDIOPLAYER_VOLUME_INIT 3u
 
 playProps gPlayProperties;
+audioStats_t gAudioStats;
+
+// Published play-state (seqlock): sequence is odd while a write is in progress, readers retry until they got a copy with unchanged even sequence.
+// Readers don't lock; writers (audio-task, loop() in BT-modes) are serialized by a spinlock.
+static playerState_t AudioPlayer_State;
+static std::atomic<uint32_t> AudioPlayer_StateSeq(0u);
+static portMUX_TYPE AudioPlayer_StateMux = portMUX_INITIALIZER_UNLOCKED;
 TaskHandle_t AudioTaskHandle;
+// Audio-task is stopped when operation-mode is switched. The audio-object is destroyed by the task itself, a stop-request
+// can only be withdrawn as long as the task didn't start with that (AUDIO_TASK_STOP_REQUESTED => AUDIO_TASK_STOPPING).
+enum audioTaskState_t : uint8_t {
+	AUDIO_TASK_RUNNING = 0,
+	AUDIO_TASK_STOP_REQUESTED,
+	AUDIO_TASK_STOPPING,
+	AUDIO_TASK_STOPPED // audio-object (incl. I2S) is destroyed, task is suspended
+};
+static std::atomic<uint8_t> AudioPlayer_TaskState(AUDIO_TASK_RUNNING);
+static TaskHandle_t AudioPlayer_TaskStopRequester = NULL; // notified when AUDIO_TASK_STOPPED is reached
+constexpr uint32_t audioTaskStopTimeout = 10000; // ms; covers connecting to a webstream or a slow SD-access
 // uint32_t cnt123 = 0;
 
 // Volume
@@ -50,6 +72,25 @@ time_t playTimeSecSinceStart = 0;
 // current station logo url
 static String AudioPlayer_StationLogoUrl;
 
+#ifdef PLAY_LAST_RFID_AFTER_REBOOT
+// Playlist-state kept in RTC-memory over deep-sleep. The playlist itself is written to playlistResumeFile, so after wake-up
+// it's read in one go instead of enumerating (and sorting/shuffling) the directory again. Used once after wake-up only.
+constexpr uint32_t audioResumeMagic = 0x31534552; // "RES1"
+
+typedef struct {
+	uint32_t magic;
+	uint32_t playlistId; // AudioPlayer_PlaylistId() of the playlist
+	uint32_t indexHash; // Playlist_Hash() of the playlist written to playlistResumeFile
+	uint32_t filePos; // Offset in current track (in bytes)
+	uint16_t trackNumber;
+	uint16_t numberOfTracks;
+} audioResumeState_t;
+
+RTC_DATA_ATTR static audioResumeState_t AudioPlayer_ResumeState;
+static uint32_t AudioPlayer_CurrentPlaylistId = 0u;
+static uint32_t AudioPlayer_FilePos = 0u; // Offset in current track (in bytes); updated by audio-task every 250 ms
+#endif
+
 #ifdef HEADPHONE_ADJUST_ENABLE
 static bool AudioPlayer_HeadphoneLastDetectionState;
 static uint32_t AudioPlayer_HeadphoneLastDetectionTimestamp = 0u;
@@ -59,11 +100,12 @@ static uint8_t AudioPlayer_MaxVolumeHeadphone = 11u; // Maximum volume that can
 static void AudioPlayer_Task(void *parameter);
 static void AudioPlayer_HeadphoneVolumeManager(void);
 static char **AudioPlayer_ReturnPlaylistFromWebstream(const char *_webUrl);
-static int AudioPlayer_ArrSortHelper(const void *a, const void *b);
-static void AudioPlayer_SortPlaylist(char **arr, int n);
-static void AudioPlayer_RandomizePlaylist(char **str, const uint32_t count);
 static size_t AudioPlayer_NvsRfidWriteWrapper(const char *_rfidCardId, const char *_track, const uint32_t _playPosition, const uint8_t _playMode, const uint16_t _trackLastPlayed, const uint16_t _numberOfTracks);
 static void AudioPlayer_ClearCover(void);
+static void AudioPlayer_PlaylistToQueue(char **musicFiles);
+#ifdef PLAY_LAST_RFID_AFTER_REBOOT
+static char **AudioPlayer_ResumePlaylist(const uint32_t playlistId);
+#endif
 
 void AudioPlayer_Init(void) {
 	// load playtime total from NVS
@@ -90,6 +132,8 @@ void AudioPlayer_Init(void) {
 		gPrefsSettings.putUInt("initVolume", AudioPlayer_GetInitVolume());
 		Log_Println(wroteInitialLoudnessToNvs, LOGLEVEL_ERROR);
 	}
+	// Set once at boot: a restarted audio-task (runtime mode-switch) keeps the current volume
+	AudioPlayer_CurrentVolume = AudioPlayer_GetInitVolume();
 
 	// Get maximum volume for speaker from NVS
 	uint32_t nvsMaxVolumeSpeaker = gPrefsSettings.getUInt("maxVolumeSp", 0);
@@ -125,19 +169,73 @@ void AudioPlayer_Init(void) {
 	gPlayProperties.title[0] = '\0';
 	gPlayProperties.coverFilePos = 0;
 	AudioPlayer_StationLogoUrl = "";
+	AudioPlayer_PublishState();
 
 	// Don't start audio-task in BT-speaker mode!
 	if ((System_GetOperationMode() == OPMODE_NORMAL) || (System_GetOperationMode() == OPMODE_BLUETOOTH_SOURCE)) {
-		xTaskCreatePinnedToCore(
-			AudioPlayer_Task, /* Function to implement the task */
-			"mp3play", /* Name of the task */
-			6000, /* Stack size in words */
-			NULL, /* Task input parameter */
-			2 | portPRIVILEGE_BIT, /* Priority of the task */
-			&AudioTaskHandle, /* Task handle. */
-			1 /* Core where the task should run */
-		);
+		AudioPlayer_StartTask();
+	}
+}
+
+void AudioPlayer_StartTask(void) {
+	if (AudioTaskHandle) {
+		return;
+	}
+	AudioPlayer_TaskState = AUDIO_TASK_RUNNING;
+	xTaskCreatePinnedToCore(
+		AudioPlayer_Task, /* Function to implement the task */
+		"mp3play", /* Name of the task */
+		6000, /* Stack size in words */
+		NULL, /* Task input parameter */
+		2 | portPRIVILEGE_BIT, /* Priority of the task */
+		&AudioTaskHandle, /* Task handle. */
+		1 /* Core where the task should run */
+	);
+}
+
+// Terminates the audio-task (playlist & position are kept, but aren't touched by the task anymore).
+// Returns false if the task didn't get to it within audioTaskStopTimeout; it keeps on running in this case.
+static bool AudioPlayer_TerminateTask(void) {
+	if (!AudioTaskHandle) {
+		return true;
+	}
+	// audio-task destroys its audio-object and suspends itself
+	ulTaskNotifyTake(pdTRUE, 0); // discard stale notification
+	AudioPlayer_TaskStopRequester = xTaskGetCurrentTaskHandle();
+	AudioPlayer_TaskState = AUDIO_TASK_STOP_REQUESTED;
+	const uint32_t stopStart = millis();
+	while (AudioPlayer_TaskState != AUDIO_TASK_STOPPED) {
+		const uint32_t waited = millis() - stopStart;
+		if (waited >= audioTaskStopTimeout) {
+			uint8_t expected = AUDIO_TASK_STOP_REQUESTED;
+			if (AudioPlayer_TaskState.compare_exchange_strong(expected, AUDIO_TASK_RUNNING)) {
+				Log_Println(audioTaskStopTimeoutMsg, LOGLEVEL_ERROR);
+				return false;
+			}
+			// task is destroying its audio-object right now => wait until it's done
+		}
+		ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS((waited < audioTaskStopTimeout) ? (audioTaskStopTimeout - waited) : 10u));
+	}
+	// destructor of audio-object has run, so it's safe to delete the (suspended) task and to construct a new one later
+	vTaskDelete(AudioTaskHandle);
+	AudioTaskHandle = NULL;
+	gPlayProperties.pausePlay = true; // nobody has to wait for a pause anymore (e.g. AudioPlayer_Exit())
+	return true;
+}
+
+// Stops playback and the audio-task (releases audio-buffers and I2S, e.g. for BT-sink).
+// Returns false if the task didn't get to it within audioTaskStopTimeout; it keeps on running in this case.
+bool AudioPlayer_StopTask(void) {
+	if (!AudioPlayer_TerminateTask()) {
+		return false;
 	}
+
+	// playback doesn't survive a switch of operation-mode
+	gPlayProperties.playlistFinished = true;
+	gPlayProperties.playMode = NO_PLAYLIST;
+	Audio_setTitle(noPlaylist);
+	AudioPlayer_ClearCover();
+	return true;
 }
 
 void AudioPlayer_Exit(void) {
@@ -158,6 +256,35 @@ void AudioPlayer_Exit(void) {
 
 static uint32_t lastPlayingTimestamp = 0;
 
+// Publishes audio statistics if they changed (dropouts/underruns immediately, others once per minute)
+static void AudioPlayer_PublishStats(void) {
+	static uint32_t lastStatsTimestamp = 0;
+	static uint32_t lastDropouts = 0;
+	static uint32_t lastUnderruns = 0;
+	static uint32_t lastDecodeCount = 0;
+
+	const bool newDropouts = (gAudioStats.dropouts != lastDropouts) || (gAudioStats.bufferUnderruns != lastUnderruns);
+	if ((millis() - lastStatsTimestamp < 1000) || (!newDropouts && (millis() - lastStatsTimestamp < 60000))) {
+		return;
+	}
+	if (!newDropouts && gAudioStats.decodeTimeHist.count == lastDecodeCount) {
+		return; // nothing played in between
+	}
+	lastStatsTimestamp = millis();
+	lastDropouts = gAudioStats.dropouts;
+	lastUnderruns = gAudioStats.bufferUnderruns;
+	lastDecodeCount = gAudioStats.decodeTimeHist.count;
+
+	Web_SendWebsocketData(0, 90);
+#ifdef MQTT_ENABLE
+	char buf[160];
+	snprintf(buf, sizeof(buf), "{\"dropouts\":%u,\"underruns\":%u,\"reconnects\":%u,\"bufferFill\":%u,\"bufferFillMin\":%u,\"decodeP99\":%u,\"openP99\":%u}",
+		gAudioStats.dropouts, gAudioStats.bufferUnderruns, gAudioStats.webstreamReconnects, gAudioStats.bufferFill, (gAudioStats.bufferFillHist.count ? gAudioStats.bufferFillHist.min : 0u),
+		gAudioStats.decodeTimeHist.percentile(99), gAudioStats.trackOpenTimeHist.percentile(99));
+	publishMqtt(topicAudioStatsState, buf, false);
+#endif
+}
+
 void AudioPlayer_Cyclic(void) {
 	AudioPlayer_HeadphoneVolumeManager();
 	if ((millis() - lastPlayingTimestamp >= 1000) && gPlayProperties.playMode != NO_PLAYLIST && gPlayProperties.playMode != PLAYER_BUSY && !gPlayProperties.pausePlay) {
@@ -165,6 +292,65 @@ void AudioPlayer_Cyclic(void) {
 		lastPlayingTimestamp = millis();
 		playTimeSecSinceStart += 1;
 	}
+	AudioPlayer_PublishStats();
+}
+
+// Publishes gPlayProperties for other tasks if anything has changed (generation is increased in this case)
+void AudioPlayer_PublishState(void) {
+	playerState_t state;
+	memset(&state, 0, sizeof(state)); // defined padding for memcmp()
+	state.playMode = gPlayProperties.playMode;
+	state.pausePlay = gPlayProperties.pausePlay;
+	state.playlistFinished = gPlayProperties.playlistFinished;
+	state.isWebstream = gPlayProperties.isWebstream;
+	state.currentSpeechActive = gPlayProperties.currentSpeechActive;
+	state.repeatCurrentTrack = gPlayProperties.repeatCurrentTrack;
+	state.repeatPlaylist = gPlayProperties.repeatPlaylist;
+	state.currentTrackNumber = gPlayProperties.currentTrackNumber;
+	state.numberOfTracks = gPlayProperties.numberOfTracks;
+	state.currentRelPos = gPlayProperties.currentRelPos;
+	strncpy(state.title, gPlayProperties.title, sizeof(state.title) - 1);
+
+	// Compared without lock, so interrupts aren't disabled if nothing changed (the usual case). If the other writer updates at the same time,
+	// this is seen as change at worst; a change that's missed is published with the next call.
+	if (memcmp(&state, &AudioPlayer_State, sizeof(state)) == 0) {
+		return;
+	}
+	portENTER_CRITICAL(&AudioPlayer_StateMux);
+	AudioPlayer_StateSeq.fetch_add(1u, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	memcpy(&AudioPlayer_State, &state, sizeof(state));
+	AudioPlayer_StateSeq.fetch_add(1u, std::memory_order_release);
+	portEXIT_CRITICAL(&AudioPlayer_StateMux);
+}
+
+// Copies the last published play-state; returns its generation
+uint32_t AudioPlayer_GetState(playerState_t &state) {
+	uint32_t seq;
+	do {
+		seq = AudioPlayer_StateSeq.load(std::memory_order_acquire);
+		if (seq & 1u) {
+			continue; // write in progress
+		}
+		memcpy(&state, &AudioPlayer_State, sizeof(state));
+		std::atomic_thread_fence(std::memory_order_acquire);
+	} while ((seq & 1u) || seq != AudioPlayer_StateSeq.load(std::memory_order_relaxed));
+	return seq >> 1;
+}
+
+// Changes every time a new play-state was published (cheap check whether AudioPlayer_GetState() is necessary)
+uint32_t AudioPlayer_GetStateGeneration(void) {
+	return AudioPlayer_StateSeq.load(std::memory_order_acquire) >> 1;
+}
+
+void AudioPlayer_ResetStats(void) {
+	gAudioStats.dropouts = 0;
+	gAudioStats.bufferUnderruns = 0;
+	gAudioStats.webstreamConnects = 0;
+	gAudioStats.webstreamReconnects = 0;
+	gAudioStats.bufferFillHist.reset();
+	gAudioStats.decodeTimeHist.reset();
+	gAudioStats.trackOpenTimeHist.reset();
 }
 
 // Wrapper-function to reverse detection of connected headphones.
@@ -243,8 +429,7 @@ void Audio_setTitle(const char *format, ...) {
 	vsnprintf(gPlayProperties.title, sizeof(gPlayProperties.title) / sizeof(gPlayProperties.title[0]), format, args);
 	va_end(args);
 
-	// notify web ui and mqtt
-	Web_SendWebsocketData(0, 30);
+	// notify mqtt (web ui is notified by Web_Cyclic() as soon as the new title is published)
 #ifdef MQTT_ENABLE
 	publishMqtt(topicTrackState, gPlayProperties.title, false);
 #endif
@@ -347,8 +532,9 @@ void AudioPlayer_Task(void *parameter) {
 #ifdef BOARD_HAS_PSRAM
 	AudioCustom *audio = new AudioCustom();
 #else
-	static Audio audioAsStatic; // Don't use heap as it's needed for other stuff :-)
-	Audio *audio = &audioAsStatic;
+	// Don't use heap as it's needed for other stuff :-) (constructed in place as the task is restarted when operation-mode is switched)
+	alignas(Audio) static uint8_t audioStorage[sizeof(Audio)];
+	Audio *audio = new (audioStorage) Audio();
 #endif
 
 #ifdef I2S_COMM_FMT_LSB_ENABLE
@@ -357,8 +543,9 @@ void AudioPlayer_Task(void *parameter) {
 
 	constexpr uint32_t playbackTimeout = 2000;
 	uint32_t playbackTimeoutStart = millis();
+	constexpr uint32_t statePublishInterval = 20; // play-state for other tasks (one LED-frame)
+	uint32_t lastStatePublishTimestamp = 0;
 
-	AudioPlayer_CurrentVolume = AudioPlayer_GetInitVolume();
 	audio->setPinout(I2S_BCLK, I2S_LRC, I2S_DOUT);
 	audio->setVolume(AudioPlayer_CurrentVolume, VOLUMECURVE);
 	audio->forceMono(gPlayProperties.currentPlayMono);
@@ -373,8 +560,31 @@ void AudioPlayer_Task(void *parameter) {
 	AudioPlayer_CurrentTime = 0;
 	AudioPlayer_FileDuration = 0;
 	static uint32_t AudioPlayer_LastPlaytimeStatsTimestamp = 0u;
+	bool inBufferEmpty = true;
 
 	for (;;) {
+		uint8_t expectedTaskState = AUDIO_TASK_STOP_REQUESTED;
+		if (AudioPlayer_TaskState.compare_exchange_strong(expectedTaskState, AUDIO_TASK_STOPPING)) {
+			if (gPlayProperties.saveLastPlayPosition && !gPlayProperties.pausePlay && !gPlayProperties.playlistFinished) {
+				AudioPlayer_NvsRfidWriteWrapper(gPlayProperties.playRfidTag, *(gPlayProperties.playlist + gPlayProperties.currentTrackNumber), audio->getFilePos() - audio->inBufferFilled(), gPlayProperties.playMode, gPlayProperties.currentTrackNumber, gPlayProperties.numberOfTracks);
+			}
+#ifdef PLAY_LAST_RFID_AFTER_REBOOT
+			if (!gPlayProperties.pausePlay && !gPlayProperties.playlistFinished && !gPlayProperties.isWebstream) {
+				AudioPlayer_FilePos = audio->getFilePos() - audio->inBufferFilled();
+			}
+#endif
+			audio->stopSong();
+			trackCommand = NO_ACTION;
+#ifdef BOARD_HAS_PSRAM
+			delete audio;
+#else
+			audio->~Audio();
+#endif
+			AudioPlayer_TaskState = AUDIO_TASK_STOPPED;
+			xTaskNotifyGive(AudioPlayer_TaskStopRequester);
+			vTaskSuspend(NULL);
+		}
+
 		/*
 		if (cnt123++ % 100 == 0) {
 			Log_Printf(LOGLEVEL_DEBUG, "%u", uxTaskGetStackHighWaterMark(NULL));
@@ -403,6 +613,9 @@ void AudioPlayer_Task(void *parameter) {
 			if (!gPlayProperties.playlistFinished && !gPlayProperties.isWebstream) {
 				if (!gPlayProperties.pausePlay && (gPlayProperties.seekmode != SEEK_POS_PERCENT) && (audio->getFileSize() > 0)) { // To progress necessary when paused
 					gPlayProperties.currentRelPos = ((double) (audio->getFilePos() - audio->inBufferFilled()) / (double) audio->getFileSize()) * 100;
+#ifdef PLAY_LAST_RFID_AFTER_REBOOT
+					AudioPlayer_FilePos = audio->getFilePos() - audio->inBufferFilled();
+#endif
 				}
 			} else {
 				// calc current fillbuffer percent for webstream
@@ -412,6 +625,11 @@ void AudioPlayer_Task(void *parameter) {
 					gPlayProperties.currentRelPos = 0;
 				}
 			}
+			// Input buffer fill level statistics
+			if (audio->isRunning() && !gPlayProperties.pausePlay && (audio->inBufferSize() > 0)) {
+				gAudioStats.bufferFill = (uint64_t) audio->inBufferFilled() * 100u / audio->inBufferSize();
+				gAudioStats.bufferFillHist.add(gAudioStats.bufferFill);
+			}
 		}
 
 		trackQStatus = xQueueReceive(gTrackQueue, &gPlayProperties.playlist, 0);
@@ -497,7 +715,6 @@ void AudioPlayer_Task(void *parameter) {
 						AudioPlayer_NvsRfidWriteWrapper(gPlayProperties.playRfidTag, *(gPlayProperties.playlist + gPlayProperties.currentTrackNumber), audio->getFilePos() - audio->inBufferFilled(), gPlayProperties.playMode, gPlayProperties.currentTrackNumber, gPlayProperties.numberOfTracks);
 					}
 					gPlayProperties.pausePlay = !gPlayProperties.pausePlay;
-					Web_SendWebsocketData(0, 30);
 					continue;
 
 				case NEXTTRACK:
@@ -584,6 +801,9 @@ void AudioPlayer_Task(void *parameter) {
 							}
 							audio->stopSong();
 							Led_Indicate(LedIndicatorType::Rewind);
+#ifdef PLAY_LAST_RFID_AFTER_REBOOT
+							AudioPlayer_FilePos = 0u;
+#endif
 							audioReturnCode = audio->connecttoFS(gFSystem, *(gPlayProperties.playlist + gPlayProperties.currentTrackNumber));
 							// consider track as finished, when audio lib call was not successful
 							if (!audioReturnCode) {
@@ -698,11 +918,16 @@ void AudioPlayer_Task(void *parameter) {
 			}
 			gPlayProperties.currentRelPos = 0;
 			audioReturnCode = false;
+#ifdef PLAY_LAST_RFID_AFTER_REBOOT
+			AudioPlayer_FilePos = gPlayProperties.startAtFilePos; // position of the previous track mustn't be resumed for this one
+#endif
 
+			const uint32_t trackOpenStart = micros();
 			if (gPlayProperties.playMode == WEBSTREAM || (gPlayProperties.playMode == LOCAL_M3U && gPlayProperties.isWebstream)) { // Webstream
 				audioReturnCode = audio->connecttohost(*(gPlayProperties.playlist + gPlayProperties.currentTrackNumber));
 				gPlayProperties.playlistFinished = false;
 				gTriedToConnectToHost = true;
+				gAudioStats.webstreamConnects++;
 			} else if (gPlayProperties.playMode != WEBSTREAM && !gPlayProperties.isWebstream) {
 				// Files from SD
 				if (!gFSystem.exists(*(gPlayProperties.playlist + gPlayProperties.currentTrackNumber))) { // Check first if file/folder exists
@@ -714,6 +939,11 @@ void AudioPlayer_Task(void *parameter) {
 					// consider track as finished, when audio lib call was not successful
 				}
 			}
+			if (audioReturnCode) {
+				gAudioStats.trackOpenTimeHist.add(micros() - trackOpenStart);
+				TapTrace_Mark(TAP_TRACE_OPENED);
+				inBufferEmpty = true; // buffer is empty right after opening, that's no underrun
+			}
 
 			if (!audioReturnCode) {
 				System_IndicateError();
@@ -816,7 +1046,7 @@ void AudioPlayer_Task(void *parameter) {
 		if (!gPlayProperties.currentSpeechActive && gPlayProperties.lastSpeechActive) {
 			gPlayProperties.lastSpeechActive = false;
 			if (gPlayProperties.playMode != NO_PLAYLIST) {
-				xQueueSend(gRfidCardQueue, gPlayProperties.playRfidTag, 0); // Re-inject previous RFID-ID in order to continue playback
+				xQueueSend(gRfidInjectQueue, gPlayProperties.playRfidTag, 0); // Re-inject previous RFID-ID in order to continue playback
 			}
 		}
 
@@ -833,7 +1063,21 @@ void AudioPlayer_Task(void *parameter) {
 			}
 		}
 
+		const bool audioActive = audio->isRunning() && !gPlayProperties.pausePlay;
+		const uint32_t decodeStart = micros();
 		audio->loop();
+		if (audioActive) {
+			gAudioStats.decodeTimeHist.add(micros() - decodeStart);
+			// count transitions to an empty input buffer (but not at the end of a file)
+			const bool empty = (audio->inBufferSize() > 0) && (audio->inBufferFilled() == 0) && (gPlayProperties.isWebstream || audio->getFilePos() < audio->getFileSize());
+			if (empty && !inBufferEmpty) {
+				gAudioStats.bufferUnderruns++;
+			}
+			inBufferEmpty = empty;
+			if (TapTrace_Pending(TAP_TRACE_FIRST_AUDIO)) {
+				TapTrace_Mark(TAP_TRACE_FIRST_AUDIO);
+			}
+		}
 		if (gPlayProperties.playlistFinished || gPlayProperties.pausePlay) {
 			if (!gPlayProperties.currentSpeechActive) {
 				vTaskDelay(portTICK_PERIOD_MS * 10); // Waste some time if playlist is not active
@@ -862,9 +1106,15 @@ void AudioPlayer_Task(void *parameter) {
 			// we are idle, update timeout so that we do not get a spurious error when launching into a playlist
 			playbackTimeoutStart = millis();
 		}
+		if (millis() - lastStatePublishTimestamp >= statePublishInterval) {
+			lastStatePublishTimestamp = millis();
+			AudioPlayer_PublishState();
+		}
+
 		if ((System_GetOperationMode() == OPMODE_BLUETOOTH_SOURCE) && audio->isRunning()) {
 			// do not delay here, audio task is time critical in BT-Source mode
 		} else {
+			Bluetooth_Source_Flush(); // track ended, stopped or paused
 			vTaskDelay(portTICK_PERIOD_MS * 1);
 		}
 		// esp_task_wdt_reset(); // Don't forget to feed the dog!
@@ -899,7 +1149,13 @@ uint8_t AudioPlayer_GetRepeatMode(void) {
 
 // Adds new volume-entry to volume-queue
 // If volume is changed via webgui or MQTT, it's necessary to re-adjust current value of rotary-encoder.
+// In BT-speaker mode there's no audio-task, so the volume is passed to the phone instead.
 void AudioPlayer_VolumeToQueueSender(const int32_t _newVolume, bool reAdjustRotary) {
+	if (System_GetOperationMode() == OPMODE_BLUETOOTH_SINK) {
+		Bluetooth_SetVolume(_newVolume, reAdjustRotary);
+		return;
+	}
+
 	uint32_t _volume;
 	int32_t _volumeBuf = AudioPlayer_GetCurrentVolume();
 
@@ -961,9 +1217,26 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 
 	gPlayProperties.startAtFilePos = _lastPlayPos;
 	gPlayProperties.currentTrackNumber = _trackLastPlayed;
-	char **musicFiles;
+	char **musicFiles = nullptr;
+	bool resumed = false;
+
+#ifdef PLAY_LAST_RFID_AFTER_REBOOT
+	// FNV-1a over RFID-tag, file/folder and playmode
+	uint32_t playlistId = 2166136261u;
+	for (const char *c : {(const char *) gCurrentId, (const char *) filename}) {
+		for (; *c != '\0'; c++) {
+			playlistId = (playlistId ^ (uint8_t) *c) * 16777619u;
+		}
+		playlistId *= 16777619u; // separator
+	}
+	playlistId = (playlistId ^ _playMode) * 16777619u;
+	AudioPlayer_CurrentPlaylistId = playlistId;
+
+	musicFiles = AudioPlayer_ResumePlaylist(playlistId);
+	resumed = (musicFiles != nullptr);
+#endif
 
-	if (_playMode != WEBSTREAM) {
+	if (!resumed && _playMode != WEBSTREAM) {
 		if (_playMode == RANDOM_SUBDIRECTORY_OF_DIRECTORY || _playMode == RANDOM_SUBDIRECTORY_OF_DIRECTORY_ALL_TRACKS_OF_DIR_RANDOM) {
 			const char *tmp = SdCard_pickRandomSubdirectory(filename); // *filename (input): target-directory  //   *filename (output): random subdirectory
 			if (tmp == NULL) { // If error occured while extracting random subdirectory
@@ -974,13 +1247,14 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 		} else {
 			musicFiles = SdCard_ReturnPlaylist(filename, _playMode);
 		}
-	} else {
+	} else if (!resumed) {
 		musicFiles = AudioPlayer_ReturnPlaylistFromWebstream(filename);
 	}
 
 	// Catch if error occured (e.g. file not found)
 	if (musicFiles == NULL) {
 		Log_Println(errorOccured, LOGLEVEL_ERROR);
+		TapTrace_Abort();
 		System_IndicateError();
 		if (gPlayProperties.playMode != NO_PLAYLIST) {
 			AudioPlayer_TrackControlToQueueSender(STOP);
@@ -991,6 +1265,7 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 	gPlayProperties.playMode = PLAYER_BUSY; // Show @Neopixel, if uC is busy with creating playlist
 	if (!strcmp(*(musicFiles - 1), "0")) {
 		Log_Println(noMp3FilesInDir, LOGLEVEL_NOTICE);
+		TapTrace_Abort();
 		System_IndicateError();
 		if (!gPlayProperties.pausePlay) {
 			AudioPlayer_TrackControlToQueueSender(STOP);
@@ -1003,6 +1278,7 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 		return;
 	}
 
+	TapTrace_Mark(TAP_TRACE_PLAYLIST);
 	gPlayProperties.playMode = _playMode;
 	gPlayProperties.numberOfTracks = strtoul(*(musicFiles - 1), NULL, 10);
 	// Set some default-values
@@ -1021,7 +1297,7 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 	switch (gPlayProperties.playMode) {
 		case SINGLE_TRACK: {
 			Log_Println(modeSingleTrack, LOGLEVEL_NOTICE);
-			xQueueSend(gTrackQueue, &(musicFiles), 0);
+			AudioPlayer_PlaylistToQueue(musicFiles);
 			break;
 		}
 
@@ -1029,7 +1305,7 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 			gPlayProperties.repeatCurrentTrack = true;
 			gPlayProperties.repeatPlaylist = true;
 			Log_Println(modeSingleTrackLoop, LOGLEVEL_NOTICE);
-			xQueueSend(gTrackQueue, &(musicFiles), 0);
+			AudioPlayer_PlaylistToQueue(musicFiles);
 			break;
 		}
 
@@ -1039,16 +1315,18 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 			gPlayProperties.numberOfTracks = 1; // Limit number to 1 even there are more entries in the playlist
 			Led_SetNightmode(true);
 			Log_Println(modeSingleTrackRandom, LOGLEVEL_NOTICE);
-			AudioPlayer_RandomizePlaylist(musicFiles, gPlayProperties.numberOfTracks);
-			xQueueSend(gTrackQueue, &(musicFiles), 0);
+			if (!resumed) { // resumed playlist is already shuffled
+				Playlist_Randomize(musicFiles, gPlayProperties.numberOfTracks);
+			}
+			AudioPlayer_PlaylistToQueue(musicFiles);
 			break;
 		}
 
 		case AUDIOBOOK: { // Tracks need to be alph. sorted!
 			gPlayProperties.saveLastPlayPosition = true;
 			Log_Println(modeSingleAudiobook, LOGLEVEL_NOTICE);
-			AudioPlayer_SortPlaylist(musicFiles, gPlayProperties.numberOfTracks);
-			xQueueSend(gTrackQueue, &(musicFiles), 0);
+			Playlist_Sort(musicFiles, gPlayProperties.numberOfTracks);
+			AudioPlayer_PlaylistToQueue(musicFiles);
 			break;
 		}
 
@@ -1056,47 +1334,51 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 			gPlayProperties.repeatPlaylist = true;
 			gPlayProperties.saveLastPlayPosition = true;
 			Log_Println(modeSingleAudiobookLoop, LOGLEVEL_NOTICE);
-			AudioPlayer_SortPlaylist(musicFiles, gPlayProperties.numberOfTracks);
-			xQueueSend(gTrackQueue, &(musicFiles), 0);
+			Playlist_Sort(musicFiles, gPlayProperties.numberOfTracks);
+			AudioPlayer_PlaylistToQueue(musicFiles);
 			break;
 		}
 
 		case ALL_TRACKS_OF_DIR_SORTED:
 		case RANDOM_SUBDIRECTORY_OF_DIRECTORY: {
 			Log_Printf(LOGLEVEL_NOTICE, modeAllTrackAlphSorted, filename);
-			AudioPlayer_SortPlaylist(musicFiles, gPlayProperties.numberOfTracks);
-			xQueueSend(gTrackQueue, &(musicFiles), 0);
+			Playlist_Sort(musicFiles, gPlayProperties.numberOfTracks);
+			AudioPlayer_PlaylistToQueue(musicFiles);
 			break;
 		}
 
 		case ALL_TRACKS_OF_DIR_RANDOM:
 		case RANDOM_SUBDIRECTORY_OF_DIRECTORY_ALL_TRACKS_OF_DIR_RANDOM: {
 			Log_Printf(LOGLEVEL_NOTICE, modeAllTrackRandom, filename);
-			AudioPlayer_RandomizePlaylist(musicFiles, gPlayProperties.numberOfTracks);
-			xQueueSend(gTrackQueue, &(musicFiles), 0);
+			if (!resumed) { // resumed playlist is already shuffled
+				Playlist_Randomize(musicFiles, gPlayProperties.numberOfTracks);
+			}
+			AudioPlayer_PlaylistToQueue(musicFiles);
 			break;
 		}
 
 		case ALL_TRACKS_OF_DIR_SORTED_LOOP: {
 			gPlayProperties.repeatPlaylist = true;
 			Log_Println(modeAllTrackAlphSortedLoop, LOGLEVEL_NOTICE);
-			AudioPlayer_SortPlaylist(musicFiles, gPlayProperties.numberOfTracks);
-			xQueueSend(gTrackQueue, &(musicFiles), 0);
+			Playlist_Sort(musicFiles, gPlayProperties.numberOfTracks);
+			AudioPlayer_PlaylistToQueue(musicFiles);
 			break;
 		}
 
 		case ALL_TRACKS_OF_DIR_RANDOM_LOOP: {
 			gPlayProperties.repeatPlaylist = true;
 			Log_Println(modeAllTrackRandomLoop, LOGLEVEL_NOTICE);
-			AudioPlayer_RandomizePlaylist(musicFiles, gPlayProperties.numberOfTracks);
-			xQueueSend(gTrackQueue, &(musicFiles), 0);
+			if (!resumed) { // resumed playlist is already shuffled
+				Playlist_Randomize(musicFiles, gPlayProperties.numberOfTracks);
+			}
+			AudioPlayer_PlaylistToQueue(musicFiles);
 			break;
 		}
 
 		case WEBSTREAM: { // This is always just one "track"
 			Log_Println(modeWebstream, LOGLEVEL_NOTICE);
 			if (Wlan_IsConnected()) {
-				xQueueSend(gTrackQueue, &(musicFiles), 0);
+				AudioPlayer_PlaylistToQueue(musicFiles);
 			} else {
 				Log_Println(webstreamNotAvailable, LOGLEVEL_ERROR);
 				System_IndicateError();
@@ -1107,7 +1389,7 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 
 		case LOCAL_M3U: { // Can be one or multiple SD-files or webradio-stations; or a mix of both
 			Log_Println(modeWebstreamM3u, LOGLEVEL_NOTICE);
-			xQueueSend(gTrackQueue, &(musicFiles), 0);
+			AudioPlayer_PlaylistToQueue(musicFiles);
 			break;
 		}
 
@@ -1116,6 +1398,70 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 			gPlayProperties.playMode = NO_PLAYLIST;
 			System_IndicateError();
 	}
+
+	if (gPlayProperties.playMode == NO_PLAYLIST) {
+		TapTrace_Abort();
+	}
+}
+
+#ifdef PLAY_LAST_RFID_AFTER_REBOOT
+// Stores playlist & position before deep-sleep.
+// Audio-task is terminated first, as it replaces the playlist & moves on in it while running.
+void AudioPlayer_SaveResumeState(void) {
+	const uint32_t lastIndexHash = AudioPlayer_ResumeState.indexHash;
+	AudioPlayer_ResumeState.magic = 0u;
+	if (!AudioPlayer_TerminateTask()) {
+		return;
+	}
+	if (gPlayProperties.playlistFinished || gPlayProperties.playlist == nullptr || gPlayProperties.isWebstream || gPlayProperties.playMode == NO_PLAYLIST || gPlayProperties.playMode == PLAYER_BUSY || gPlayProperties.playMode == WEBSTREAM) {
+		return;
+	}
+
+	// Writing to SD is skipped if the file already contains this playlist (e.g. after several cycles of wake-up & deep-sleep)
+	const uint32_t indexHash = Playlist_Hash(gPlayProperties.playlist, gPlayProperties.numberOfTracks);
+	if (indexHash != lastIndexHash || !gFSystem.exists(playlistResumeFile)) {
+		if (!SdCard_WritePlaylist(playlistResumeFile, gPlayProperties.playlist, gPlayProperties.numberOfTracks)) {
+			AudioPlayer_ResumeState.indexHash = 0u;
+			return;
+		}
+	}
+
+	AudioPlayer_ResumeState.playlistId = AudioPlayer_CurrentPlaylistId;
+	AudioPlayer_ResumeState.indexHash = indexHash;
+	AudioPlayer_ResumeState.filePos = AudioPlayer_FilePos;
+	AudioPlayer_ResumeState.trackNumber = gPlayProperties.currentTrackNumber;
+	AudioPlayer_ResumeState.numberOfTracks = gPlayProperties.numberOfTracks;
+	AudioPlayer_ResumeState.magic = audioResumeMagic;
+	Log_Printf(LOGLEVEL_INFO, playlistResumeSaved, gPlayProperties.currentTrackNumber + 1, gPlayProperties.numberOfTracks, AudioPlayer_FilePos);
+}
+
+// Returns the playlist stored by AudioPlayer_SaveResumeState() and sets its position (or nullptr if there's none/it doesn't match)
+static char **AudioPlayer_ResumePlaylist(const uint32_t playlistId) {
+	if (AudioPlayer_ResumeState.magic != audioResumeMagic) {
+		return nullptr;
+	}
+	AudioPlayer_ResumeState.magic = 0u; // only once after wake-up
+	if (AudioPlayer_ResumeState.playlistId != playlistId || esp_reset_reason() != ESP_RST_DEEPSLEEP || !gFSystem.exists(playlistResumeFile)) {
+		return nullptr;
+	}
+
+	char **musicFiles = SdCard_ReturnPlaylist(playlistResumeFile, LOCAL_M3U);
+	if (musicFiles == nullptr || strtoul(*(musicFiles - 1), NULL, 10) != AudioPlayer_ResumeState.numberOfTracks || Playlist_Hash(musicFiles, AudioPlayer_ResumeState.numberOfTracks) != AudioPlayer_ResumeState.indexHash) {
+		Log_Println(playlistResumeInvalid, LOGLEVEL_NOTICE);
+		return nullptr;
+	}
+
+	gPlayProperties.currentTrackNumber = AudioPlayer_ResumeState.trackNumber;
+	gPlayProperties.startAtFilePos = AudioPlayer_ResumeState.filePos;
+	Log_Printf(LOGLEVEL_NOTICE, playlistResumed, AudioPlayer_ResumeState.trackNumber + 1, AudioPlayer_ResumeState.numberOfTracks, AudioPlayer_ResumeState.filePos);
+	return musicFiles;
+}
+#endif
+
+// Passes a (sorted/shuffled) playlist to the audio-task
+static void AudioPlayer_PlaylistToQueue(char **musicFiles) {
+	TapTrace_Mark(TAP_TRACE_QUEUED);
+	xQueueSend(gTrackQueue, &musicFiles, 0);
 }
 
 /* Wraps putString for writing settings into NVS for RFID-cards.
@@ -1178,35 +1524,6 @@ void AudioPlayer_TrackControlToQueueSender(const uint8_t trackCommand) {
 	xQueueSend(gTrackControlQueue, &trackCommand, 0);
 }
 
-// Knuth-Fisher-Yates-algorithm to randomize playlist
-void AudioPlayer_RandomizePlaylist(char **str, const uint32_t count) {
-	if (!count) {
-		return;
-	}
-
-	uint32_t i, r;
-	char *swap = NULL;
-	uint32_t max = count - 1;
-
-	for (i = 0; i < count; i++) {
-		r = (max > 0) ? rand() % max : 0;
-		swap = *(str + max);
-		*(str + max) = *(str + r);
-		*(str + r) = swap;
-		max--;
-	}
-}
-
-// Helper to sort playlist alphabetically
-static int AudioPlayer_ArrSortHelper(const void *a, const void *b) {
-	return strcmp(*(const char **) a, *(const char **) b);
-}
-
-// Sort playlist alphabetically
-void AudioPlayer_SortPlaylist(char **arr, int n) {
-	qsort(arr, n, sizeof(const char *), AudioPlayer_ArrSortHelper);
-}
-
 // Clear cover send notification
 void AudioPlayer_ClearCover(void) {
 	gPlayProperties.coverFilePos = 0;
@@ -1222,8 +1539,11 @@ void AudioPlayer_ClearCover(void) {
 void audio_info(const char *info) {
 	Log_Printf(LOGLEVEL_INFO, "info        : %s", info);
 	if (startsWith((char *) info, "slow stream, dropouts")) {
+		gAudioStats.dropouts++;
 		// websocket notify for slow stream
 		Web_SendWebsocketData(0, 3);
+	} else if (startsWith((char *) info, "Stream lost")) {
+		gAudioStats.webstreamReconnects++;
 	}
 }
 
@@ -1,45 +1,84 @@
 #pragma once
 
-typedef struct { // Bit field
-	uint8_t playMode : 4; // playMode
+#include "Histogram.h"
+#include "Rfid.h"
+
+// Written by several tasks (audio, web, mqtt, bluetooth, cmd): no bit fields, as their read-modify-write would lose concurrent updates of neighbouring flags.
+// Other tasks should read it via AudioPlayer_GetState().
+typedef struct {
+	uint8_t playMode; // playMode
 	char **playlist; // playlist
 	char title[255]; // current title
-	bool repeatCurrentTrack		: 1; // If current track should be looped
-	bool repeatPlaylist			: 1; // If whole playlist should be looped
-	uint16_t currentTrackNumber : 9; // Current tracknumber
-	uint16_t numberOfTracks		: 9; // Number of tracks in playlist
+	bool repeatCurrentTrack; // If current track should be looped
+	bool repeatPlaylist; // If whole playlist should be looped
+	uint16_t currentTrackNumber; // Current tracknumber
+	uint16_t numberOfTracks; // Number of tracks in playlist
 	unsigned long startAtFilePos; // Offset to start play (in bytes)
 	double currentRelPos; // Current relative playPosition (in %)
-	bool sleepAfterCurrentTrack : 1; // If uC should go to sleep after current track
-	bool sleepAfterPlaylist		: 1; // If uC should go to sleep after whole playlist
-	bool sleepAfter5Tracks		: 1; // If uC should go to sleep after 5 tracks
-	bool saveLastPlayPosition	: 1; // If playposition/current track should be saved (for AUDIOBOOK)
-	char playRfidTag[13]; // ID of RFID-tag that started playlist
-	bool pausePlay				 : 1; // If pause is active
-	bool trackFinished			 : 1; // If current track is finished
-	bool playlistFinished		 : 1; // If whole playlist is finished
-	uint8_t playUntilTrackNumber : 6; // Number of tracks to play after which uC goes to sleep
-	uint8_t seekmode			 : 2; // If seekmode is active and if yes: forward or backwards?
-	bool newPlayMono			 : 1; // true if mono; false if stereo (helper)
-	bool currentPlayMono		 : 1; // true if mono; false if stereo
-	bool isWebstream			 : 1; // Indicates if track currenty played is a webstream
-	uint8_t tellMode			 : 2; // Tell mode for text to speech announcments
-	bool currentSpeechActive	 : 1; // If speech-play is active
-	bool lastSpeechActive		 : 1; // If speech-play was active
+	bool sleepAfterCurrentTrack; // If uC should go to sleep after current track
+	bool sleepAfterPlaylist; // If uC should go to sleep after whole playlist
+	bool sleepAfter5Tracks; // If uC should go to sleep after 5 tracks
+	bool saveLastPlayPosition; // If playposition/current track should be saved (for AUDIOBOOK)
+	char playRfidTag[ID_STRING_SIZE]; // ID of RFID-tag that started playlist
+	bool pausePlay; // If pause is active
+	bool trackFinished; // If current track is finished
+	bool playlistFinished; // If whole playlist is finished
+	uint8_t playUntilTrackNumber; // Number of tracks to play after which uC goes to sleep
+	uint8_t seekmode; // If seekmode is active and if yes: forward or backwards?
+	bool newPlayMono; // true if mono; false if stereo (helper)
+	bool currentPlayMono; // true if mono; false if stereo
+	bool isWebstream; // Indicates if track currenty played is a webstream
+	uint8_t tellMode; // Tell mode for text to speech announcments
+	bool currentSpeechActive; // If speech-play is active
+	bool lastSpeechActive; // If speech-play was active
 	size_t coverFilePos; // current cover file position
 	size_t coverFileSize; // current cover file size
 } playProps;
 
 extern playProps gPlayProperties;
 
+// Snapshot of the play-state as seen by other tasks (LED, web, MQTT)
+typedef struct {
+	uint8_t playMode;
+	bool pausePlay;
+	bool playlistFinished;
+	bool isWebstream;
+	bool currentSpeechActive;
+	bool repeatCurrentTrack;
+	bool repeatPlaylist;
+	uint16_t currentTrackNumber;
+	uint16_t numberOfTracks;
+	double currentRelPos;
+	char title[255];
+} playerState_t;
+
+typedef struct {
+	uint32_t dropouts; // "slow stream, dropouts" reported by audio library
+	uint32_t bufferUnderruns; // input buffer ran empty while playing (=> I2S runs dry)
+	uint32_t webstreamConnects; // number of connects to webstreams
+	uint32_t webstreamReconnects; // stream lost and reconnected by audio library
+	uint8_t bufferFill; // current fill level of input buffer (in %)
+	Histogram bufferFillHist; // fill level of input buffer (in %), sampled every 250 ms while playing
+	Histogram decodeTimeHist; // duration of a single audio->loop() (decoding + I2S output) while playing (in µs)
+	Histogram trackOpenTimeHist; // duration to open a file/webstream incl. reading first data (in µs)
+} audioStats_t;
+
+extern audioStats_t gAudioStats;
+
 void AudioPlayer_Init(void);
 void AudioPlayer_Exit(void);
+void AudioPlayer_StartTask(void);
+bool AudioPlayer_StopTask(void);
 void AudioPlayer_Cyclic(void);
+void AudioPlayer_PublishState(void);
+uint32_t AudioPlayer_GetState(playerState_t &state);
+uint32_t AudioPlayer_GetStateGeneration(void);
 uint8_t AudioPlayer_GetRepeatMode(void);
 void AudioPlayer_VolumeToQueueSender(const int32_t _newVolume, bool reAdjustRotary);
 void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _lastPlayPos, const uint32_t _playMode, const uint16_t _trackLastPlayed);
 void AudioPlayer_TrackControlToQueueSender(const uint8_t trackCommand);
 void AudioPlayer_PauseOnMinVolume(const uint8_t oldVolume, const uint8_t newVolume);
+void AudioPlayer_SaveResumeState(void);
 
 uint8_t AudioPlayer_GetCurrentVolume(void);
 void AudioPlayer_SetCurrentVolume(uint8_t value);
@@ -59,3 +98,4 @@ time_t AudioPlayer_GetPlayTimeAllTime(void);
 uint32_t AudioPlayer_GetCurrentTime(void);
 uint32_t AudioPlayer_GetFileDuration(void);
 String AudioPlayer_GetStationLogoUrl(void);
+void AudioPlayer_ResetStats(void);
@@ -4,9 +4,12 @@
 #include "Bluetooth.h"
 
 #include "Common.h"
+#include "Led.h"
 #include "Log.h"
+#include "Mqtt.h"
 #include "RotaryEncoder.h"
 #include "System.h"
+#include "Web.h"
 
 #include <AudioPlayer.h>
 
@@ -24,6 +27,33 @@ BluetoothA2DPSink *a2dp_sink;
 BluetoothA2DPSource *a2dp_source;
 RingbufHandle_t audioSourceRingBuffer;
 String btDeviceName;
+
+// Samples from the audio-task are collected in blocks (already in A2DP-layout) and sent to audioSourceRingBuffer at once
+constexpr size_t btSourceBlockFrames = 128u;
+static uint32_t Bluetooth_SourceBlock[btSourceBlockFrames];
+static size_t Bluetooth_SourceBlockFill = 0u;
+static_assert(sizeof(Frame) == sizeof(uint32_t), "A2DP-frame has to match a stereo-sample");
+
+// AVRC-metadata & volume (BT-sink) are received by the BT-stack; they're passed to the player-state by Bluetooth_Cyclic(),
+// websocket/MQTT are notified not more often than every btNotifyInterval ms
+constexpr uint32_t btNotifyInterval = 500u;
+
+typedef struct {
+	char title[128];
+	char artist[64];
+	char album[64];
+	uint16_t trackNumber; // 1..n; 0 = unknown
+	uint16_t numberOfTracks;
+} btMetadata_t;
+
+static btMetadata_t Bluetooth_Metadata;
+static bool Bluetooth_MetadataChanged = false;
+static bool Bluetooth_VolumeChangedLocally = false;
+static uint32_t Bluetooth_LastNotifyTimestamp = 0u;
+static portMUX_TYPE Bluetooth_MetadataMux = portMUX_INITIALIZER_UNLOCKED;
+	#ifdef RUNTIME_MODE_SWITCH_ENABLE
+static bool Bluetooth_BleMemoryReleased = false;
+	#endif
 #endif
 
 #ifdef BLUETOOTH_ENABLE
@@ -45,6 +75,11 @@ void connection_state_changed(esp_a2d_connection_state_t state, void *ptr) {
 		gPlayProperties.isWebstream = false;
 		gPlayProperties.pausePlay = false;
 		gPlayProperties.playlistFinished = true;
+		// metadata of the previous device is outdated
+		portENTER_CRITICAL(&Bluetooth_MetadataMux);
+		memset(&Bluetooth_Metadata, 0, sizeof(Bluetooth_Metadata));
+		Bluetooth_MetadataChanged = true;
+		portEXIT_CRITICAL(&Bluetooth_MetadataMux);
 	}
 }
 #endif
@@ -67,39 +102,31 @@ void audio_state_changed(esp_a2d_audio_state_t state, void *ptr) {
 // handle Bluetooth AVRC metadata
 // https://docs.espressif.com/projects/esp-idf/en/release-v3.2/api-reference/bluetooth/esp_avrc.html
 void avrc_metadata_callback(uint8_t id, const uint8_t *text) {
-	if (strlen((char *) text) == 0) {
-		return;
-	}
+	Log_Printf(LOGLEVEL_DEBUG, "Bluetooth => AVRC metadata rsp: attribute id 0x%x, %s", id, text);
+	portENTER_CRITICAL(&Bluetooth_MetadataMux);
 	switch (id) {
 		case ESP_AVRC_MD_ATTR_TITLE:
-			// title
-			Log_Printf(LOGLEVEL_DEBUG, "Bluetooth => AVRC Title: %s", text);
+			strncpy(Bluetooth_Metadata.title, (const char *) text, sizeof(Bluetooth_Metadata.title) - 1);
 			break;
 		case ESP_AVRC_MD_ATTR_ARTIST:
-			// artists
-			Log_Printf(LOGLEVEL_DEBUG, "Bluetooth => AVRC Artist: %s", text);
+			strncpy(Bluetooth_Metadata.artist, (const char *) text, sizeof(Bluetooth_Metadata.artist) - 1);
 			break;
 		case ESP_AVRC_MD_ATTR_ALBUM:
-			// album
-			Log_Printf(LOGLEVEL_DEBUG, "Bluetooth => AVRC Album: %s", text);
+			strncpy(Bluetooth_Metadata.album, (const char *) text, sizeof(Bluetooth_Metadata.album) - 1);
 			break;
 		case ESP_AVRC_MD_ATTR_TRACK_NUM:
-			// current track number
-			Log_Printf(LOGLEVEL_DEBUG, "Bluetooth => AVRC Track-No: %s", text);
+			Bluetooth_Metadata.trackNumber = strtoul((const char *) text, NULL, 10);
 			break;
 		case ESP_AVRC_MD_ATTR_NUM_TRACKS:
-			// number of tracks in playlist
-			Log_Printf(LOGLEVEL_DEBUG, "Bluetooth => AVRC Number of tracks: %s", text);
-			break;
-		case ESP_AVRC_MD_ATTR_GENRE:
-			// genre
-			Log_Printf(LOGLEVEL_DEBUG, "Bluetooth => AVRC Genre: %s", text);
+			Bluetooth_Metadata.numberOfTracks = strtoul((const char *) text, NULL, 10);
 			break;
 		default:
 			// unknown/unsupported metadata
-			Log_Printf(LOGLEVEL_DEBUG, "Bluetooth => AVRC metadata rsp: attribute id 0x%x, %s", id, text);
-			break;
+			portEXIT_CRITICAL(&Bluetooth_MetadataMux);
+			return;
 	}
+	Bluetooth_MetadataChanged = true;
+	portEXIT_CRITICAL(&Bluetooth_MetadataMux);
 }
 #endif
 
@@ -110,24 +137,26 @@ int32_t get_data_channels(Frame *frame, int32_t channel_len) {
 		return 0;
 	}
 	// Receive data from ring buffer
+	const size_t needed = channel_len * sizeof(Frame);
 	size_t len {};
 	vRingbufferGetInfo(audioSourceRingBuffer, nullptr, nullptr, nullptr, nullptr, &len);
-	if (len < (channel_len * 4)) {
+	if (len < needed) {
 		// Serial.println("Bluetooth source => not enough data");
 		return 0;
 	};
-	size_t sampleSize = 0;
-	uint8_t *sampleBuff;
-	sampleBuff = (uint8_t *) xRingbufferReceiveUpTo(audioSourceRingBuffer, &sampleSize, (TickType_t) portMAX_DELAY, channel_len * 4);
-	if (sampleBuff != NULL) {
-		// fill the channel data
-		for (int sample = 0; sample < (channel_len); ++sample) {
-			frame[sample].channel1 = (sampleBuff[sample * 4 + 3] << 8) | sampleBuff[sample * 4 + 2];
-			frame[sample].channel2 = (sampleBuff[sample * 4 + 1] << 8) | sampleBuff[sample * 4];
-		};
+	// data is already in A2DP-layout; two parts at most if it wraps around the end of the ringbuffer
+	size_t received = 0;
+	while (received < needed) {
+		size_t sampleSize = 0;
+		uint8_t *sampleBuff = (uint8_t *) xRingbufferReceiveUpTo(audioSourceRingBuffer, &sampleSize, (TickType_t) portMAX_DELAY, needed - received);
+		if (sampleBuff == NULL) {
+			break;
+		}
+		memcpy((uint8_t *) frame + received, sampleBuff, sampleSize);
 		vRingbufferReturnItem(audioSourceRingBuffer, (void *) sampleBuff);
+		received += sampleSize;
 	};
-	return channel_len;
+	return received / sizeof(Frame);
 };
 #endif
 
@@ -154,6 +183,58 @@ bool scan_bluetooth_device_callback(const char *ssid, esp_bd_addr_t address, int
 }
 #endif
 
+#ifdef BLUETOOTH_ENABLE
+// In BT-sink mode volume is applied by the A2DP-stack and there's no audio-task => only ESPuino's state is kept in sync here
+static void Bluetooth_SetLocalVolume(const uint8_t volume, const bool reAdjustRotary) {
+	if (AudioPlayer_GetCurrentVolume() == volume) {
+		return;
+	}
+	AudioPlayer_SetCurrentVolume(volume);
+	if (reAdjustRotary) {
+		RotaryEncoder_Readjust();
+	}
+	Led_Indicate(LedIndicatorType::VolumeChange);
+	Bluetooth_VolumeChangedLocally = true; // websocket/MQTT are notified by Bluetooth_Cyclic()
+}
+
+// Passes received metadata & volume to player-state, websocket and MQTT (throttled)
+static void Bluetooth_NotifyChanges(void) {
+	if (!Bluetooth_MetadataChanged && !Bluetooth_VolumeChangedLocally) {
+		return;
+	}
+	if (millis() - Bluetooth_LastNotifyTimestamp < btNotifyInterval) {
+		return;
+	}
+	Bluetooth_LastNotifyTimestamp = millis();
+
+	if (Bluetooth_MetadataChanged) {
+		btMetadata_t metadata;
+		portENTER_CRITICAL(&Bluetooth_MetadataMux);
+		metadata = Bluetooth_Metadata;
+		Bluetooth_MetadataChanged = false;
+		portEXIT_CRITICAL(&Bluetooth_MetadataMux);
+
+		gPlayProperties.currentTrackNumber = metadata.trackNumber ? metadata.trackNumber - 1 : 0;
+		gPlayProperties.numberOfTracks = metadata.numberOfTracks;
+		if (metadata.artist[0] == '\0') {
+			Audio_setTitle("%s", metadata.title);
+		} else if (metadata.album[0] == '\0') {
+			Audio_setTitle("%s - %s", metadata.artist, metadata.title);
+		} else {
+			Audio_setTitle("%s - %s (%s)", metadata.artist, metadata.title, metadata.album);
+		}
+		// trackinfo is pushed to websocket-clients by Web_Cyclic() once Bluetooth_Cyclic() published the play-state
+	}
+	if (Bluetooth_VolumeChangedLocally) {
+		Bluetooth_VolumeChangedLocally = false;
+		Web_SendWebsocketData(0, 50);
+	#ifdef MQTT_ENABLE
+		publishMqtt(topicLoudnessState, AudioPlayer_GetCurrentVolume(), false);
+	#endif
+	}
+}
+#endif
+
 void Bluetooth_VolumeChanged(int _newVolume) {
 #ifdef BLUETOOTH_ENABLE
 	if ((_newVolume < 0) || (_newVolume > 0x7F)) {
@@ -164,7 +245,11 @@ void Bluetooth_VolumeChanged(int _newVolume) {
 	_volume = map(_newVolume, 0, 0x7F, BLUETOOTHPLAYER_VOLUME_MIN, BLUETOOTHPLAYER_VOLUME_MAX);
 	if (AudioPlayer_GetCurrentVolume() != _volume) {
 		Log_Printf(LOGLEVEL_INFO, "Bluetooth => volume changed:  %d !", _volume);
-		AudioPlayer_VolumeToQueueSender(_volume, true);
+		if (System_GetOperationMode() == OPMODE_BLUETOOTH_SINK) {
+			Bluetooth_SetLocalVolume(_volume, true);
+		} else {
+			AudioPlayer_VolumeToQueueSender(_volume, true);
+		}
 	}
 #endif
 }
@@ -191,6 +276,7 @@ void Bluetooth_Init(void) {
 		a2dp_sink->set_auto_reconnect(true);
 		a2dp_sink->set_rssi_active(true);
 		a2dp_sink->set_rssi_callback(rssi);
+		a2dp_sink->set_avrc_metadata_attribute_mask(ESP_AVRC_MD_ATTR_TITLE | ESP_AVRC_MD_ATTR_ARTIST | ESP_AVRC_MD_ATTR_ALBUM | ESP_AVRC_MD_ATTR_TRACK_NUM | ESP_AVRC_MD_ATTR_NUM_TRACKS);
 		// start bluetooth sink
 		a2dp_sink->start(nameBluetoothSinkDevice);
 		Log_Printf(LOGLEVEL_INFO, "Bluetooth sink started, Device: %s", nameBluetoothSinkDevice);
@@ -234,13 +320,53 @@ void Bluetooth_Init(void) {
 		// max headphone volume (0..255): volume is controlled by audio class
 		a2dp_source->set_volume(127);
 	} else {
+	#ifdef RUNTIME_MODE_SWITCH_ENABLE
+		// BLE isn't used at all; memory of classic BT is kept as BT-modes can be activated at runtime
+		if (!Bluetooth_BleMemoryReleased) {
+			esp_bt_mem_release(ESP_BT_MODE_BLE);
+			Bluetooth_BleMemoryReleased = true;
+			Log_Printf(LOGLEVEL_INFO, btClassicMemoryKept, ESP.getFreeHeap());
+		}
+	#else
 		esp_bt_mem_release(ESP_BT_MODE_BTDM);
+	#endif
+	}
+#endif
+}
+
+// Stops the A2DP-stack when operation-mode is switched at runtime (controller-memory is kept for next Bluetooth_Init())
+void Bluetooth_Exit(void) {
+#ifdef BLUETOOTH_ENABLE
+	if (a2dp_sink) {
+		a2dp_sink->end(false);
+		delete a2dp_sink;
+		a2dp_sink = nullptr;
+		Log_Println("Bluetooth sink stopped", LOGLEVEL_INFO);
+	}
+	if (a2dp_source) {
+		a2dp_source->end(false);
+		delete a2dp_source;
+		a2dp_source = nullptr;
+		Log_Println("Bluetooth source stopped", LOGLEVEL_INFO);
 	}
+	if (audioSourceRingBuffer) {
+		vRingbufferDelete(audioSourceRingBuffer);
+		audioSourceRingBuffer = NULL;
+	}
+	Bluetooth_SourceBlockFill = 0u;
+	portENTER_CRITICAL(&Bluetooth_MetadataMux);
+	memset(&Bluetooth_Metadata, 0, sizeof(Bluetooth_Metadata));
+	Bluetooth_MetadataChanged = false;
+	portEXIT_CRITICAL(&Bluetooth_MetadataMux);
+	Audio_setTitle(noPlaylist);
 #endif
 }
 
 void Bluetooth_Cyclic(void) {
 #ifdef BLUETOOTH_ENABLE
+	// play-state is written by a2dp-callbacks (and there's no audio-task in BT-speaker mode)
+	Bluetooth_NotifyChanges();
+	AudioPlayer_PublishState();
 	if ((System_GetOperationMode() == OPMODE_BLUETOOTH_SINK) && (a2dp_sink)) {
 		esp_a2d_audio_state_t state = a2dp_sink->get_audio_state();
 		// Reset Sleep Timer when audio is playing
@@ -302,9 +428,7 @@ void Bluetooth_SetVolume(const int32_t _newVolume, bool reAdjustRotary) {
 		// map ESPuino min/max volume (0..21) to bluetooth volume (0..127)
 		_volume = map(_newVolume, BLUETOOTHPLAYER_VOLUME_MIN, BLUETOOTHPLAYER_VOLUME_MAX, 0, 0x7F);
 		a2dp_sink->set_volume(_volume);
-		if (reAdjustRotary) {
-			RotaryEncoder_Readjust();
-		}
+		Bluetooth_SetLocalVolume(_newVolume, reAdjustRotary);
 	}
 #endif
 }
@@ -313,8 +437,15 @@ bool Bluetooth_Source_SendAudioData(uint32_t *sample) {
 #ifdef BLUETOOTH_ENABLE
 	// send audio data to ringbuffer
 	if ((System_GetOperationMode() == OPMODE_BLUETOOTH_SOURCE) && (a2dp_source) && a2dp_source->is_connected()) {
-		return (pdTRUE == xRingbufferSend(audioSourceRingBuffer, sample, sizeof(uint32_t), (TickType_t) portMAX_DELAY));
+		// I2S-sample has channel1 in the upper 16 bits, A2DP-frame in the lower ones => swap halves
+		Bluetooth_SourceBlock[Bluetooth_SourceBlockFill++] = (*sample >> 16) | (*sample << 16);
+		if (Bluetooth_SourceBlockFill < btSourceBlockFrames) {
+			return true;
+		}
+		Bluetooth_SourceBlockFill = 0u;
+		return (pdTRUE == xRingbufferSend(audioSourceRingBuffer, Bluetooth_SourceBlock, sizeof(Bluetooth_SourceBlock), (TickType_t) portMAX_DELAY));
 	} else {
+		Bluetooth_SourceBlockFill = 0u;
 		return false;
 	}
 #else
@@ -322,6 +453,19 @@ bool Bluetooth_Source_SendAudioData(uint32_t *sample) {
 #endif
 }
 
+// Sends the frames of a partially filled block, so the end of a track isn't held back until the next block is full
+void Bluetooth_Source_Flush(void) {
+#ifdef BLUETOOTH_ENABLE
+	if (Bluetooth_SourceBlockFill == 0u) {
+		return;
+	}
+	if ((System_GetOperationMode() == OPMODE_BLUETOOTH_SOURCE) && (a2dp_source) && a2dp_source->is_connected()) {
+		xRingbufferSend(audioSourceRingBuffer, Bluetooth_SourceBlock, Bluetooth_SourceBlockFill * sizeof(Bluetooth_SourceBlock[0]), (TickType_t) portMAX_DELAY);
+	}
+	Bluetooth_SourceBlockFill = 0u;
+#endif
+}
+
 bool Bluetooth_Device_Connected() {
 #ifdef BLUETOOTH_ENABLE
 	// send audio data to ringbuffer
@@ -2,6 +2,7 @@
 
 void Bluetooth_Init(void);
 void Bluetooth_Cyclic(void);
+void Bluetooth_Exit(void);
 
 // AVRC commands, see https://github.com/pschatzmann/ESP32-A2DP/wiki/Controlling-your-Phone-with-AVRC-Commands
 
@@ -14,4 +15,5 @@ void Bluetooth_PreviousTrack(void);
 void Bluetooth_SetVolume(const int32_t _newVolume, bool reAdjustRotary);
 
 bool Bluetooth_Source_SendAudioData(uint32_t *sample);
+void Bluetooth_Source_Flush(void);
 bool Bluetooth_Device_Connected();
@@ -0,0 +1,197 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Boot.h"
+
+#include "Log.h"
+
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <freertos/event_groups.h>
+
+// Every step sets its bit in Boot_ReadyEvents when done; waiting for dependencies is a wait for all of their bits.
+// Steps are started in table-order, so a synchronous step waiting for an async one delays all steps after it.
+
+static EventGroupHandle_t Boot_ReadyEvents = NULL;
+static const bootStep_t *Boot_Steps = NULL;
+static uint32_t Boot_StepStart[bootMaxSteps]; // ms since start
+static uint32_t Boot_StepEnd[bootMaxSteps]; // ms since start
+static uint32_t Boot_ReadyTime = 0u; // ms since start
+
+// Boot-trace: events are appended by Boot_TraceBegin() and completed by Boot_TraceEnd(). The trace lives in
+// RTC-memory, at start of the next boot it's copied to Boot_PreviousTrace before being overwritten.
+constexpr uint32_t bootTraceMagic = 0x54425045; // "EPBT"
+constexpr uint32_t bootTraceOpen = UINT32_MAX; // duration of events not ended (yet)
+
+struct bootTraceEvent_t {
+	char name[bootTraceNameLength];
+	uint8_t thread; // index of bootTrace_t::threads
+	uint32_t start; // µs since start
+	uint32_t duration; // µs
+};
+
+struct bootTrace_t {
+	uint32_t magic;
+	uint8_t wakeupCause; // esp_sleep_wakeup_cause_t
+	uint8_t numEvents;
+	uint8_t numThreads;
+	char threads[bootTraceMaxThreads][bootTraceNameLength + 1u]; // task-names
+	bootTraceEvent_t events[bootTraceMaxEvents];
+};
+
+RTC_DATA_ATTR static bootTrace_t Boot_Trace;
+static bootTrace_t Boot_PreviousTrace;
+static TaskHandle_t Boot_TraceTasks[bootTraceMaxThreads];
+static bool Boot_TraceStarted = false;
+static portMUX_TYPE Boot_TraceMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void Boot_TraceStart(void) {
+	if (Boot_Trace.magic == bootTraceMagic) {
+		Boot_PreviousTrace = Boot_Trace;
+	}
+	memset(&Boot_Trace, 0, sizeof(Boot_Trace));
+	Boot_Trace.magic = bootTraceMagic;
+	Boot_Trace.wakeupCause = esp_sleep_get_wakeup_cause();
+	Boot_TraceStarted = true;
+}
+
+// Index of the calling task in the trace (has to be called with Boot_TraceMux taken)
+static uint8_t Boot_TraceThread(void) {
+	const TaskHandle_t task = xTaskGetCurrentTaskHandle();
+	for (uint8_t i = 0; i < Boot_Trace.numThreads; i++) {
+		if (Boot_TraceTasks[i] == task) {
+			return i;
+		}
+	}
+	if (Boot_Trace.numThreads >= bootTraceMaxThreads) {
+		return bootTraceMaxThreads - 1u;
+	}
+	const uint8_t thread = Boot_Trace.numThreads++;
+	Boot_TraceTasks[thread] = task;
+	strncpy(Boot_Trace.threads[thread], pcTaskGetName(task), bootTraceNameLength);
+	return thread;
+}
+
+uint8_t Boot_TraceBegin(const char *name) {
+	const uint32_t now = esp_timer_get_time();
+	uint8_t event = bootTraceInvalidEvent;
+
+	portENTER_CRITICAL(&Boot_TraceMux);
+	if (Boot_TraceStarted && Boot_Trace.numEvents < bootTraceMaxEvents) {
+		event = Boot_Trace.numEvents++;
+		bootTraceEvent_t &ev = Boot_Trace.events[event];
+		strncpy(ev.name, name, bootTraceNameLength - 1u);
+		ev.thread = Boot_TraceThread();
+		ev.start = now;
+		ev.duration = bootTraceOpen;
+	}
+	portEXIT_CRITICAL(&Boot_TraceMux);
+	return event;
+}
+
+void Boot_TraceEnd(const uint8_t event) {
+	if (event >= bootTraceMaxEvents) {
+		return;
+	}
+	Boot_Trace.events[event].duration = (uint32_t) esp_timer_get_time() - Boot_Trace.events[event].start;
+}
+
+static void Boot_RunStep(const uint8_t index) {
+	const uint8_t traceEvent = Boot_TraceBegin(Boot_Steps[index].name);
+	Boot_StepStart[index] = millis();
+	Boot_Steps[index].init();
+	Boot_StepEnd[index] = millis();
+	Boot_TraceEnd(traceEvent);
+	xEventGroupSetBits(Boot_ReadyEvents, BOOT_DEP(index));
+}
+
+static void Boot_StepTask(void *parameter) {
+	Boot_RunStep((uint8_t) (uintptr_t) parameter);
+	vTaskDelete(NULL);
+}
+
+void Boot_Run(const bootStep_t *steps, const uint8_t numSteps) {
+	configASSERT(numSteps <= bootMaxSteps);
+	Boot_TraceStart();
+	const uint8_t traceEvent = Boot_TraceBegin("boot");
+	Boot_ReadyEvents = xEventGroupCreate();
+	Boot_Steps = steps;
+	const uint32_t allSteps = BOOT_DEP(numSteps) - 1u;
+
+	for (uint8_t i = 0; i < numSteps; i++) {
+		const uint32_t dependencies = steps[i].dependencies;
+		configASSERT((dependencies & ~(BOOT_DEP(i) - 1u)) == 0u); // only steps started before can be waited for
+		if (dependencies) {
+			xEventGroupWaitBits(Boot_ReadyEvents, dependencies, pdFALSE, pdTRUE, portMAX_DELAY);
+		}
+		if (!steps[i].async) {
+			Boot_RunStep(i);
+			continue;
+		}
+		xTaskCreatePinnedToCore(
+			Boot_StepTask, /* Function to implement the task */
+			steps[i].name, /* Name of the task */
+			bootTaskStackSize, /* Stack size in words */
+			(void *) (uintptr_t) i, /* Task input parameter */
+			1, /* Priority of the task */
+			NULL, /* Task handle. */
+			1 /* Core where the task should run */
+		);
+	}
+	xEventGroupWaitBits(Boot_ReadyEvents, allSteps, pdFALSE, pdTRUE, portMAX_DELAY);
+	Boot_ReadyTime = millis();
+	Boot_TraceEnd(traceEvent);
+
+	for (uint8_t i = 0; i < numSteps; i++) {
+		Log_Printf(LOGLEVEL_DEBUG, bootStepTime, steps[i].name, Boot_StepStart[i], Boot_StepEnd[i] - Boot_StepStart[i], steps[i].async ? " (async)" : "");
+	}
+	Log_Printf(LOGLEVEL_NOTICE, bootReadyTime, Boot_ReadyTime);
+
+	vEventGroupDelete(Boot_ReadyEvents);
+	Boot_ReadyEvents = NULL;
+	Boot_Steps = NULL;
+}
+
+// Time (in ms since start) when all boot-steps were done; 0 while booting
+uint32_t Boot_GetReadyTime(void) {
+	return Boot_ReadyTime;
+}
+
+// Every boot is a process (pid), every task a thread (tid)
+static void Boot_PrintTraceEvents(Print &out, const bootTrace_t &trace, const uint8_t pid, const char *label, bool &first) {
+	if (trace.magic != bootTraceMagic) {
+		return;
+	}
+	out.printf("%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"%s\",\"wakeupCause\":%u}}", first ? "" : ",", pid, label, trace.wakeupCause);
+	first = false;
+	for (uint8_t i = 0; i < trace.numThreads; i++) {
+		out.printf(",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", pid, i, trace.threads[i]);
+	}
+	for (uint8_t i = 0; i < trace.numEvents; i++) {
+		const bootTraceEvent_t &ev = trace.events[i];
+		if (ev.duration == bootTraceOpen) {
+			out.printf(",{\"name\":\"%s\",\"ph\":\"B\",\"pid\":%u,\"tid\":%u,\"ts\":%u}", ev.name, pid, ev.thread, ev.start);
+		} else {
+			out.printf(",{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%u,\"dur\":%u}", ev.name, pid, ev.thread, ev.start, ev.duration);
+		}
+	}
+}
+
+void Boot_PrintTrace(Print &out) {
+	bootTrace_t *trace = (bootTrace_t *) malloc(sizeof(bootTrace_t));
+	if (trace == NULL) {
+		out.print("{}");
+		return;
+	}
+	// copy, as markers may still be added
+	portENTER_CRITICAL(&Boot_TraceMux);
+	*trace = Boot_Trace;
+	portEXIT_CRITICAL(&Boot_TraceMux);
+
+	bool first = true;
+	out.print("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	Boot_PrintTraceEvents(out, *trace, 1u, "current boot", first);
+	Boot_PrintTraceEvents(out, Boot_PreviousTrace, 2u, "previous boot", first);
+	out.print("]}");
+	free(trace);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+// Boot is described by a table of steps. Every step waits until its dependencies are ready; "async" steps are run
+// in an own task, so slow bring-ups (e.g. SD-mount, RFID-reader) overlap with the following steps.
+// A step may only depend on steps listed before it.
+
+constexpr uint8_t bootMaxSteps = 24u; // number of usable bits of a FreeRTOS event-group
+constexpr uint32_t bootTaskStackSize = 4096u; // stack of tasks running async steps
+
+// Boot-trace (kept in RTC-memory, so the trace of the previous boot is still available after deep-sleep)
+constexpr uint8_t bootTraceMaxEvents = 32u; // Events beyond are dropped
+constexpr uint8_t bootTraceMaxThreads = 6u; // Tasks beyond are recorded as the last one
+constexpr uint8_t bootTraceNameLength = 15u;
+constexpr uint8_t bootTraceInvalidEvent = 0xFFu;
+
+struct bootStep_t {
+	const char *name;
+	void (*init)(void);
+	uint32_t dependencies; // bitmask of step-indices (BOOT_DEP())
+	bool async;
+};
+
+#define BOOT_DEP(step) (1UL << (step))
+
+void Boot_Run(const bootStep_t *steps, const uint8_t numSteps);
+uint32_t Boot_GetReadyTime(void);
+
+// Trace-markers; every step run by Boot_Run() is traced implicitly. Markers may be nested.
+uint8_t Boot_TraceBegin(const char *name);
+void Boot_TraceEnd(const uint8_t event);
+
+// Writes trace of the current and the previous boot in Chrome's trace-event-format (chrome://tracing, Perfetto)
+void Boot_PrintTrace(Print &out);
@@ -13,7 +13,25 @@
 #include "System.h"
 #include "Wlan.h"
 #include "Queues.h"
+#include "Rfid.h"
 
+// Commands are executed by loop() (buttons, IR), the RFID-dispatcher-task and web-/MQTT-handlers: one at a time
+static SemaphoreHandle_t Cmd_Mutex = NULL;
+
+static void Cmd_Execute(const uint16_t mod);
+
+void Cmd_Init(void) {
+	Cmd_Mutex = xSemaphoreCreateRecursiveMutex();
+}
+
+// Has to be held by anyone who changes play-state/playlist outside of Cmd_Action(); may be taken again by the holder
+void Cmd_Lock(void) {
+	xSemaphoreTakeRecursive(Cmd_Mutex, portMAX_DELAY);
+}
+
+void Cmd_Unlock(void) {
+	xSemaphoreGiveRecursive(Cmd_Mutex);
+}
 
 static void Cmd_HandleSleepAction(bool enable, const char *enLogMsg, const char *enMqttMsg) {
 	Led_SetNightmode(enable);
@@ -32,6 +50,12 @@ static void Cmd_HandleSleepAction(bool enable, const char *enLogMsg, const char
 }
 
 void Cmd_Action(const uint16_t mod) {
+	Cmd_Lock();
+	Cmd_Execute(mod);
+	Cmd_Unlock();
+}
+
+static void Cmd_Execute(const uint16_t mod) {
 	switch (mod) {
 		case CMD_LOCK_BUTTONS_MOD: { // Locks/unlocks all buttons
 			System_ToggleLockControls();
@@ -369,43 +393,43 @@ void Cmd_Action(const uint16_t mod) {
 			break;
 		}
 		case CMD_BUTTON_4_ID_SHORT: {
-			xQueueSend(gButtonIdQueue, "BTN4_SHORT", 0); 
+			Rfid_SendId(gButtonIdQueue, "BTN4_SHORT");
 			break;
 		}
 		case CMD_BUTTON_4_ID_LONG: {
-			xQueueSend(gButtonIdQueue, "BTN4_LONG", 0); 
+			Rfid_SendId(gButtonIdQueue, "BTN4_LONG");
 			break;
 		}
 		case CMD_BUTTON_5_ID_SHORT: {
-			xQueueSend(gButtonIdQueue, "BTN5_SHORT", 0); 
+			Rfid_SendId(gButtonIdQueue, "BTN5_SHORT");
 			break;
 		}
 		case CMD_BUTTON_5_ID_LONG: {
-			xQueueSend(gButtonIdQueue, "BTN5_LONG", 0); 
+			Rfid_SendId(gButtonIdQueue, "BTN5_LONG");
 			break;
 		}
 		case CMD_BUTTON_6_ID_SHORT: {
-			xQueueSend(gButtonIdQueue, "BTN6_SHORT", 0); 
+			Rfid_SendId(gButtonIdQueue, "BTN6_SHORT");
 			break;
 		}
 		case CMD_BUTTON_6_ID_LONG: {
-			xQueueSend(gButtonIdQueue, "BTN6_LONG", 0); 
+			Rfid_SendId(gButtonIdQueue, "BTN6_LONG");
 			break;
 		}
 		case CMD_BUTTON_7_ID_SHORT: {
-			xQueueSend(gButtonIdQueue, "BTN7_SHORT", 0); 
+			Rfid_SendId(gButtonIdQueue, "BTN7_SHORT");
 			break;
 		}
 		case CMD_BUTTON_7_ID_LONG: {
-			xQueueSend(gButtonIdQueue, "BTN7_LONG", 0); 
+			Rfid_SendId(gButtonIdQueue, "BTN7_LONG");
 			break;
 		}
 		case CMD_BUTTON_8_ID_SHORT: {
-			xQueueSend(gButtonIdQueue, "BTN8_SHORT", 0); 
+			Rfid_SendId(gButtonIdQueue, "BTN8_SHORT");
 			break;
 		}
 		case CMD_BUTTON_8_ID_LONG: {
-			xQueueSend(gButtonIdQueue, "BTN8_LONG", 0); 
+			Rfid_SendId(gButtonIdQueue, "BTN8_LONG");
 			break;
 		}
 
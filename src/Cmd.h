@@ -1,3 +1,6 @@
 #pragma once
 
+void Cmd_Init(void);
 void Cmd_Action(const uint16_t mod);
+void Cmd_Lock(void);
+void Cmd_Unlock(void);
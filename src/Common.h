@@ -103,5 +103,4 @@ inline void freeMultiCharArray(char **arr, const uint32_t cnt) {
 		free(*(arr + i));
 	}
 	free(arr);
-	*arr = NULL;
 }
@@ -0,0 +1,59 @@
+#pragma once
+
+// Lightweight histogram with logarithmic buckets, cheap enough to be fed from time critical tasks.
+// Bucket n holds values in range [2^(n-1), 2^n); bucket 0 holds 0. The last bucket collects everything above.
+// Values are typically durations in µs, but any unsigned quantity works.
+struct Histogram {
+	static constexpr uint8_t numBuckets = 24u;
+
+	uint32_t buckets[numBuckets];
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+
+	Histogram() {
+		reset();
+	}
+
+	void reset() {
+		memset(buckets, 0, sizeof(buckets));
+		count = 0;
+		min = UINT32_MAX;
+		max = 0;
+		sum = 0;
+	}
+
+	void add(uint32_t value) {
+		const uint8_t bucket = (value == 0) ? 0 : (32u - __builtin_clz(value));
+		buckets[(bucket < numBuckets) ? bucket : (numBuckets - 1)]++;
+		count++;
+		sum += value;
+		if (value < min) {
+			min = value;
+		}
+		if (value > max) {
+			max = value;
+		}
+	}
+
+	uint32_t mean() const {
+		return count ? (sum / count) : 0;
+	}
+
+	// Returns the upper bound of the bucket containing the given percentile (0..100)
+	uint32_t percentile(uint8_t percent) const {
+		if (!count) {
+			return 0;
+		}
+		const uint32_t target = ((uint64_t) count * percent + 99u) / 100u;
+		uint32_t seen = 0;
+		for (uint8_t i = 0; i < numBuckets; i++) {
+			seen += buckets[i];
+			if (seen >= target && seen > 0) {
+				return (i == numBuckets - 1) ? max : std::min<uint32_t>((1u << i) - 1u, max);
+			}
+		}
+		return max;
+	}
+};
@@ -3,6 +3,7 @@
 
 #include "Led.h"
 
+#include "ArduinoJson.h"
 #include "AudioPlayer.h"
 #include "Battery.h"
 #include "Bluetooth.h"
@@ -10,6 +11,7 @@
 #include "Log.h"
 #include "Mqtt.h"
 #include "Port.h"
+#include "SdCard.h"
 #include "System.h"
 #include "Wlan.h"
 
@@ -17,6 +19,8 @@
 #include <esp_task_wdt.h>
 
 #ifdef NEOPIXEL_ENABLE
+	#include "LedAnimationDefaults.h"
+
 	#include <FastLED.h>
 
 	#define LED_INITIAL_BRIGHTNESS		 16u
@@ -32,10 +36,13 @@
 		#error LED_OFFSET must be between 0 and NUM_INDICATOR_LEDS-1
 	#endif
 
-	// Time in milliseconds the volume indicator is visible
-	#define LED_VOLUME_INDICATOR_RETURN_DELAY 1000U
-	#define LED_VOLUME_INDICATOR_NUM_CYCLES	  (LED_VOLUME_INDICATOR_RETURN_DELAY / 20)
+	// Time (in ms) between two frames of an animation that changes continuously
+	#define LED_ANIMATION_FRAME_INTERVAL 20u
+#endif
+
+ledStats_t gLedStats;
 
+#ifdef NEOPIXEL_ENABLE
 extern t_button gButtons[7]; // next + prev + pplay + rotEnc + button4 + button5 + dummy-button
 extern uint8_t gShutdownButton;
 
@@ -49,32 +56,103 @@ static uint8_t Led_NightBrightness = LED_INITIAL_NIGHT_BRIGHTNESS;
 static bool Led_NightMode = false;
 static uint8_t Led_savedBrightness;
 
-constexpr uint8_t Led_IdleDotDistance = NUM_INDICATOR_LEDS / NUM_LEDS_IDLE_DOTS;
-
 static CRGBArray<NUM_INDICATOR_LEDS + NUM_CONTROL_LEDS> leds;
 static CRGBSet indicator(leds(0, NUM_INDICATOR_LEDS - 1));
 static CRGBSet controlLeds(leds(NUM_INDICATOR_LEDS, NUM_INDICATOR_LEDS + NUM_CONTROL_LEDS - 1));
 
+// Minimal time (in ms) between two frames sent to the LEDs, indexed by LedAnimationType (0: no cap)
+static constexpr uint8_t Led_FrameInterval[] = {
+	0, // Boot
+	0, // Shutdown
+	0, // Error
+	0, // Ok
+	0, // VoltageWarning
+	20, // Volume
+	0, // BatteryMeasurement
+	0, // Rewind
+	0, // Playlist
+	40, // Speech
+	40, // Pause
+	40, // Progress
+	20, // Webstream
+	0, // Idle
+	0, // Busy
+	0 // NoNewAnimation
+};
+static_assert(sizeof(Led_FrameInterval) == (size_t) LedAnimationType::NoNewAnimation + 1u, "Led_FrameInterval doesn't match LedAnimationType");
+
+// Frame currently shown by the LEDs (to skip FastLED.show() if nothing has changed)
+static CRGB Led_ShownFrame[NUM_INDICATOR_LEDS + NUM_CONTROL_LEDS];
+static uint8_t Led_ShownBrightness = 0;
+static bool Led_ShownFrameValid = false; // false if LEDs were changed without Led_Show() (e.g. FastLED.clear())
+static bool Led_FramePending = false; // frame was deferred by frame-rate cap
+static uint32_t Led_LastFrameTimestamp = 0;
+
+static playerState_t Led_PlayerState; // play-state for the current frame (consistent for all animations)
+
+// Animation of every timeline: defaults (LedAnimation_Defaults) or replaced by Led_LoadAnimations()
+static const ledAnimation_t *Led_Animations[LED_TIMELINE_COUNT];
+static portMUX_TYPE Led_AnimationsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// State of the animation shown (everything that has to survive from one frame to the next one)
+typedef struct {
+	uint32_t start; // millis() at start of animation
+	ledRgb_t frame[NUM_INDICATOR_LEDS]; // frame shown at start of animation (dimmed by LED_ANIMATION_MASK)
+	uint8_t batteryLevel;
+	uint8_t webstreamPosition;
+	uint8_t webstreamHue;
+	bool webstreamPaused;
+	uint32_t webstreamCycle;
+	ledAnimation_t playlist; // built from "playlist"-animation for the current track
+} ledAnimationState_t;
+
+static ledAnimationState_t Led_AnimationState;
+
+// Timeline of every LedAnimationType and optional binder, that adapts it to the device-state for every frame.
+// The binder may set the input, return a different animation or nullptr (nothing to show; animation is finished).
+typedef struct {
+	ledTimeline_t timeline;
+	const ledAnimation_t *(*bind)(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input);
+} ledAnimationBinding_t;
+
 TaskHandle_t Led_TaskHandle;
 static void Led_Task(void *parameter);
 static uint8_t Led_Address(uint8_t number);
-
-// animation-functions prototypes
-AnimationReturnType Animation_PlaylistProgress(const bool startNewAnimation, CRGBSet &leds);
-AnimationReturnType Animation_BatteryMeasurement(const bool startNewAnimation, CRGBSet &leds);
-AnimationReturnType Animation_Volume(const bool startNewAnimation, CRGBSet &leds);
-AnimationReturnType Animation_Progress(const bool startNewAnimation, CRGBSet &leds);
-AnimationReturnType Animation_Boot(const bool startNewAnimation, CRGBSet &leds);
-AnimationReturnType Animation_Shutdown(const bool startNewAnimation, CRGBSet &leds);
-AnimationReturnType Animation_Error(const bool startNewAnimation, CRGBSet &leds);
-AnimationReturnType Animation_Ok(const bool startNewAnimation, CRGBSet &leds);
-AnimationReturnType Animation_VoltageWarning(const bool startNewAnimation, CRGBSet &leds);
-AnimationReturnType Animation_Webstream(const bool startNewAnimation, CRGBSet &leds);
-AnimationReturnType Animation_Rewind(const bool startNewAnimation, CRGBSet &leds);
-AnimationReturnType Animation_Idle(const bool startNewAnimation, CRGBSet &leds);
-AnimationReturnType Animation_Busy(const bool startNewAnimation, CRGBSet &leds);
-AnimationReturnType Animation_Pause(const bool startNewAnimation, CRGBSet &leds);
-AnimationReturnType Animation_Speech(const bool startNewAnimation, CRGBSet &leds);
+static void Led_Show(const LedAnimationType animation);
+static void Led_Wakeup(void);
+bool CheckForPowerButtonAnimation();
+
+// binder prototypes
+static const ledAnimation_t *Led_BindBoot(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input);
+static const ledAnimation_t *Led_BindShutdown(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input);
+static const ledAnimation_t *Led_BindVolume(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input);
+static const ledAnimation_t *Led_BindBatteryMeasurement(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input);
+static const ledAnimation_t *Led_BindPlaylist(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input);
+static const ledAnimation_t *Led_BindPause(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input);
+static const ledAnimation_t *Led_BindProgress(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input);
+static const ledAnimation_t *Led_BindWebstream(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input);
+static const ledAnimation_t *Led_BindIdle(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input);
+static const ledAnimation_t *Led_BindBusy(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input);
+
+// indexed by LedAnimationType
+static const ledAnimationBinding_t Led_AnimationBindings[] = {
+	{LED_TIMELINE_BOOT, Led_BindBoot},
+	{LED_TIMELINE_SHUTDOWN, Led_BindShutdown},
+	{LED_TIMELINE_ERROR, nullptr},
+	{LED_TIMELINE_OK, nullptr},
+	{LED_TIMELINE_VOLTAGEWARNING, nullptr},
+	{LED_TIMELINE_VOLUME, Led_BindVolume},
+	{LED_TIMELINE_BATTERY, Led_BindBatteryMeasurement},
+	{LED_TIMELINE_REWIND, nullptr},
+	{LED_TIMELINE_PLAYLIST, Led_BindPlaylist},
+	{LED_TIMELINE_SPEECH, nullptr},
+	{LED_TIMELINE_PAUSE, Led_BindPause},
+	{LED_TIMELINE_PROGRESS, Led_BindProgress},
+	{LED_TIMELINE_WEBSTREAM, Led_BindWebstream},
+	{LED_TIMELINE_IDLE, Led_BindIdle},
+	{LED_TIMELINE_BUSY, Led_BindBusy},
+};
+static_assert(sizeof(Led_AnimationBindings) / sizeof(Led_AnimationBindings[0]) == (size_t) LedAnimationType::NoNewAnimation, "Led_AnimationBindings doesn't match LedAnimationType");
 #endif
 
 void Led_Init(void) {
@@ -101,6 +179,12 @@ void Led_Init(void) {
 		Log_Println(wroteNmBrightnessToNvs, LOGLEVEL_ERROR);
 	}
 
+	Led_ResetStats();
+
+	for (uint8_t i = 0; i < LED_TIMELINE_COUNT; i++) {
+		Led_Animations[i] = &LedAnimation_Defaults[i];
+	}
+
 	xTaskCreatePinnedToCore(
 		Led_Task, /* Function to implement the task */
 		"Led_Task", /* Name of the task */
@@ -128,6 +212,7 @@ void Led_Exit(void) {
 void Led_Indicate(LedIndicatorType value) {
 #ifdef NEOPIXEL_ENABLE
 	LED_INDICATOR_SET(value);
+	Led_Wakeup();
 #endif
 }
 
@@ -142,6 +227,7 @@ void Led_ResetToInitialBrightness(void) {
 #ifdef NEOPIXEL_ENABLE
 	if (Led_Brightness == Led_NightBrightness || Led_Brightness == 0) { // Only reset to initial value if brightness wasn't intentionally changed (or was zero)
 		Led_Brightness = Led_InitialBrightness;
+		Led_Wakeup();
 		Log_Println(ledsDimmedToInitialValue, LOGLEVEL_INFO);
 	}
 #endif
@@ -153,6 +239,7 @@ void Led_ResetToInitialBrightness(void) {
 void Led_ResetToNightBrightness(void) {
 #ifdef NEOPIXEL_ENABLE
 	Led_Brightness = Led_NightBrightness;
+	Led_Wakeup();
 	Log_Println(ledsDimmedToNightmode, LOGLEVEL_INFO);
 #endif
 #ifdef BUTTONS_LED
@@ -171,6 +258,7 @@ uint8_t Led_GetBrightness(void) {
 void Led_SetBrightness(uint8_t value) {
 #ifdef NEOPIXEL_ENABLE
 	Led_Brightness = value;
+	Led_Wakeup();
 	#ifdef BUTTONS_LED
 	Port_Write(BUTTONS_LED, value <= Led_NightBrightness ? LOW : HIGH, false);
 	#endif
@@ -234,6 +322,123 @@ uint8_t Led_Address(uint8_t number) {
 #endif
 
 #ifdef NEOPIXEL_ENABLE
+static void Led_Wakeup(void) {
+	if (Led_TaskHandle) {
+		xTaskNotifyGive(Led_TaskHandle);
+	}
+}
+
+// Everything the choice of animation depends on besides indications and play-state (see AudioPlayer_GetStateGeneration())
+static uint32_t Led_StateFingerprint(void) {
+	uint32_t state = System_GetOperationMode();
+	state |= (System_AreControlsLocked() << 8) | (Wlan_IsConnected() << 9) | (Wlan_ConnectionTryInProgress() << 10) | (Bluetooth_Device_Connected() << 11) | (CheckForPowerButtonAnimation() << 12);
+	return state;
+}
+
+// Sends frame to the LEDs, but only if it differs from the one shown and the frame-rate cap of the animation isn't exceeded.
+// Identical frames are common as most animations redraw every cycle; each FastLED.show() costs RMT-interrupts on the audio-core.
+static void Led_Show(const LedAnimationType animation) {
+	if (Led_ShownFrameValid && Led_ShownBrightness == FastLED.getBrightness() && memcmp(Led_ShownFrame, &leds[0], sizeof(Led_ShownFrame)) == 0) {
+		Led_FramePending = false;
+		gLedStats.framesSkipped++;
+		return;
+	}
+	if (millis() - Led_LastFrameTimestamp < Led_FrameInterval[(uint8_t) animation]) {
+		if (!Led_FramePending) {
+			Led_FramePending = true; // will be sent with one of the next cycles
+			gLedStats.framesDeferred++;
+		}
+		return;
+	}
+
+	FastLED.show();
+	memcpy(Led_ShownFrame, &leds[0], sizeof(Led_ShownFrame));
+	Led_ShownBrightness = FastLED.getBrightness();
+	Led_ShownFrameValid = true;
+	Led_FramePending = false;
+	Led_LastFrameTimestamp = millis();
+	gLedStats.framesRendered++;
+}
+
+static bool Led_ParseColor(const char *str, ledRgb_t &color) {
+	if (str == nullptr || str[0] != '#' || strlen(str) != 7) {
+		return false;
+	}
+	const uint32_t value = strtoul(str + 1, nullptr, 16);
+	color = {(uint8_t) (value >> 16), (uint8_t) (value >> 8), (uint8_t) value};
+	return true;
+}
+
+// Parses a keyframe-animation from JSON, e.g.
+// {"pattern": "dots", "loop": true, "dots": 4, "keyframes": [[0, "#00ff00", 255, 0], [1000, "#0000ff", 64, 128], [2000, "#00ff00", 255, 255]]}
+// keyframe: [time (ms, ascending), color, level (optional, 0..255), position (optional, 0..255 = full circle)]
+// pattern: fill, bar, dots or wave; optional "step": true (no interpolation), optional "palette": ["#00ff00", "#ff0000"] (gradient around the ring),
+// optional "rotate": ms per LED (rotating pattern), optional "mask": true (dims the LEDs shown before instead of drawing)
+static bool Led_ParseAnimation(JsonObject obj, ledAnimation_t &animation) {
+	static const char *patterns[] = {"fill", "bar", "dots", "wave"};
+
+	animation = ledAnimation_t();
+	const char *pattern = obj["pattern"] | "fill";
+	animation.pattern = UINT8_MAX;
+	for (uint8_t i = 0; i < sizeof(patterns) / sizeof(patterns[0]); i++) {
+		if (strcmp(pattern, patterns[i]) == 0) {
+			animation.pattern = i;
+		}
+	}
+	if (animation.pattern == UINT8_MAX) {
+		return false;
+	}
+	if (obj["loop"] | false) {
+		animation.flags |= LED_ANIMATION_LOOP;
+	}
+	if (obj["step"] | false) {
+		animation.flags |= LED_ANIMATION_STEP;
+	}
+	if (obj["mask"] | false) {
+		animation.flags |= LED_ANIMATION_MASK;
+	}
+	animation.dots = obj["dots"] | NUM_LEDS_IDLE_DOTS;
+	animation.rotateInterval = obj["rotate"] | 0;
+
+	JsonArray keyframes = obj["keyframes"];
+	if (keyframes.isNull() || keyframes.size() == 0 || keyframes.size() > ledAnimationMaxKeyframes) {
+		return false;
+	}
+	for (JsonVariant keyframeVariant : keyframes) {
+		JsonArray keyframe = keyframeVariant.as<JsonArray>();
+		ledKeyframe_t &k = animation.keyframes[animation.numKeyframes];
+		k.time = keyframe[0] | 0;
+		if (!Led_ParseColor(keyframe[1].as<const char *>(), k.color)) {
+			return false;
+		}
+		if (animation.numKeyframes > 0 && k.time <= animation.keyframes[animation.numKeyframes - 1].time) {
+			return false;
+		}
+		k.level = keyframe[2] | 255;
+		k.position = keyframe[3] | 0;
+		animation.numKeyframes++;
+	}
+
+	JsonArray palette = obj["palette"];
+	if (palette.size() > ledAnimationMaxPaletteColors) {
+		return false;
+	}
+	for (JsonVariant color : palette) {
+		if (!Led_ParseColor(color.as<const char *>(), animation.palette[animation.numPaletteColors++])) {
+			return false;
+		}
+	}
+	LedAnimation_Prepare(animation);
+	return true;
+}
+
+static const ledAnimation_t *Led_GetAnimation(const ledTimeline_t timeline) {
+	portENTER_CRITICAL(&Led_AnimationsMux);
+	const ledAnimation_t *animation = Led_Animations[timeline];
+	portEXIT_CRITICAL(&Led_AnimationsMux);
+	return animation;
+}
+
 void Led_DrawControls() {
 	#if NUM_CONTROL_LEDS > 0
 	static CRGB::HTMLColorCode controlLedColors[NUM_CONTROL_LEDS] = CONTROL_LEDS_COLORS;
@@ -250,12 +455,51 @@ void Led_SetButtonLedsEnabled(boolean value) {
 #endif
 }
 
+// Replaces default-animations by the ones found in ledAnimationsFile (keys: LedAnimation_TimelineNames).
+// Called by the main-task after boot, as SD isn't available before and the stack of the LED-task is too small for parsing.
+void Led_LoadAnimations(void) {
+#ifdef NEOPIXEL_ENABLE
+	if (!gFSystem.exists(ledAnimationsFile)) {
+		return;
+	}
+	File file = gFSystem.open(ledAnimationsFile);
+	DynamicJsonDocument doc(4096);
+	DeserializationError error = deserializeJson(doc, file);
+	file.close();
+	if (error) {
+		Log_Printf(LOGLEVEL_ERROR, jsonErrorMsg, error.c_str());
+		return;
+	}
+
+	for (uint8_t i = 0; i < LED_TIMELINE_COUNT; i++) {
+		JsonObject obj = doc[LedAnimation_TimelineNames[i]];
+		if (obj.isNull()) {
+			continue;
+		}
+		// kept until reboot, as the LED-task may still render the animation replaced
+		ledAnimation_t *animation = (ledAnimation_t *) malloc(sizeof(ledAnimation_t));
+		if (animation == nullptr) {
+			return;
+		}
+		if (Led_ParseAnimation(obj, *animation)) {
+			portENTER_CRITICAL(&Led_AnimationsMux);
+			Led_Animations[i] = animation;
+			portEXIT_CRITICAL(&Led_AnimationsMux);
+			Log_Printf(LOGLEVEL_INFO, ledAnimationLoaded, LedAnimation_TimelineNames[i]);
+		} else {
+			free(animation);
+			Log_Printf(LOGLEVEL_ERROR, ledAnimationInvalid, LedAnimation_TimelineNames[i]);
+		}
+	}
+#endif
+}
+
 #ifdef NEOPIXEL_ENABLE
-CRGB Led_DimColor(CRGB color, uint8_t brightness) {
-	const uint8_t factor = uint16_t(brightness * __UINT8_MAX__) / DIMMABLE_STATES;
-	return color.nscale8(factor);
+static ledRgb_t Led_Rgb(const CRGB color) {
+	return {color.r, color.g, color.b};
 }
-CRGB::HTMLColorCode Led_GetIdleColor() {
+
+ledRgb_t Led_GetIdleColor() {
 	CRGB::HTMLColorCode idleColor = CRGB::Black;
 	if ((OPMODE_BLUETOOTH_SINK == System_GetOperationMode()) || (OPMODE_BLUETOOTH_SOURCE == System_GetOperationMode())) {
 		if (Bluetooth_Device_Connected()) {
@@ -273,13 +517,7 @@ CRGB::HTMLColorCode Led_GetIdleColor() {
 			}
 		}
 	}
-	return idleColor;
-}
-
-void Led_DrawIdleDots(CRGBSet &leds, uint8_t offset, CRGB::HTMLColorCode color) {
-	for (uint8_t i = 0; i < NUM_LEDS_IDLE_DOTS; i++) {
-		leds[(Led_Address(offset) + i * Led_IdleDotDistance) % leds.size()] = color;
-	}
+	return Led_Rgb(idleColor);
 }
 
 bool CheckForPowerButtonAnimation() {
@@ -293,6 +531,24 @@ bool CheckForPowerButtonAnimation() {
 #endif
 
 #ifdef NEOPIXEL_ENABLE
+// Draws the frame of the animation onto the indicator-LEDs (virtual LED-addresses are mapped by Led_Address())
+static void Led_Render(const ledAnimation_t &animation, const ledAnimationInput_t &input, const bool startNewAnimation) {
+	static ledRgb_t frame[NUM_INDICATOR_LEDS];
+	if (animation.flags & LED_ANIMATION_MASK) {
+		// dims the frame shown at the start (not the one of the previous cycle)
+		if (startNewAnimation) {
+			for (uint8_t led = 0; led < NUM_INDICATOR_LEDS; led++) {
+				Led_AnimationState.frame[led] = Led_Rgb(indicator[Led_Address(led)]);
+			}
+		}
+		memcpy(frame, Led_AnimationState.frame, sizeof(frame));
+	}
+	LedAnimation_Render(animation, input, frame, NUM_INDICATOR_LEDS);
+	for (uint8_t led = 0; led < NUM_INDICATOR_LEDS; led++) {
+		indicator[Led_Address(led)] = CRGB(frame[led].r, frame[led].g, frame[led].b);
+	}
+}
+
 static void Led_Task(void *parameter) {
 	static uint8_t lastLedBrightness = Led_Brightness;
 	FastLED.addLeds<CHIPSET, LED_PIN, COLOR_ORDER>(leds, leds.size()).setCorrection(TypicalSMD5050);
@@ -301,8 +557,8 @@ static void Led_Task(void *parameter) {
 
 	LedAnimationType activeAnimation = LedAnimationType::NoNewAnimation;
 	LedAnimationType nextAnimation = LedAnimationType::NoNewAnimation;
-	bool animationActive = false;
-	int32_t animationTimer = 0;
+	bool animationActive = false; // has to be finished before an animation with lower priority is shown
+	bool animationFinished = true;
 
 	for (;;) {
 		// special handling
@@ -312,8 +568,8 @@ static void Led_Task(void *parameter) {
 		}
 
 		Led_DrawControls();
+		AudioPlayer_GetState(Led_PlayerState);
 
-		uint32_t taskDelay = 20;
 		bool startNewAnimation = false;
 
 		// check indications and set led-mode
@@ -340,33 +596,30 @@ static void Led_Task(void *parameter) {
 			nextAnimation = LedAnimationType::Rewind;
 		} else if (LED_INDICATOR_IS_SET(LedIndicatorType::PlaylistProgress)) {
 			nextAnimation = LedAnimationType::Playlist;
-		} else if (gPlayProperties.currentSpeechActive) {
+		} else if (Led_PlayerState.currentSpeechActive) {
 			nextAnimation = LedAnimationType::Speech;
-		} else if (gPlayProperties.playlistFinished) {
+		} else if (Led_PlayerState.playlistFinished) {
 			nextAnimation = LedAnimationType::Idle;
-		} else if (gPlayProperties.pausePlay && !gPlayProperties.isWebstream) {
+		} else if (Led_PlayerState.pausePlay && !Led_PlayerState.isWebstream) {
 			nextAnimation = LedAnimationType::Pause;
-		} else if (gPlayProperties.isWebstream) { // also animate pause in the webstream animation
+		} else if (Led_PlayerState.isWebstream) { // also animate pause in the webstream animation
 			nextAnimation = LedAnimationType::Webstream;
-		} else if ((gPlayProperties.playMode != BUSY) && (gPlayProperties.playMode != NO_PLAYLIST)) {
+		} else if ((Led_PlayerState.playMode != BUSY) && (Led_PlayerState.playMode != NO_PLAYLIST)) {
 			nextAnimation = LedAnimationType::Progress;
-		} else if (gPlayProperties.playMode == NO_PLAYLIST) {
+		} else if (Led_PlayerState.playMode == NO_PLAYLIST) {
 			nextAnimation = LedAnimationType::Idle;
-		} else if (gPlayProperties.playMode == BUSY) {
+		} else if (Led_PlayerState.playMode == BUSY) {
 			nextAnimation = LedAnimationType::Busy;
 		} else {
 			nextAnimation = LedAnimationType::NoNewAnimation; // should not happen
 		}
 
-		// check for instant transition if the requested animation has a higher priority then the current one
-		if (nextAnimation < activeAnimation) {
-			animationActive = false; // abort current animation
-			animationTimer = 0;
-		}
-		// transition to new animation
-		if ((!animationActive) && (animationTimer <= 0)) {
-			activeAnimation = nextAnimation; // set new animation
+		// instant transition if the requested animation has a higher priority then the current one,
+		// otherwise as soon as the current one isn't active anymore (a finished one is started again)
+		if ((nextAnimation < activeAnimation) || (!animationActive && (nextAnimation != activeAnimation || animationFinished))) {
+			activeAnimation = nextAnimation;
 			startNewAnimation = true;
+			Led_AnimationState.start = millis();
 		}
 
 		// apply brightness-changes
@@ -375,92 +628,45 @@ static void Led_Task(void *parameter) {
 			lastLedBrightness = Led_Brightness;
 		}
 
-		// when there is no delay anymore we have to animate something
-		if (animationTimer <= 0) {
-			AnimationReturnType ret;
-			// animate the current animation
-			switch (activeAnimation) {
-				case LedAnimationType::Boot:
-					ret = Animation_Boot(startNewAnimation, indicator);
-					break;
-
-				case LedAnimationType::Shutdown:
-					ret = Animation_Shutdown(startNewAnimation, indicator);
-					break;
-
-				case LedAnimationType::Error:
-					ret = Animation_Error(startNewAnimation, indicator);
-					break;
-
-				case LedAnimationType::Ok:
-					ret = Animation_Ok(startNewAnimation, indicator);
-					break;
-
-				case LedAnimationType::Volume:
-					ret = Animation_Volume(startNewAnimation, indicator);
-					break;
-
-				case LedAnimationType::VoltageWarning:
-					ret = Animation_VoltageWarning(startNewAnimation, indicator);
-					break;
-
-				case LedAnimationType::BatteryMeasurement:
-					ret = Animation_BatteryMeasurement(startNewAnimation, indicator);
-					break;
-
-				case LedAnimationType::Rewind:
-					ret = Animation_Rewind(startNewAnimation, indicator);
-					break;
-
-				case LedAnimationType::Playlist:
-					ret = Animation_PlaylistProgress(startNewAnimation, indicator);
-					break;
-
-				case LedAnimationType::Idle:
-					ret = Animation_Idle(startNewAnimation, indicator);
-					break;
-
-				case LedAnimationType::Busy:
-					ret = Animation_Busy(startNewAnimation, indicator);
-					break;
-
-				case LedAnimationType::Speech:
-					ret = Animation_Speech(startNewAnimation, indicator);
-					break;
-
-				case LedAnimationType::Pause:
-					ret = Animation_Pause(startNewAnimation, indicator);
-					break;
-
-				case LedAnimationType::Progress:
-					ret = Animation_Progress(startNewAnimation, indicator);
-					break;
-
-				case LedAnimationType::Webstream:
-					ret = Animation_Webstream(startNewAnimation, indicator);
-					break;
-
-				default:
-					indicator = CRGB::Black;
-					FastLED.show();
-					ret.animationActive = false;
-					ret.animationDelay = 50;
-					break;
+		// render frame of the current animation
+		const ledAnimation_t *animation = nullptr;
+		ledAnimationInput_t input;
+		input.time = millis() - Led_AnimationState.start;
+		animationFinished = false;
+		if (activeAnimation == LedAnimationType::NoNewAnimation) {
+			indicator = CRGB::Black;
+		} else {
+			const ledAnimationBinding_t &binding = Led_AnimationBindings[(uint8_t) activeAnimation];
+			animation = Led_GetAnimation(binding.timeline);
+			if (binding.bind) {
+				animation = binding.bind(animation, startNewAnimation, input);
 			}
-			// apply delay and state from animation
-			animationActive = ret.animationActive;
-			animationTimer = ret.animationDelay;
-			if (ret.animationRefresh) {
-				FastLED.show();
+			if (animation) {
+				Led_Render(*animation, input, startNewAnimation);
+				animationFinished = LedAnimation_Finished(*animation, input.time);
+			} else {
+				animationFinished = true;
 			}
 		}
-
-		// get the time to wait and delay the task
-		if ((animationTimer > 0) && (animationTimer < taskDelay)) {
-			taskDelay = animationTimer;
+		animationActive = animation && !animationFinished && !(animation->flags & LED_ANIMATION_LOOP);
+		Led_Show(activeAnimation);
+
+		// sleep until the frame changes or until woken up by Led_Wakeup() (indication, brightness or state changed)
+		TickType_t ticksToWait = portMAX_DELAY;
+		if (animationFinished && !(startNewAnimation && animation && nextAnimation == activeAnimation)) {
+			ticksToWait = 0; // next animation (a finished one that was just started again, stays until woken up)
+		} else if (Led_FramePending) {
+			ticksToWait = pdMS_TO_TICKS(Led_FrameInterval[(uint8_t) activeAnimation]);
+		} else if (Led_Brightness == 0) {
+			// LEDs are off (e.g. nightmode): nothing to animate
+		} else if (animation) {
+			const uint32_t nextChange = LedAnimation_NextChange(*animation, input.time);
+			if (nextChange != UINT32_MAX) {
+				ticksToWait = pdMS_TO_TICKS((nextChange > 0) ? nextChange : LED_ANIMATION_FRAME_INTERVAL);
+			}
 		}
-		animationTimer -= taskDelay;
-		vTaskDelay(portTICK_PERIOD_MS * taskDelay);
+		ulTaskNotifyTake(pdTRUE, ticksToWait);
+		gLedStats.wakeups++;
 	}
 	vTaskDelete(NULL);
 }
@@ -468,685 +674,245 @@ static void Led_Task(void *parameter) {
 
 #ifdef NEOPIXEL_ENABLE
 // ---------------------------------------------------------------------
-// ---------------        ANIMATION-METHODS        ---------------------
+// ---------------        ANIMATION-BINDERS        ---------------------
 // ---------------------------------------------------------------------
-// * each function has to be non-blocking.
-// * all states are kept in this function.
-// * all funcitons return the desired delay and if they are still active
-// * the function will be called the next time when the returned delay has
-// passed
-// * the optional Start Flag signals that the animation is started new
-
-// --------------------------------
-// BOOT-UP Animation
-// --------------------------------
-AnimationReturnType Animation_Boot(const bool startNewAnimation, CRGBSet &leds) {
-	(void) startNewAnimation; // start is not used
-	// static vars
-	static bool showEvenError = false;
+// * all animations are keyframe-animations (LedAnimationDefaults.h or ledAnimationsFile)
+// * binders adapt them to the device-state (level, position, color) for every frame
+// * states that have to be kept between two frames are in Led_AnimationState
+// * the animation is finished after its last keyframe (unless it loops) or if nullptr is returned
 
-	// 10 s without success?
-	if (millis() > 10000) {
-		leds = CRGB::Red;
-		if (showEvenError) {
-			// and then draw in the black dots
-			for (uint8_t i = 0; i < leds.size(); i += 2) {
-				leds[i] = CRGB::Black;
-			}
-		}
-	} else {
-		leds = CRGB::Black;
-		const uint8_t startLed = (showEvenError) ? 1 : 0;
-		for (uint8_t i = startLed; i < leds.size(); i += 2) {
-			leds[i] = CRGB::Orange;
-		}
-	}
-	showEvenError = !showEvenError;
-
-	return AnimationReturnType(false, 500, true); // always wait 500 ms
+// Level of a value between 0 and max (0..255)
+static uint8_t Led_Level(const double value, const double max) {
+	return (max > 0) ? std::clamp<double>(value * 255 / max, 0, 255) : 0u;
 }
 
-// --------------------------------
-// Shutdown Animation
-// --------------------------------
-AnimationReturnType Animation_Shutdown(const bool startNewAnimation, CRGBSet &leds) {
-	// return values
-	bool animationActive = true;
-	int32_t animationDelay = 0;
-	// static vars
-	static bool singleLedStatus = false;
-	static uint32_t animationIndex = 0;
-	if (startNewAnimation) {
-		animationIndex = 0;
-	}
-
-	if constexpr (NUM_INDICATOR_LEDS == 1) {
-		leds = CRGB::Black;
-		if (millis() - gButtons[gShutdownButton].firstPressedTimestamp <= intervalToLongPress) {
-			leds[0] = CRGB::Red;
-			animationDelay = 5;
-		} else {
-			if (singleLedStatus) {
-				leds[0] = CRGB::Red;
-			}
-			singleLedStatus = !singleLedStatus;
-			animationDelay = 50;
-		}
-		animationActive = false;
+// Shows a level by the length of a bar or with a single LED by the color (palette-gradient of the animation)
+static void Led_SetLevel(const ledAnimation_t &animation, const uint8_t level, ledAnimationInput_t &input) {
+	if (NUM_INDICATOR_LEDS == 1 && animation.numPaletteColors > 0) {
+		input.overrideColor = true;
+		input.color = LedAnimation_Gradient(animation, level);
 	} else {
-		if ((millis() - gButtons[gShutdownButton].firstPressedTimestamp >= intervalToLongPress) && (animationIndex >= leds.size())) {
-			animationDelay = 50;
-			if (!gButtons[gShutdownButton].isPressed) {
-				// increase animation index to bail out, if we had a kombi-button
-				animationIndex++;
-				if (animationIndex >= leds.size() + 3) {
-					animationActive = false; // this is approx. 150ms after the button is released
-				}
-			}
-		} else {
-			if (animationIndex == 0) {
-				leds = CRGB::Black;
-			}
-			if (animationIndex < leds.size()) {
-				leds[Led_Address(animationIndex)] = CRGB::Red;
-				if (gButtons[gShutdownButton].currentState) {
-					animationDelay = 5;
-					animationActive = false;
-				} else {
-					animationDelay = intervalToLongPress / leds.size();
-				}
-				animationIndex++;
-			}
-		}
+		input.level = level;
 	}
-	return AnimationReturnType(animationActive, animationDelay, true);
 }
 
 // --------------------------------
-// Error Animation
+// BOOT-UP Animation
 // --------------------------------
-AnimationReturnType Animation_Error(const bool startNewAnimation, CRGBSet &leds) {
-	// return values
-	bool animationActive = true;
-	uint16_t animationDelay = 0;
-	// static vars
-	static bool singleLedStatus = false;
-	static uint16_t animationIndex = 0;
-	if (startNewAnimation) {
-		animationIndex = 0;
-	}
+static const ledAnimation_t *Led_BindBoot(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input) {
+	(void) startNewAnimation;
+	(void) input;
 
-	if constexpr (NUM_INDICATOR_LEDS == 1) {
-		leds = CRGB::Black;
-		if (singleLedStatus) {
-			leds[0] = CRGB::Red;
-		}
-		singleLedStatus = !singleLedStatus;
-
-		if (animationIndex < 5) {
-			animationIndex++;
-			animationDelay = 100;
-		} else {
-			animationActive = false;
-		}
-	} else {
-		leds = CRGB::Red;
-		if (animationIndex > 0) {
-			animationActive = false;
-		} else {
-			animationIndex++;
-			animationDelay = 200;
-		}
+	// 10 s without success?
+	if (millis() > 10000) {
+		return Led_GetAnimation(LED_TIMELINE_BOOTERROR);
 	}
-	return AnimationReturnType(animationActive, animationDelay, true);
+	return animation;
 }
+
 // --------------------------------
-// OK Animation
+// Shutdown Animation
 // --------------------------------
-AnimationReturnType Animation_Ok(const bool startNewAnimation, CRGBSet &leds) {
-	// return values
-	bool animationActive = true;
-	uint16_t animationDelay = 0;
-	// static vars
-	static bool singleLedStatus = false;
-	static uint16_t animationIndex = 0;
-	if (startNewAnimation) {
-		animationIndex = 0;
-	}
-
-	if constexpr (NUM_INDICATOR_LEDS == 1) {
-		leds = CRGB::Black;
-		if (singleLedStatus) {
-			leds[0] = CRGB::Green;
-		}
-		singleLedStatus = !singleLedStatus;
+// Timed by the shutdown-button (complete at long-press), shown as long as the button is pressed
+static const ledAnimation_t *Led_BindShutdown(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input) {
+	(void) startNewAnimation;
 
-		if (animationIndex < 5) {
-			animationIndex++;
-			animationDelay = 100;
-		} else {
-			animationActive = false;
-		}
-	} else {
-		leds = CRGB::Green;
-		if (animationIndex > 0) {
-			animationActive = false;
-		} else {
-			animationIndex++;
-			animationDelay = 400;
-		}
-	}
-	return AnimationReturnType(animationActive, animationDelay, true);
+	input.time = millis() - gButtons[gShutdownButton].firstPressedTimestamp;
+	return animation;
 }
 
 // --------------------------------
-// VoltageWarning Animation
+// Volume-Change Animation
 // --------------------------------
-// Single + Multiple LEDs: flashes red three times if battery-voltage is low
-AnimationReturnType Animation_VoltageWarning(const bool startNewAnimation, CRGBSet &leds) {
-	// return values
-	bool animationActive = true;
-	uint16_t animationDelay = 0;
-	// static vars
-	static uint16_t animationIndex = 0;
-
-	if (startNewAnimation) {
-		animationIndex = 0;
-	}
-
-	leds = CRGB::Black;
-	if (animationIndex % 2 == 0) {
-		leds = CRGB::Red;
-	}
+// - Single-LED: led indicates loudness between green (low) => red (high)
+// - Multiple-LEDs: number of LEDs indicate loudness; gradient is shown between
+//   green (low) => red (high)
+static const ledAnimation_t *Led_BindVolume(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input) {
+	(void) startNewAnimation;
 
-	if (animationIndex < 6) {
-		animationIndex++;
-		animationDelay = 200;
-	} else {
-		animationActive = false;
+	// start again if volume changes
+	if (LED_INDICATOR_IS_SET(LedIndicatorType::VolumeChange)) {
+		LED_INDICATOR_CLEAR(LedIndicatorType::VolumeChange);
+		Led_AnimationState.start = millis();
+		input.time = 0;
 	}
-	return AnimationReturnType(animationActive, animationDelay, true);
+	const uint8_t maxVolume = (NUM_INDICATOR_LEDS == 1) ? AudioPlayer_GetMaxVolumeSpeaker() : AudioPlayer_GetMaxVolume();
+	Led_SetLevel(*animation, Led_Level(AudioPlayer_GetCurrentVolume(), maxVolume), input);
+	return animation;
 }
 
 // --------------------------------
-// Webstream Animation
+// BATTERY_MEASUREMENT Animation
 // --------------------------------
-// Animates the progress and Pause of a Webstream
-AnimationReturnType Animation_Webstream(const bool startNewAnimation, CRGBSet &leds) {
-	// return values
-	bool animationActive = false;
-	bool refresh = false;
-	int32_t animationDelay = 0;
-	// static vars
-	static uint8_t ledPosWebstream = 0;
-	static uint8_t webstreamColor = 0;
-	static uint16_t timerProgress = 0;
-
-	// pause-animation
-	if (gPlayProperties.pausePlay) {
-		leds = CRGB::Black;
-		CRGB::HTMLColorCode generalColor = CRGB::Orange;
-		if (OPMODE_BLUETOOTH_SINK == System_GetOperationMode()) {
-			generalColor = CRGB::Blue;
-		}
-		if constexpr (NUM_INDICATOR_LEDS == 1) {
-			leds[0] = generalColor;
-		} else {
-			leds[Led_Address(ledPosWebstream)] = generalColor;
-			leds[(Led_Address(ledPosWebstream) + leds.size() / 2) % leds.size()] = generalColor;
-		}
-		animationDelay = 10;
-		timerProgress = 0; // directly show new animation after pause
-		refresh = true;
-	} else {
-		if (startNewAnimation || timerProgress == 0) {
-			leds = CRGB::Black;
-			timerProgress = 100;
-			if (ledPosWebstream + 1 < leds.size()) {
-				ledPosWebstream++;
-			} else {
-				ledPosWebstream = 0;
-			}
-			if (System_AreControlsLocked()) {
-				leds[Led_Address(ledPosWebstream)] = CRGB::Red;
-				if constexpr (NUM_INDICATOR_LEDS > 1) {
-					leds[(Led_Address(ledPosWebstream) + leds.size() / 2) % leds.size()] = CRGB::Red;
-				}
-			} else {
-				if constexpr (NUM_INDICATOR_LEDS == 1) {
-					leds[0].setHue(webstreamColor++);
-				} else {
-					if (OPMODE_BLUETOOTH_SINK == System_GetOperationMode()) {
-						leds[Led_Address(ledPosWebstream)] = CRGB::Blue;
-						leds[(Led_Address(ledPosWebstream) + leds.size() / 2) % leds.size()] = CRGB::Blue;
-					} else {
-						leds[Led_Address(ledPosWebstream)].setHue(webstreamColor);
-						leds[(Led_Address(ledPosWebstream) + leds.size() / 2) % leds.size()].setHue(webstreamColor++);
-					}
-				}
-			}
-			refresh = true;
-		}
-		timerProgress--;
-		animationDelay = 45;
-		if (timerProgress > 0) {
-			animationActive = true;
-		}
-	}
-	return AnimationReturnType(animationActive, animationDelay, refresh);
-}
+// Single-LED: indicates voltage coloured between gradient green (high) => red (low)
+// Multi-LED: number of LEDs indicates voltage-level with having green >= 60% ; orange < 60% + >= 30% ; red < 30%
+static const ledAnimation_t *Led_BindBatteryMeasurement(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input) {
+	LED_INDICATOR_CLEAR(LedIndicatorType::Voltage);
 
-// --------------------------------
-// Rewind Animation
-// --------------------------------
-AnimationReturnType Animation_Rewind(const bool startNewAnimation, CRGBSet &leds) {
-	// return values
-	bool animationActive = false;
-	bool refresh = false;
-	int32_t animationDelay = 0;
-	// static vars
-	static uint16_t animationIndex = 0;
 	if (startNewAnimation) {
-		animationIndex = 0;
-	}
-
-	if constexpr (NUM_INDICATOR_LEDS >= 4) {
-		animationActive = true;
-
-		if (animationIndex < (leds.size())) {
-			leds[Led_Address(leds.size() - 1 - animationIndex)] = CRGB::Black;
-			refresh = true;
-			animationDelay = 30;
-			animationIndex++;
-		} else {
-			animationActive = false;
+	#ifdef BATTERY_MEASURE_ENABLE
+		float batteryLevel = Battery_EstimateLevel();
+	#else
+		float batteryLevel = 1.0f;
+	#endif
+		if (batteryLevel < 0.0f) { // If voltage is too low or no battery is connected
+			LED_INDICATOR_SET(LedIndicatorType::Error);
+			return nullptr; // abort to indicate error
 		}
+		Led_AnimationState.batteryLevel = Led_Level(batteryLevel, 1.0);
 	}
-	return AnimationReturnType(animationActive, animationDelay, refresh);
-}
-
-// --------------------------------
-// Idle Animation
-// --------------------------------
-AnimationReturnType Animation_Idle(const bool startNewAnimation, CRGBSet &leds) {
-	// return values
-	int32_t animationDelay = 0;
-	bool animationActive = true;
-	bool refresh = true;
-	// static vars
-	static int16_t ledIndex = 0;
-	// this can be removed to always continue on the last position in idle
-	if (startNewAnimation) {
-		ledIndex = 0;
+	const uint8_t level = Led_AnimationState.batteryLevel;
+	if constexpr (NUM_INDICATOR_LEDS > 1) {
+		input.level = level;
 	}
-
-	if (ledIndex < leds.size()) {
-		CRGB::HTMLColorCode idleColor = Led_GetIdleColor();
-		leds = CRGB::Black;
-		Led_DrawIdleDots(leds, ledIndex, idleColor);
-		if (OPMODE_BLUETOOTH_SOURCE == System_GetOperationMode()) {
-			// animate a bit faster in BT-Source to distinguish between the bluetooth modes
-			animationDelay = 30 * 10;
-		} else {
-			animationDelay = 50 * 10;
-		}
-		ledIndex++;
+	input.overrideColor = true;
+	if (level < Led_Level(0.3, 1.0)) {
+		input.color = Led_Rgb(CRGB::Red);
+	} else if (level < Led_Level(0.6, 1.0)) {
+		input.color = Led_Rgb(CRGB::Orange);
 	} else {
-		animationActive = false;
-		refresh = false;
-		ledIndex = 0;
+		input.color = Led_Rgb(CRGB::Green);
 	}
-	return AnimationReturnType(animationActive, animationDelay, refresh);
+	return animation;
 }
 
 // --------------------------------
-// Busy Animation
+// PLAYLIST-PROGRESS Animation
 // --------------------------------
-AnimationReturnType Animation_Busy(const bool startNewAnimation, CRGBSet &leds) {
-	// return values
-	bool animationActive = true;
-	int32_t animationDelay = 0;
-	// static vars
-	static bool singleLedStatus = false;
-	static uint16_t animationIndex = 0;
-	if (startNewAnimation) {
-		animationIndex = 0;
-	}
-	if constexpr (NUM_INDICATOR_LEDS == 1) {
-		leds = CRGB::Black;
-		singleLedStatus = !singleLedStatus;
-		if (singleLedStatus) {
-			leds[0] = CRGB::BlueViolet;
+// Builds the animation from the bar shown (from) to the one of the current track (to). Timing is taken from the
+// "playlist"-animation if it has the default form (fill, wait, empty), otherwise it's scaled to the current track.
+static void Led_StartPlaylistAnimation(const ledAnimation_t &animation, const uint8_t from, const uint8_t to) {
+	ledAnimation_t &playlist = Led_AnimationState.playlist;
+	playlist = animation;
+	if (animation.numKeyframes != 4) {
+		for (uint8_t k = 0; k < playlist.numKeyframes; k++) {
+			playlist.keyframes[k].level = (playlist.keyframes[k].level * (to + 1u)) >> 8;
 		}
-		animationDelay = 100;
-		animationActive = false;
-	} else {
-		if (animationIndex < leds.size()) {
-			leds = CRGB::Black;
-			CRGB::HTMLColorCode idleColor = Led_GetIdleColor();
-			Led_DrawIdleDots(leds, animationIndex, idleColor);
-			animationDelay = 50;
-			animationIndex++;
-		} else {
-			animationActive = false;
+		return;
+	}
+	const ledKeyframe_t *keyframes = animation.keyframes;
+	const uint16_t fill = (uint32_t) abs(to - from) * (keyframes[1].time - keyframes[0].time) / 255u;
+	const uint16_t wait = keyframes[2].time - keyframes[1].time;
+	const uint16_t empty = (uint32_t) to * (keyframes[3].time - keyframes[2].time) / 255u;
+	playlist.keyframes[0].time = 0;
+	playlist.keyframes[0].level = from;
+	playlist.keyframes[1].time = fill;
+	playlist.keyframes[1].level = to;
+	playlist.keyframes[2].time = fill + wait;
+	playlist.keyframes[2].level = to;
+	playlist.keyframes[3].time = fill + wait + empty;
+	playlist.keyframes[3].level = 0;
+}
+
+static const ledAnimation_t *Led_BindPlaylist(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input) {
+	if (LED_INDICATOR_IS_SET(LedIndicatorType::PlaylistProgress)) {
+		LED_INDICATOR_CLEAR(LedIndicatorType::PlaylistProgress);
+		if (Led_PlayerState.numberOfTracks > 1 && Led_PlayerState.currentTrackNumber < Led_PlayerState.numberOfTracks) {
+			// only animate diff, if triggered again
+			const uint8_t from = startNewAnimation ? 0u : LedAnimation_Sample(Led_AnimationState.playlist, input.time).level;
+			Led_StartPlaylistAnimation(*animation, from, Led_Level(Led_PlayerState.currentTrackNumber, Led_PlayerState.numberOfTracks - 1));
+			Led_AnimationState.start = millis();
+			input.time = 0;
+		} else if (startNewAnimation) {
+			return nullptr; // nothing to show
 		}
 	}
-	return AnimationReturnType(animationActive, animationDelay, true);
+	return &Led_AnimationState.playlist;
 }
 
 // --------------------------------
 // Pause Animation
 // --------------------------------
 // Animates the pause if no Webstream is active
-AnimationReturnType Animation_Pause(const bool startNewAnimation, CRGBSet &leds) {
-	(void) startNewAnimation; // start is not used
+static const ledAnimation_t *Led_BindPause(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input) {
+	(void) startNewAnimation;
 
-	leds = CRGB::Black;
-	CRGB::HTMLColorCode generalColor = CRGB::Orange;
 	if (OPMODE_BLUETOOTH_SOURCE == System_GetOperationMode()) {
-		generalColor = CRGB::Blue;
-	}
-
-	uint8_t pauseOffset = 0;
-	if (OFFSET_PAUSE_LEDS) {
-		pauseOffset = ((leds.size() / NUM_LEDS_IDLE_DOTS) / 2) - 1;
-	}
-	Led_DrawIdleDots(leds, pauseOffset, generalColor);
-
-	return AnimationReturnType(false, 10, true);
-}
-
-// --------------------------------
-// Speech Animation
-// --------------------------------
-// only draw yellow pause-dots
-AnimationReturnType Animation_Speech(const bool startNewAnimation, CRGBSet &leds) {
-	(void) startNewAnimation; // start is not used
-
-	leds = CRGB::Black;
-	uint8_t pauseOffset = 0;
-	if (OFFSET_PAUSE_LEDS) {
-		pauseOffset = ((leds.size() / NUM_LEDS_IDLE_DOTS) / 2) - 1;
+		input.overrideColor = true;
+		input.color = Led_Rgb(CRGB::Blue);
 	}
-	Led_DrawIdleDots(leds, pauseOffset, CRGB::Yellow);
-
-	return AnimationReturnType(false, 10, true);
+	return animation;
 }
 
 // --------------------------------
 // Progress in Track Animation
 // --------------------------------
-AnimationReturnType Animation_Progress(const bool startNewAnimation, CRGBSet &leds) {
-	// return values
-	int32_t animationDelay = 0;
-	// static values
-	static double lastPos = 0.0f;
-
-	if (gPlayProperties.currentRelPos != lastPos || startNewAnimation) {
-		lastPos = gPlayProperties.currentRelPos;
-		leds = CRGB::Black;
-		if constexpr (NUM_INDICATOR_LEDS == 1) {
-			leds[0].setHue((uint8_t) (85 - ((double) 90 / 100) * gPlayProperties.currentRelPos));
-		} else {
-			const uint32_t ledValue = std::clamp<uint32_t>(map(gPlayProperties.currentRelPos, 0, 98, 0, leds.size() * DIMMABLE_STATES), 0, leds.size() * DIMMABLE_STATES);
-			const uint8_t fullLeds = ledValue / DIMMABLE_STATES;
-			const uint8_t lastLed = ledValue % DIMMABLE_STATES;
-			for (uint8_t led = 0; led < fullLeds; led++) {
-				if (System_AreControlsLocked()) {
-					leds[Led_Address(led)] = CRGB::Red;
-				} else if (!gPlayProperties.pausePlay) { // Hue-rainbow
-					leds[Led_Address(led)].setHue((uint8_t) (((float) PROGRESS_HUE_END - (float) PROGRESS_HUE_START) / (leds.size() - 1) * led + PROGRESS_HUE_START));
-				}
-			}
-			if (lastLed > 0) {
-				if (System_AreControlsLocked()) {
-					leds[Led_Address(fullLeds)] = CRGB::Red;
-				} else {
-					leds[Led_Address(fullLeds)].setHue((uint8_t) (((float) PROGRESS_HUE_END - (float) PROGRESS_HUE_START) / (leds.size() - 1) * fullLeds + PROGRESS_HUE_START));
-				}
-				leds[Led_Address(fullLeds)] = Led_DimColor(leds[Led_Address(fullLeds)], lastLed);
-			}
-		}
-		animationDelay = 10;
+static const ledAnimation_t *Led_BindProgress(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input) {
+	(void) startNewAnimation;
+
+	Led_SetLevel(*animation, Led_Level(Led_PlayerState.currentRelPos, (NUM_INDICATOR_LEDS == 1) ? 100 : 98), input);
+	if (NUM_INDICATOR_LEDS > 1 && System_AreControlsLocked()) {
+		input.overrideColor = true;
+		input.color = Led_Rgb(CRGB::Red);
 	}
-	return AnimationReturnType(false, animationDelay, true);
+	return animation;
 }
 
 // --------------------------------
-// Volume-Change Animation
+// Webstream Animation
 // --------------------------------
-// - Single-LED: led indicates loudness between green (low) => red (high)
-// - Multiple-LEDs: number of LEDs indicate loudness; gradient is shown between
-//   green (low) => red (high)
-AnimationReturnType Animation_Volume(const bool startNewAnimation, CRGBSet &leds) {
-	// return-values
-	int32_t animationDelay = 0;
-	bool animationActive = true;
-	// static values
-	static uint16_t cyclesWaited = 0;
-
-	// wait for further volume changes within next 20ms for 50 cycles = 1s
-	const uint32_t ledValue = std::clamp<uint32_t>(map(AudioPlayer_GetCurrentVolume(), 0, AudioPlayer_GetMaxVolume(), 0, leds.size() * DIMMABLE_STATES), 0, leds.size() * DIMMABLE_STATES);
-	const uint8_t fullLeds = ledValue / DIMMABLE_STATES;
-	const uint8_t lastLed = ledValue % DIMMABLE_STATES;
-
-	leds = CRGB::Black;
-
-	if constexpr (NUM_INDICATOR_LEDS == 1) {
-		const uint8_t hue = 85 - (90 * ((double) AudioPlayer_GetCurrentVolume() / (double) AudioPlayer_GetMaxVolumeSpeaker()));
-		leds[0].setHue(hue);
+// Animates the progress and Pause of a Webstream
+static const ledAnimation_t *Led_BindWebstream(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input) {
+	ledAnimationState_t &state = Led_AnimationState;
+
+	input.overrideColor = true;
+	if (Led_PlayerState.pausePlay) {
+		state.webstreamPaused = true;
+		input.time = 0; // stays at its position
+		input.color = Led_Rgb((OPMODE_BLUETOOTH_SINK == System_GetOperationMode()) ? CRGB::Blue : CRGB::Orange);
 	} else {
-		/*
-		 * (Inverse) color-gradient from green (85) back to (still)
-		 * red (250) using unsigned-cast.
-		 */
-		for (int led = 0; led < fullLeds; led++) {
-			const uint8_t hue = (-86.0f) / (leds.size() - 1) * led + 85.0f;
-			leds[Led_Address(led)].setHue(hue);
-		}
-		if (lastLed > 0) {
-			const uint8_t hue = (-86.0f) / (leds.size() - 1) * fullLeds + 85.0f;
-			leds[Led_Address(fullLeds)].setHue(hue);
-			leds[Led_Address(fullLeds)] = Led_DimColor(leds[Led_Address(fullLeds)], lastLed);
+		// directly move on after pause
+		if (startNewAnimation || state.webstreamPaused) {
+			state.webstreamPaused = false;
+			state.webstreamCycle = UINT32_MAX;
+			state.start = millis();
+			input.time = 0;
+		}
+		// move on with every cycle of the animation
+		const uint16_t duration = LedAnimation_Duration(*animation);
+		const uint32_t cycle = (duration > 0) ? input.time / duration : 0u;
+		if (cycle != state.webstreamCycle) {
+			state.webstreamCycle = cycle;
+			state.webstreamPosition = (state.webstreamPosition + 1u) % NUM_INDICATOR_LEDS;
+			state.webstreamHue++;
+		}
+		if (System_AreControlsLocked()) {
+			input.color = Led_Rgb(CRGB::Red);
+		} else if (NUM_INDICATOR_LEDS > 1 && OPMODE_BLUETOOTH_SINK == System_GetOperationMode()) {
+			input.color = Led_Rgb(CRGB::Blue);
+		} else {
+			input.color = LedAnimation_Hue(state.webstreamHue);
 		}
 	}
-
-	// reset animation if volume changes
-	if (LED_INDICATOR_IS_SET(LedIndicatorType::VolumeChange) || startNewAnimation) {
-		LED_INDICATOR_CLEAR(LedIndicatorType::VolumeChange);
-		cyclesWaited = 0;
-	}
-
-	if (cyclesWaited < LED_VOLUME_INDICATOR_NUM_CYCLES) {
-		animationDelay = 20;
-		cyclesWaited++;
-	} else {
-		animationActive = false;
-		cyclesWaited = 0;
-	}
-	return AnimationReturnType(animationActive, animationDelay, true);
+	input.position = LedAnimation_Position(state.webstreamPosition, NUM_INDICATOR_LEDS);
+	return animation;
 }
 
 // --------------------------------
-// PLAYLIST-PROGRESS Animation
+// Idle Animation
 // --------------------------------
-AnimationReturnType Animation_PlaylistProgress(const bool startNewAnimation, CRGBSet &leds) {
-	// return-values
-	static bool animationActive = false; // signals if the animation is currently active
-	int32_t animationDelay = 0;
-	// static variables for animation
-	static uint32_t animationCounter = 0; // counter-variable to loop through leds or to wait
-	static uint32_t staticLastBarLenghtPlaylist = 0; // variable to remember the last length of the progress-bar (for connecting animations)
-	static uint32_t staticLastTrack = 0; // variable to remember the last track (for connecting animations)
-
-	if constexpr (NUM_INDICATOR_LEDS >= 4) {
-		if (gPlayProperties.numberOfTracks > 1 && gPlayProperties.currentTrackNumber < gPlayProperties.numberOfTracks) {
-			const uint32_t ledValue = std::clamp<uint32_t>(map(gPlayProperties.currentTrackNumber, 0, gPlayProperties.numberOfTracks - 1, 0, leds.size() * DIMMABLE_STATES), 0, leds.size() * DIMMABLE_STATES);
-			const uint8_t fullLeds = ledValue / DIMMABLE_STATES;
-			const uint8_t lastLed = ledValue % DIMMABLE_STATES;
-			static LedPlaylistProgressStates animationState = LedPlaylistProgressStates::Done; // Statemachine-variable of this animation
-
-			if (LED_INDICATOR_IS_SET(LedIndicatorType::PlaylistProgress)) {
-				LED_INDICATOR_CLEAR(LedIndicatorType::PlaylistProgress);
-				// check if we need to animate a transition between from an already running animation
-				// only animate diff, if triggered again
-				if (!startNewAnimation) {
-					// forward progress
-					if (staticLastTrack < gPlayProperties.currentTrackNumber) {
-						if (animationState > LedPlaylistProgressStates::FillBar) {
-							animationState = LedPlaylistProgressStates::FillBar;
-							animationCounter = staticLastBarLenghtPlaylist;
-						}
-						// backwards progress
-					} else if (staticLastTrack > gPlayProperties.currentTrackNumber) {
-						if (staticLastBarLenghtPlaylist < fullLeds) {
-							animationState = LedPlaylistProgressStates::FillBar;
-							animationCounter = staticLastBarLenghtPlaylist;
-						} else {
-							animationState = LedPlaylistProgressStates::EmptyBarToTarget;
-							animationCounter = staticLastBarLenghtPlaylist;
-						}
-					}
-				}
-				staticLastTrack = gPlayProperties.currentTrackNumber;
-			}
-
-			if (startNewAnimation) {
-				animationActive = true;
-				animationCounter = 0;
-				animationState = LedPlaylistProgressStates::FillBar;
-			}
+static const ledAnimation_t *Led_BindIdle(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input) {
+	(void) startNewAnimation;
 
-			animationDelay = 30;
-			uint8_t barLength = 0;
-			switch (animationState) {
-				case LedPlaylistProgressStates::FillBar:
-					barLength = animationCounter;
-					if (animationCounter >= fullLeds) {
-						animationState = LedPlaylistProgressStates::Wait;
-						animationCounter = 0;
-					} else {
-						animationCounter++;
-					}
-					break;
-				case LedPlaylistProgressStates::Wait:
-					// wait
-					animationCounter++;
-					if (animationCounter >= 50) {
-						animationState = LedPlaylistProgressStates::EmptyBar;
-						animationCounter = fullLeds;
-					}
-					barLength = fullLeds;
-					break;
-				case LedPlaylistProgressStates::EmptyBar:
-					// negative
-					barLength = animationCounter;
-					if (animationCounter == 0) {
-						animationState = LedPlaylistProgressStates::Done;
-					} else {
-						animationCounter--;
-					}
-					break;
-				case LedPlaylistProgressStates::EmptyBarToTarget:
-					// move back to target and wait there
-					barLength = animationCounter;
-					if (animationCounter <= fullLeds) {
-						animationState = LedPlaylistProgressStates::Wait;
-						animationCounter = 0;
-					} else {
-						animationCounter--;
-					}
-					break;
-				default:
-					// done
-					animationActive = false;
-					break;
-			}
-
-			// draw bar
-			leds = CRGB::Black;
-			for (uint8_t i = 0; i < barLength; i++) {
-				leds[Led_Address(i)] = CRGB::Blue;
-			}
-			if (barLength == fullLeds && lastLed > 0) {
-				leds[Led_Address(barLength)] = Led_DimColor(CRGB::Blue, lastLed);
-			}
-			staticLastBarLenghtPlaylist = barLength;
-		}
-	} else {
-		// nothing to show. Just clear indicator
-		LED_INDICATOR_CLEAR(LedIndicatorType::PlaylistProgress);
+	input.overrideColor = true;
+	input.color = Led_GetIdleColor();
+	if (OPMODE_BLUETOOTH_SOURCE == System_GetOperationMode()) {
+		return Led_GetAnimation(LED_TIMELINE_IDLEBTSOURCE);
 	}
-
-	return AnimationReturnType(animationActive, animationDelay, true);
+	return animation;
 }
 
 // --------------------------------
-// BATTERY_MEASUREMENT Animation
+// Busy Animation
 // --------------------------------
-// Single-LED: indicates voltage coloured between gradient green (high) => red (low)
-// Multi-LED: number of LEDs indicates voltage-level with having green >= 60% ; orange < 60% + >= 30% ; red < 30%
-AnimationReturnType Animation_BatteryMeasurement(const bool startNewAnimation, CRGBSet &leds) {
-	// return-values
-	static bool animationActive = false;
-	bool refresh = false;
-	int32_t animationDelay = 0;
-	// static variables for animation
-	static float staticBatteryLevel = 0.0f; // variable to store the measured battery-voltage
-	static uint32_t filledLedCount = 0; // loop variable to animate led-bar
-
-	LED_INDICATOR_CLEAR(LedIndicatorType::Voltage);
-
-	if (startNewAnimation) {
-	#ifdef BATTERY_MEASURE_ENABLE
-		float batteryLevel = Battery_EstimateLevel();
-	#else
-		float batteryLevel = 1.0f;
-	#endif
-		if (batteryLevel < 0.0f) { // If voltage is too low or no battery is connected
-			LED_INDICATOR_SET(LedIndicatorType::Error);
-			return AnimationReturnType(); // abort to indicate error
-		}
-		staticBatteryLevel = batteryLevel;
-		filledLedCount = 0;
-		animationActive = true;
-		leds = CRGB::Black;
-		refresh = true;
-	}
-	if constexpr (NUM_INDICATOR_LEDS == 1) {
-		if (staticBatteryLevel < 0.3) {
-			leds[0] = CRGB::Red;
-		} else if (staticBatteryLevel < 0.6) {
-			leds[0] = CRGB::Orange;
-		} else {
-			leds[0] = CRGB::Green;
-		}
-		refresh = true;
-
-		animationDelay = 20 * 100;
-		animationActive = false;
-	} else {
-		uint8_t numLedsToLight = std::clamp<uint8_t>(staticBatteryLevel * leds.size(), 0, leds.size());
-
-		// fill all needed LEDs
-		if (filledLedCount < numLedsToLight) {
-			if (staticBatteryLevel < 0.3) {
-				leds[Led_Address(filledLedCount)] = CRGB::Red;
-			} else if (staticBatteryLevel < 0.6) {
-				leds[Led_Address(filledLedCount)] = CRGB::Orange;
-			} else {
-				leds[Led_Address(filledLedCount)] = CRGB::Green;
-			}
-			refresh = true;
+static const ledAnimation_t *Led_BindBusy(const ledAnimation_t *animation, const bool startNewAnimation, ledAnimationInput_t &input) {
+	(void) startNewAnimation;
 
-			filledLedCount++;
-			animationDelay = 20;
-		} else { // Wait a little
-			animationDelay = 20 * 100;
-			animationActive = false;
-		}
+	if constexpr (NUM_INDICATOR_LEDS > 1) {
+		input.overrideColor = true;
+		input.color = Led_GetIdleColor();
 	}
-	return AnimationReturnType(animationActive, animationDelay, refresh);
+	return animation;
 }
 #endif
 
@@ -1159,6 +925,31 @@ void Led_TaskPause(void) {
 
 void Led_TaskResume(void) {
 #ifdef NEOPIXEL_ENABLE
+	Led_ShownFrameValid = false; // LEDs were cleared while paused
 	vTaskResume(Led_TaskHandle);
+	Led_Wakeup();
+#endif
+}
+
+// Wakes up LED-task if play-state has changed, so it doesn't have to poll while animation is static
+void Led_Cyclic(void) {
+#ifdef NEOPIXEL_ENABLE
+	static uint32_t lastState = 0;
+	static uint32_t lastPlayerStateGeneration = 0;
+	const uint32_t state = Led_StateFingerprint();
+	const uint32_t playerStateGeneration = AudioPlayer_GetStateGeneration();
+	if (state != lastState || playerStateGeneration != lastPlayerStateGeneration) {
+		lastState = state;
+		lastPlayerStateGeneration = playerStateGeneration;
+		Led_Wakeup();
+	}
 #endif
 }
+
+void Led_ResetStats(void) {
+	gLedStats.framesRendered = 0;
+	gLedStats.framesSkipped = 0;
+	gLedStats.framesDeferred = 0;
+	gLedStats.wakeups = 0;
+	gLedStats.since = millis();
+}
@@ -31,34 +31,20 @@ enum class LedAnimationType {
 	NoNewAnimation
 };
 
-enum class LedPlaylistProgressStates {
-	FillBar = 0,
-	Wait,
-	EmptyBar,
-	EmptyBarToTarget,
-	Done
-};
-
-struct AnimationReturnType {
-	bool animationActive;
-	int32_t animationDelay;
-	bool animationRefresh;
+// LED rendering statistics
+typedef struct {
+	uint32_t framesRendered; // frames sent to the LEDs
+	uint32_t framesSkipped; // frames not sent as they were identical to the one shown
+	uint32_t framesDeferred; // frames delayed by the frame-rate cap of the animation
+	uint32_t wakeups; // LED-task wakeups (timed or notified)
+	uint32_t since; // millis() of last reset
+} ledStats_t;
 
-	void clear() {
-		animationActive = false;
-		animationDelay = 0;
-	}
-	AnimationReturnType()
-		: animationActive(false)
-		, animationDelay(0)
-		, animationRefresh(false) { }
-	AnimationReturnType(bool active, int32_t delay, bool refresh = false)
-		: animationActive(active)
-		, animationDelay(delay)
-		, animationRefresh(refresh) { }
-};
+extern ledStats_t gLedStats;
 
 void Led_Init(void);
+void Led_LoadAnimations(void);
+void Led_Cyclic(void);
 void Led_Exit(void);
 void Led_Indicate(LedIndicatorType value);
 void Led_SetPause(boolean value);
@@ -68,6 +54,7 @@ uint8_t Led_GetBrightness(void);
 void Led_SetBrightness(uint8_t value);
 void Led_TaskPause(void);
 void Led_TaskResume(void);
+void Led_ResetStats(void);
 
 void Led_SetNightmode(bool enabled);
 bool Led_GetNightmode();
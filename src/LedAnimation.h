@@ -0,0 +1,282 @@
+#pragma once
+
+// Keyframe-based LED-animations without dependencies to Arduino/FastLED, so they can be rendered on a host as well
+// (e.g. LedAnimation_WritePpm() to preview an animation without hardware, see test/test_led_animation).
+// An animation is a list of keyframes (time, color, level, position) that are interpolated in fixed-point (Q8)
+// and drawn with a pattern onto the LED-ring. Optionally LEDs are colored by a palette-gradient instead of the keyframe-color.
+// Animations that depend on the device-state (volume, progress, ...) get it by ledAnimationInput_t for every frame.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+constexpr uint8_t ledAnimationMaxKeyframes = 16u;
+constexpr uint8_t ledAnimationMaxPaletteColors = 4u;
+constexpr uint8_t ledAnimationGradientSize = 16u;
+
+enum ledPattern_t : uint8_t {
+	LED_PATTERN_FILL = 0, // all LEDs with brightness "level"
+	LED_PATTERN_BAR, // bar with length "level" (255 = all LEDs), starting at "position"
+	LED_PATTERN_DOTS, // "dots" LEDs, numLeds / dots apart, rotated by "position"
+	LED_PATTERN_WAVE // sine-wave around the ring, rotated by "position" and scaled by "level"
+};
+
+constexpr uint8_t LED_ANIMATION_LOOP = 0x01u; // restart after last keyframe (otherwise animation is finished)
+constexpr uint8_t LED_ANIMATION_STEP = 0x02u; // jump from keyframe to keyframe (no interpolation)
+constexpr uint8_t LED_ANIMATION_MASK = 0x04u; // pattern dims the colors already shown instead of drawing (keyframe-color is ignored)
+
+struct ledRgb_t {
+	uint8_t r;
+	uint8_t g;
+	uint8_t b;
+};
+
+struct ledKeyframe_t {
+	uint16_t time; // ms since start of animation (ascending)
+	ledRgb_t color;
+	uint8_t level; // brightness (fill, dots, wave) or length (bar); 0..255
+	uint8_t position; // rotation of the pattern; 0..255 = full circle (interpolated on the shortest way)
+};
+
+struct ledAnimation_t {
+	uint8_t pattern; // ledPattern_t
+	uint8_t flags; // LED_ANIMATION_*
+	uint8_t dots; // number of dots (LED_PATTERN_DOTS)
+	uint8_t numKeyframes;
+	uint16_t rotateInterval; // pattern moves on by one LED every rotateInterval ms (0: no rotation)
+	ledKeyframe_t keyframes[ledAnimationMaxKeyframes];
+	uint8_t numPaletteColors = 0; // 0: LEDs are colored by keyframe-color
+	ledRgb_t palette[ledAnimationMaxPaletteColors] = {};
+	ledRgb_t gradient[ledAnimationGradientSize] = {}; // lookup-table, calculated from palette by LedAnimation_Prepare()
+};
+
+// Inputs of an animation that are taken from the device-state for every frame (defaults: animation is drawn as defined)
+struct ledAnimationInput_t {
+	uint32_t time = 0; // ms since start of animation
+	uint8_t level = 255; // scales level of keyframes (e.g. length of a bar by volume); 255: unchanged
+	uint8_t position = 0; // added to position of keyframes
+	bool overrideColor = false; // draw with "color" instead of keyframe-color/palette
+	ledRgb_t color = {0, 0, 0};
+};
+
+// sin(x) for a full period in 256 steps, scaled to 0..255
+static const uint8_t LedAnimation_SineTable[256] = {
+	128, 131, 134, 137, 140, 143, 146, 149, 152, 155, 158, 162, 165, 167, 170, 173,
+	176, 179, 182, 185, 188, 190, 193, 196, 198, 201, 203, 206, 208, 211, 213, 215,
+	218, 220, 222, 224, 226, 228, 230, 232, 234, 235, 237, 238, 240, 241, 243, 244,
+	245, 246, 248, 249, 250, 250, 251, 252, 253, 253, 254, 254, 254, 255, 255, 255,
+	255, 255, 255, 255, 254, 254, 254, 253, 253, 252, 251, 250, 250, 249, 248, 246,
+	245, 244, 243, 241, 240, 238, 237, 235, 234, 232, 230, 228, 226, 224, 222, 220,
+	218, 215, 213, 211, 208, 206, 203, 201, 198, 196, 193, 190, 188, 185, 182, 179,
+	176, 173, 170, 167, 165, 162, 158, 155, 152, 149, 146, 143, 140, 137, 134, 131,
+	128, 124, 121, 118, 115, 112, 109, 106, 103, 100, 97, 93, 90, 88, 85, 82,
+	79, 76, 73, 70, 67, 65, 62, 59, 57, 54, 52, 49, 47, 44, 42, 40,
+	37, 35, 33, 31, 29, 27, 25, 23, 21, 20, 18, 17, 15, 14, 12, 11,
+	10, 9, 7, 6, 5, 5, 4, 3, 2, 2, 1, 1, 1, 0, 0, 0,
+	0, 0, 0, 0, 1, 1, 1, 2, 2, 3, 4, 5, 5, 6, 7, 9,
+	10, 11, 12, 14, 15, 17, 18, 20, 21, 23, 25, 27, 29, 31, 33, 35,
+	37, 40, 42, 44, 47, 49, 52, 54, 57, 59, 62, 65, 67, 70, 73, 76,
+	79, 82, 85, 88, 90, 93, 97, 100, 103, 106, 109, 112, 115, 118, 121, 124
+};
+
+// a + (b - a) * f; f in Q8 (0..256)
+constexpr uint8_t LedAnimation_Lerp(const uint8_t a, const uint8_t b, const uint16_t f) {
+	return a + (((int16_t) b - a) * f >> 8);
+}
+
+constexpr ledRgb_t LedAnimation_LerpColor(const ledRgb_t &a, const ledRgb_t &b, const uint16_t f) {
+	return {LedAnimation_Lerp(a.r, b.r, f), LedAnimation_Lerp(a.g, b.g, f), LedAnimation_Lerp(a.b, b.b, f)};
+}
+
+// Full saturated color of a hue (0..255), same sections as FastLED's hsv2rgb_rainbow()
+constexpr ledRgb_t LedAnimation_Hue(const uint8_t hue) {
+	constexpr ledRgb_t sections[9] = {{255, 0, 0}, {171, 85, 0}, {171, 171, 0}, {0, 255, 0}, {0, 171, 85}, {0, 0, 255}, {85, 0, 171}, {171, 0, 85}, {255, 0, 0}};
+	return LedAnimation_LerpColor(sections[hue >> 5], sections[(hue >> 5) + 1], (hue & 0x1F) << 3);
+}
+
+// Position (0..255 = full circle) of the given LED, so that the pattern starts exactly at this LED
+constexpr uint8_t LedAnimation_Position(const uint16_t led, const uint16_t numLeds) {
+	return ((led % numLeds) * 256u + numLeds - 1u) / numLeds;
+}
+
+// Calculates gradient-lookup-table from palette; has to be called after palette was changed
+constexpr void LedAnimation_Prepare(ledAnimation_t &anim) {
+	if (anim.numPaletteColors == 0) {
+		return;
+	}
+	for (uint8_t i = 0; i < ledAnimationGradientSize; i++) {
+		if (anim.numPaletteColors == 1) {
+			anim.gradient[i] = anim.palette[0];
+			continue;
+		}
+		// position in palette in Q8
+		const uint32_t pos = (uint32_t) i * (anim.numPaletteColors - 1u) * 256u / (ledAnimationGradientSize - 1u);
+		const uint8_t idx = pos >> 8;
+		anim.gradient[i] = (idx + 1u < anim.numPaletteColors) ? LedAnimation_LerpColor(anim.palette[idx], anim.palette[idx + 1], pos & 0xFF) : anim.palette[idx];
+	}
+}
+
+// Color of the palette-gradient at pos (0..255), e.g. to color a single LED by a level
+inline ledRgb_t LedAnimation_Gradient(const ledAnimation_t &anim, const uint8_t pos) {
+	return anim.gradient[pos * ledAnimationGradientSize >> 8];
+}
+
+constexpr uint16_t LedAnimation_Duration(const ledAnimation_t &anim) {
+	return anim.numKeyframes ? anim.keyframes[anim.numKeyframes - 1].time : 0u;
+}
+
+inline bool LedAnimation_Finished(const ledAnimation_t &anim, const uint32_t time) {
+	return !(anim.flags & LED_ANIMATION_LOOP) && time >= LedAnimation_Duration(anim);
+}
+
+// Time within the animation (looping animations start over after their last keyframe)
+inline uint32_t LedAnimation_LocalTime(const ledAnimation_t &anim, const uint32_t time) {
+	const uint16_t duration = LedAnimation_Duration(anim);
+	return ((anim.flags & LED_ANIMATION_LOOP) && duration > 0) ? time % duration : time;
+}
+
+// Index of the keyframe that is active at the given (local) time
+inline uint8_t LedAnimation_Keyframe(const ledAnimation_t &anim, const uint32_t time) {
+	uint8_t k = 0;
+	while (k + 1u < anim.numKeyframes && anim.keyframes[k + 1].time <= time) {
+		k++;
+	}
+	return k;
+}
+
+// Interpolated keyframe at given time (ms since start)
+inline ledKeyframe_t LedAnimation_Sample(const ledAnimation_t &anim, uint32_t time) {
+	if (anim.numKeyframes == 0) {
+		return ledKeyframe_t {0, {0, 0, 0}, 0, 0};
+	}
+	time = LedAnimation_LocalTime(anim, time);
+	if (time <= anim.keyframes[0].time) {
+		return anim.keyframes[0];
+	}
+	const uint8_t k = LedAnimation_Keyframe(anim, time);
+	const ledKeyframe_t &k0 = anim.keyframes[k];
+	if (k + 1u >= anim.numKeyframes || (anim.flags & LED_ANIMATION_STEP)) {
+		return k0;
+	}
+	const ledKeyframe_t &k1 = anim.keyframes[k + 1];
+	const uint16_t f = (uint16_t) (((time - k0.time) << 8) / (k1.time - k0.time));
+	ledKeyframe_t frame;
+	frame.time = time;
+	frame.color = LedAnimation_LerpColor(k0.color, k1.color, f);
+	frame.level = LedAnimation_Lerp(k0.level, k1.level, f);
+	frame.position = k0.position + (((int8_t) (k1.position - k0.position)) * (int16_t) f >> 8);
+	return frame;
+}
+
+// Time (in ms) until the frame drawn at the given time changes: 0 if it changes continuously (interpolation),
+// UINT32_MAX if it doesn't change anymore. Lets the caller sleep instead of redrawing identical frames.
+inline uint32_t LedAnimation_NextChange(const ledAnimation_t &anim, const uint32_t time) {
+	if (anim.numKeyframes == 0 || LedAnimation_Finished(anim, time)) {
+		return UINT32_MAX;
+	}
+	const uint32_t localTime = LedAnimation_LocalTime(anim, time);
+	uint32_t next = UINT32_MAX;
+	if (localTime < anim.keyframes[0].time) {
+		next = anim.keyframes[0].time - localTime;
+	} else {
+		const uint8_t k = LedAnimation_Keyframe(anim, localTime);
+		if (k + 1u < anim.numKeyframes) {
+			const ledKeyframe_t &k0 = anim.keyframes[k];
+			const ledKeyframe_t &k1 = anim.keyframes[k + 1];
+			const bool constant = !memcmp(&k0.color, &k1.color, sizeof(ledRgb_t)) && k0.level == k1.level && k0.position == k1.position;
+			if (!constant && !(anim.flags & LED_ANIMATION_STEP)) {
+				return 0u;
+			}
+			next = k1.time - localTime;
+		} else if ((anim.flags & LED_ANIMATION_LOOP) && anim.numKeyframes > 1) {
+			next = LedAnimation_Duration(anim) - localTime; // starts over with first keyframe
+		}
+	}
+	if (anim.rotateInterval) {
+		const uint32_t nextStep = anim.rotateInterval - localTime % anim.rotateInterval;
+		next = (nextStep < next) ? nextStep : next;
+	}
+	return next;
+}
+
+inline void LedAnimation_Scale(ledRgb_t &out, const ledRgb_t &color, const uint8_t intensity) {
+	const uint16_t scale = intensity + 1u;
+	out.r = (color.r * scale) >> 8;
+	out.g = (color.g * scale) >> 8;
+	out.b = (color.b * scale) >> 8;
+}
+
+// Renders the frame into out[0..numLeds-1]. Intensity of every LED is calculated and applied in the same pass (no buffer
+// per LED), as this runs in the LED-task with its small stack. With LED_ANIMATION_MASK out has to contain the frame shown.
+inline void LedAnimation_Render(const ledAnimation_t &anim, const ledAnimationInput_t &input, ledRgb_t *out, const uint8_t numLeds) {
+	if (numLeds == 0) {
+		return;
+	}
+	const uint32_t time = LedAnimation_LocalTime(anim, input.time);
+	ledKeyframe_t frame = LedAnimation_Sample(anim, time);
+	frame.level = (frame.level * (input.level + 1u)) >> 8;
+	if (input.overrideColor) {
+		frame.color = input.color;
+	}
+	const bool mask = anim.flags & LED_ANIMATION_MASK;
+	const bool gradient = anim.numPaletteColors && !input.overrideColor;
+	// first LED of the pattern
+	const uint16_t rotation = anim.rotateInterval ? (time / anim.rotateInterval) % numLeds : 0u;
+	const uint8_t position = frame.position + input.position;
+	const uint16_t start = (((uint16_t) position * numLeds >> 8) + rotation) % numLeds;
+
+	for (uint16_t i = 0; i < numLeds; i++) {
+		const uint16_t idx = (i + numLeds - start) % numLeds; // index relative to the start of the pattern
+		uint8_t intensity;
+		switch (anim.pattern) {
+			case LED_PATTERN_BAR: {
+				const int32_t rest = (int32_t) frame.level * numLeds * 256 / 255 - (idx << 8); // bar-length in 1/256 LEDs beyond this LED
+				intensity = (rest >= 255) ? 255u : ((rest > 0) ? rest : 0u);
+				break;
+			}
+			case LED_PATTERN_DOTS: {
+				const uint8_t dots = anim.dots ? anim.dots : 1u;
+				const uint16_t distance = (numLeds >= dots) ? numLeds / dots : 1u;
+				intensity = (idx % distance == 0 && idx / distance < dots) ? frame.level : 0u;
+				break;
+			}
+			case LED_PATTERN_WAVE:
+				intensity = (LedAnimation_SineTable[(uint8_t) ((idx << 8) / numLeds)] * (frame.level + 1u)) >> 8;
+				break;
+			default: // LED_PATTERN_FILL
+				intensity = frame.level;
+				break;
+		}
+		if (mask) {
+			LedAnimation_Scale(out[i], out[i], intensity);
+		} else {
+			LedAnimation_Scale(out[i], gradient ? anim.gradient[i * ledAnimationGradientSize / numLeds] : frame.color, intensity);
+		}
+	}
+}
+
+inline void LedAnimation_Render(const ledAnimation_t &anim, const uint32_t time, ledRgb_t *out, const uint8_t numLeds) {
+	ledAnimationInput_t input;
+	input.time = time;
+	LedAnimation_Render(anim, input, out, numLeds);
+}
+
+// Writes numFrames frames (one every frameInterval ms) as binary PPM: one row per frame, one pixel per LED
+inline bool LedAnimation_WritePpm(FILE *file, const ledAnimation_t &anim, const ledAnimationInput_t &input, const uint8_t numLeds, const uint16_t frameInterval, const uint16_t numFrames) {
+	ledRgb_t frame[256] = {};
+	if (fprintf(file, "P6\n%u %u\n255\n", numLeds, numFrames) < 0) {
+		return false;
+	}
+	ledAnimationInput_t frameInput = input;
+	for (uint16_t i = 0; i < numFrames; i++) {
+		frameInput.time = input.time + (uint32_t) i * frameInterval;
+		if (anim.flags & LED_ANIMATION_MASK) {
+			memset(frame, 0xFF, sizeof(frame)); // masks are previewed on white
+		}
+		LedAnimation_Render(anim, frameInput, frame, numLeds);
+		if (fwrite(frame, sizeof(ledRgb_t), numLeds, file) != numLeds) {
+			return false;
+		}
+	}
+	return true;
+}
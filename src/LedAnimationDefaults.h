@@ -0,0 +1,166 @@
+#pragma once
+
+// Default keyframe-animations of all LED-indications; each one can be replaced by ledAnimationsFile on SD (key: name of
+// the timeline). Needs NUM_INDICATOR_LEDS, NUM_LEDS_IDLE_DOTS, OFFSET_PAUSE_LEDS, PROGRESS_HUE_START, PROGRESS_HUE_END
+// (settings.h) and intervalToLongPress to be defined before, so it can be included by the host-tests as well.
+// Animations marked with (*) are colored by the device-state (Led.cpp), their keyframe-color is ignored.
+
+#include "LedAnimation.h"
+
+enum ledTimeline_t : uint8_t {
+	LED_TIMELINE_BOOT = 0,
+	LED_TIMELINE_BOOTERROR,
+	LED_TIMELINE_SHUTDOWN,
+	LED_TIMELINE_ERROR,
+	LED_TIMELINE_OK,
+	LED_TIMELINE_VOLTAGEWARNING,
+	LED_TIMELINE_VOLUME,
+	LED_TIMELINE_BATTERY,
+	LED_TIMELINE_REWIND,
+	LED_TIMELINE_PLAYLIST,
+	LED_TIMELINE_SPEECH,
+	LED_TIMELINE_PAUSE,
+	LED_TIMELINE_PROGRESS,
+	LED_TIMELINE_WEBSTREAM,
+	LED_TIMELINE_IDLE,
+	LED_TIMELINE_IDLEBTSOURCE,
+	LED_TIMELINE_BUSY,
+	LED_TIMELINE_COUNT
+};
+
+constexpr const char *LedAnimation_TimelineNames[LED_TIMELINE_COUNT] = {
+	"boot",
+	"bootError",
+	"shutdown",
+	"error",
+	"ok",
+	"voltageWarning",
+	"volume",
+	"battery",
+	"rewind",
+	"playlist",
+	"speech",
+	"pause",
+	"progress",
+	"webstream",
+	"idle",
+	"idleBtSource",
+	"busy",
+};
+
+// same values as the FastLED-colors used before
+constexpr ledRgb_t ledColorBlack = {0, 0, 0};
+constexpr ledRgb_t ledColorRed = {255, 0, 0};
+constexpr ledRgb_t ledColorGreen = {0, 128, 0};
+constexpr ledRgb_t ledColorBlue = {0, 0, 255};
+constexpr ledRgb_t ledColorOrange = {255, 165, 0};
+constexpr ledRgb_t ledColorYellow = {255, 255, 0};
+constexpr ledRgb_t ledColorBlueViolet = {138, 43, 226};
+constexpr ledRgb_t ledColorWhite = {255, 255, 255};
+
+// Pause- & speech-dots are centered between the idle-dots if OFFSET_PAUSE_LEDS is set
+#if OFFSET_PAUSE_LEDS && (NUM_INDICATOR_LEDS >= 2 * NUM_LEDS_IDLE_DOTS)
+constexpr uint8_t ledPausePosition = LedAnimation_Position((NUM_INDICATOR_LEDS / NUM_LEDS_IDLE_DOTS) / 2 - 1, NUM_INDICATOR_LEDS);
+#else
+constexpr uint8_t ledPausePosition = 0;
+#endif
+
+constexpr ledAnimation_t LedAnimation_WithPalette(ledAnimation_t anim, const ledRgb_t c0, const ledRgb_t c1, const ledRgb_t c2, const ledRgb_t c3) {
+	anim.numPaletteColors = 4;
+	anim.palette[0] = c0;
+	anim.palette[1] = c1;
+	anim.palette[2] = c2;
+	anim.palette[3] = c3;
+	LedAnimation_Prepare(anim);
+	return anim;
+}
+
+// Hue-gradient in 4 steps from start to end (hues outside of 0..255 wrap around, see PROGRESS_HUE_START)
+constexpr ledAnimation_t LedAnimation_WithHues(const ledAnimation_t &anim, const int16_t start, const int16_t end) {
+	return LedAnimation_WithPalette(anim, LedAnimation_Hue((uint8_t) start), LedAnimation_Hue((uint8_t) (start + (end - start) / 3)), LedAnimation_Hue((uint8_t) (start + (end - start) * 2 / 3)), LedAnimation_Hue((uint8_t) end));
+}
+
+// Shows color for "on" ms and then blinks every "interval" ms until the last keyframe
+constexpr ledAnimation_t LedAnimation_Blink(const ledRgb_t color, const uint16_t on, const uint16_t interval) {
+	ledAnimation_t anim {};
+	anim.pattern = LED_PATTERN_FILL;
+	anim.flags = LED_ANIMATION_STEP;
+	anim.numKeyframes = ledAnimationMaxKeyframes - 1u; // odd number: ends with color
+	for (uint8_t k = 0; k < anim.numKeyframes; k++) {
+		anim.keyframes[k] = {(uint16_t) (k ? on + (k - 1u) * interval : 0u), (k % 2u) ? ledColorBlack : color, 255, 0};
+	}
+	return anim;
+}
+
+static constexpr ledAnimation_t LedAnimation_Defaults[LED_TIMELINE_COUNT] = {
+#if NUM_INDICATOR_LEDS == 1
+	// boot: blinks orange
+	{LED_PATTERN_FILL, LED_ANIMATION_LOOP | LED_ANIMATION_STEP, 0, 3, 0, {{0, ledColorOrange, 255, 0}, {500, ledColorBlack, 255, 0}, {1000, ledColorBlack, 255, 0}}},
+	// bootError: boot takes longer than 10 s, blinks red
+	{LED_PATTERN_FILL, LED_ANIMATION_LOOP | LED_ANIMATION_STEP, 0, 3, 0, {{0, ledColorRed, 255, 0}, {500, ledColorBlack, 255, 0}, {1000, ledColorBlack, 255, 0}}},
+	// shutdown: red while shutdown-button is pressed, blinks after long-press
+	LedAnimation_Blink(ledColorRed, intervalToLongPress, 50),
+	// error: blinks three times
+	{LED_PATTERN_FILL, LED_ANIMATION_STEP, 0, 7, 0, {{0, ledColorRed, 255, 0}, {100, ledColorBlack, 255, 0}, {200, ledColorRed, 255, 0}, {300, ledColorBlack, 255, 0}, {400, ledColorRed, 255, 0}, {500, ledColorBlack, 255, 0}, {600, ledColorBlack, 255, 0}}},
+	// ok
+	{LED_PATTERN_FILL, LED_ANIMATION_STEP, 0, 7, 0, {{0, ledColorGreen, 255, 0}, {100, ledColorBlack, 255, 0}, {200, ledColorGreen, 255, 0}, {300, ledColorBlack, 255, 0}, {400, ledColorGreen, 255, 0}, {500, ledColorBlack, 255, 0}, {600, ledColorBlack, 255, 0}}},
+#else
+	// boot: every second LED orange, alternating every 500 ms
+	{LED_PATTERN_DOTS, LED_ANIMATION_LOOP, NUM_INDICATOR_LEDS / 2, 2, 500, {{0, ledColorOrange, 255, 0}, {1000, ledColorOrange, 255, 0}}},
+	// bootError: boot takes longer than 10 s, alternating red dots
+	{LED_PATTERN_DOTS, LED_ANIMATION_LOOP, NUM_INDICATOR_LEDS / 2, 2, 500, {{0, ledColorRed, 255, 0}, {1000, ledColorRed, 255, 0}}},
+	// shutdown: red bar filling up until long-press of shutdown-button
+	{LED_PATTERN_BAR, 0, 0, 2, 0, {{0, ledColorRed, 0, 0}, {intervalToLongPress, ledColorRed, 255, 0}}},
+	// error: all LEDs red for a moment
+	{LED_PATTERN_FILL, 0, 0, 2, 0, {{0, ledColorRed, 255, 0}, {200, ledColorRed, 255, 0}}},
+	// ok: all LEDs green for a moment
+	{LED_PATTERN_FILL, 0, 0, 2, 0, {{0, ledColorGreen, 255, 0}, {400, ledColorGreen, 255, 0}}},
+#endif
+	// voltageWarning: flashes red three times
+	{LED_PATTERN_FILL, LED_ANIMATION_STEP, 0, 7, 0, {{0, ledColorRed, 255, 0}, {200, ledColorBlack, 255, 0}, {400, ledColorRed, 255, 0}, {600, ledColorBlack, 255, 0}, {800, ledColorRed, 255, 0}, {1000, ledColorBlack, 255, 0}, {1200, ledColorBlack, 255, 0}}},
+#if NUM_INDICATOR_LEDS == 1
+	// volume: color from green (low) to red (high), shown for 1 s after the last change
+	LedAnimation_WithHues({LED_PATTERN_FILL, 0, 0, 2, 0, {{0, ledColorGreen, 255, 0}, {1000, ledColorGreen, 255, 0}}}, 85, -1),
+	// battery (*): red/orange/green by battery-level for 2 s
+	{LED_PATTERN_FILL, 0, 0, 2, 0, {{0, ledColorGreen, 255, 0}, {2000, ledColorGreen, 255, 0}}},
+#else
+	// volume: bar with gradient from green to red, shown for 1 s after the last change
+	LedAnimation_WithHues({LED_PATTERN_BAR, 0, 0, 2, 0, {{0, ledColorGreen, 255, 0}, {1000, ledColorGreen, 255, 0}}}, 85, -1),
+	// battery (*): bar of the battery-level (one LED every 20 ms), shown for 2 s
+	{LED_PATTERN_BAR, 0, 0, 3, 0, {{0, ledColorGreen, 0, 0}, {NUM_INDICATOR_LEDS * 20, ledColorGreen, 255, 0}, {NUM_INDICATOR_LEDS * 20 + 2000, ledColorGreen, 255, 0}}},
+#endif
+#if NUM_INDICATOR_LEDS >= 4
+	// rewind: LEDs shown before are turned off from the end (one LED every 30 ms)
+	{LED_PATTERN_BAR, LED_ANIMATION_MASK, 0, 2, 0, {{0, ledColorBlack, 255, 0}, {NUM_INDICATOR_LEDS * 30, ledColorBlack, 0, 0}}},
+	// playlist: blue bar up to the current track (one LED every 30 ms), held for 1.5 s and emptied again
+	{LED_PATTERN_BAR, 0, 0, 4, 0, {{0, ledColorBlue, 0, 0}, {NUM_INDICATOR_LEDS * 30, ledColorBlue, 255, 0}, {NUM_INDICATOR_LEDS * 30 + 1500, ledColorBlue, 255, 0}, {NUM_INDICATOR_LEDS * 60 + 1500, ledColorBlue, 0, 0}}},
+#else
+	// rewind & playlist: not shown with less than 4 LEDs
+	{LED_PATTERN_FILL, LED_ANIMATION_MASK, 0, 1, 0, {{0, ledColorBlack, 255, 0}}},
+	{LED_PATTERN_FILL, LED_ANIMATION_MASK, 0, 1, 0, {{0, ledColorBlack, 255, 0}}},
+#endif
+	// speech: yellow pause-dots
+	{LED_PATTERN_DOTS, LED_ANIMATION_LOOP, NUM_LEDS_IDLE_DOTS, 1, 0, {{0, ledColorYellow, 255, ledPausePosition}}},
+	// pause (*): orange dots (blue in BT-source mode)
+	{LED_PATTERN_DOTS, LED_ANIMATION_LOOP, NUM_LEDS_IDLE_DOTS, 1, 0, {{0, ledColorOrange, 255, ledPausePosition}}},
+#if NUM_INDICATOR_LEDS == 1
+	// progress: color from green to purple by position in track
+	LedAnimation_WithHues({LED_PATTERN_FILL, LED_ANIMATION_LOOP, 0, 1, 0, {{0, ledColorGreen, 255, 0}}}, 85, -5),
+#else
+	// progress: bar of the position in track with gradient from PROGRESS_HUE_START to PROGRESS_HUE_END (red if controls are locked)
+	LedAnimation_WithHues({LED_PATTERN_BAR, LED_ANIMATION_LOOP, 0, 1, 0, {{0, ledColorGreen, 255, 0}}}, PROGRESS_HUE_START, PROGRESS_HUE_END),
+#endif
+	// webstream (*): two opposite dots moving on by one LED (and changing their hue) every 4.5 s
+	{LED_PATTERN_DOTS, LED_ANIMATION_LOOP, 2, 2, 0, {{0, ledColorWhite, 255, 0}, {4500, ledColorWhite, 255, 0}}},
+	// idle (*): rotating idle-dots, one LED every 500 ms
+	{LED_PATTERN_DOTS, LED_ANIMATION_LOOP, NUM_LEDS_IDLE_DOTS, 1, 500, {{0, ledColorWhite, 255, 0}}},
+	// idleBtSource (*): a bit faster in BT-source mode to distinguish between the bluetooth modes
+	{LED_PATTERN_DOTS, LED_ANIMATION_LOOP, NUM_LEDS_IDLE_DOTS, 1, 300, {{0, ledColorWhite, 255, 0}}},
+#if NUM_INDICATOR_LEDS == 1
+	// busy: blinks blue-violet
+	{LED_PATTERN_FILL, LED_ANIMATION_LOOP | LED_ANIMATION_STEP, 0, 3, 0, {{0, ledColorBlueViolet, 255, 0}, {100, ledColorBlack, 255, 0}, {200, ledColorBlack, 255, 0}}},
+#else
+	// busy (*): fast rotating idle-dots
+	{LED_PATTERN_DOTS, LED_ANIMATION_LOOP, NUM_LEDS_IDLE_DOTS, 1, 50, {{0, ledColorWhite, 255, 0}}},
+#endif
+};
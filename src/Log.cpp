@@ -3,14 +3,25 @@
 
 #include "Log.h"
 
-#include "LogRingBuffer.h"
 #include "MemX.h"
 
-static LogRingBuffer *Log_RingBuffer = NULL;
+#ifndef LOG_BUFFER_SIZE
+	#define LOG_BUFFER_SIZE 5120
+#endif
+
+// Ring buffer for the log. Every byte written gets an absolute position (cursor) that only grows;
+// the ring keeps the last LOG_BUFFER_SIZE bytes. Clients remember the cursor they've read up to
+// and can ask for newer data only (no need to copy the whole buffer each time).
+static char *Log_RingBuffer = NULL;
+static uint32_t Log_RingBufferHead = 0; // cursor behind the latest byte written
+static uint32_t Log_RingBufferTail = 0; // cursor of the oldest complete line still available
+static portMUX_TYPE Log_RingBufferMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void Log_RingBufferWrite(const char *_str, size_t _len);
 
 void Log_Init(void) {
 	Serial.begin(115200);
-	Log_RingBuffer = new LogRingBuffer();
+	Log_RingBuffer = x_calloc(LOG_BUFFER_SIZE, sizeof(char));
 }
 
 String getLoglevel(const uint8_t logLevel) {
@@ -28,6 +39,14 @@ String getLoglevel(const uint8_t logLevel) {
 	}
 }
 
+// Writes the loglevel + timestamp prefix to serial and ring buffer
+static void Log_PrintPrefix(const uint8_t _minLogLevel) {
+	char prefix[20];
+	const int len = snprintf(prefix, sizeof(prefix), "%s [%lu] ", getLoglevel(_minLogLevel).c_str(), millis());
+	Serial.print(prefix);
+	Log_RingBufferWrite(prefix, std::min<size_t>(len, sizeof(prefix) - 1));
+}
+
 /* Wrapper-function for serial-logging (with newline)
    _logBuffer: char* to log
    _minLogLevel: loglevel configured for this message.
@@ -35,12 +54,10 @@ String getLoglevel(const uint8_t logLevel) {
 */
 void Log_Println(const char *_logBuffer, const uint8_t _minLogLevel) {
 	if (SERIAL_LOGLEVEL >= _minLogLevel) {
-		uint32_t ctime = millis();
-		const String sLogLevel = getLoglevel(_minLogLevel);
-		Serial.printf("%s [%u] ", sLogLevel.c_str(), ctime);
+		Log_PrintPrefix(_minLogLevel);
 		Serial.println(_logBuffer);
-		Log_RingBuffer->printf("%s [%u] ", sLogLevel.c_str(), ctime);
-		Log_RingBuffer->println(_logBuffer);
+		Log_RingBufferWrite(_logBuffer, strlen(_logBuffer));
+		Log_RingBufferWrite("\r\n", 2);
 	}
 }
 
@@ -48,15 +65,10 @@ void Log_Println(const char *_logBuffer, const uint8_t _minLogLevel) {
 void Log_Print(const char *_logBuffer, const uint8_t _minLogLevel, bool printTimestamp) {
 	if (SERIAL_LOGLEVEL >= _minLogLevel) {
 		if (printTimestamp) {
-			uint32_t ctime = millis();
-			const String sLogLevel = getLoglevel(_minLogLevel);
-			Serial.printf("%s [%u] ", sLogLevel.c_str(), ctime);
-			Serial.print(_logBuffer);
-			Log_RingBuffer->printf("%s [%u] ", sLogLevel.c_str(), ctime);
-		} else {
-			Serial.print(_logBuffer);
+			Log_PrintPrefix(_minLogLevel);
 		}
-		Log_RingBuffer->print(_logBuffer);
+		Serial.print(_logBuffer);
+		Log_RingBufferWrite(_logBuffer, strlen(_logBuffer));
 	}
 }
 
@@ -82,6 +94,65 @@ int Log_Printf(const uint8_t _minLogLevel, const char *format, ...) {
 	return std::min<int>(len, sizeof(loc_buf) - 1);
 }
 
-String Log_GetRingBuffer(void) {
-	return Log_RingBuffer->get();
+// Appends data to the ring buffer. If old data is overwritten, the tail is moved to the next line-start
+// so readers never start in the middle of a line.
+static void Log_RingBufferWrite(const char *_str, size_t _len) {
+	if (Log_RingBuffer == NULL || _len == 0) {
+		return;
+	}
+	if (_len > LOG_BUFFER_SIZE) {
+		_str += _len - LOG_BUFFER_SIZE;
+		_len = LOG_BUFFER_SIZE;
+	}
+
+	portENTER_CRITICAL(&Log_RingBufferMux);
+	const size_t offset = Log_RingBufferHead % LOG_BUFFER_SIZE;
+	const size_t firstPart = std::min<size_t>(_len, LOG_BUFFER_SIZE - offset);
+	memcpy(Log_RingBuffer + offset, _str, firstPart);
+	memcpy(Log_RingBuffer, _str + firstPart, _len - firstPart);
+	Log_RingBufferHead += _len;
+
+	if (Log_RingBufferHead - Log_RingBufferTail > LOG_BUFFER_SIZE) {
+		// oldest line was (partly) overwritten => skip to the beginning of the next one
+		uint32_t pos = Log_RingBufferHead - LOG_BUFFER_SIZE;
+		while (pos != Log_RingBufferHead && Log_RingBuffer[(pos - 1) % LOG_BUFFER_SIZE] != '\n') {
+			pos++;
+		}
+		Log_RingBufferTail = pos;
+	}
+	portEXIT_CRITICAL(&Log_RingBufferMux);
+}
+
+uint32_t Log_GetRingBufferHead(void) {
+	return Log_RingBufferHead;
+}
+
+uint32_t Log_GetRingBufferTail(void) {
+	return Log_RingBufferTail;
+}
+
+// Copies up to _maxLen bytes beginning at cursor _pos into _dst.
+// Returns the number of bytes copied; 0 if there's nothing (left) to read or _pos was already overwritten.
+size_t Log_ReadRingBuffer(uint32_t _pos, uint8_t *_dst, size_t _maxLen) {
+	static constexpr size_t maxBytesPerLock = 512u; // keep time spent in critical section short
+	size_t len = 0;
+
+	while (len < _maxLen) {
+		size_t copied = 0;
+		portENTER_CRITICAL(&Log_RingBufferMux);
+		if (Log_RingBuffer != NULL && (int32_t) (_pos - Log_RingBufferTail) >= 0 && (int32_t) (Log_RingBufferHead - _pos) > 0) {
+			const size_t offset = _pos % LOG_BUFFER_SIZE;
+			copied = std::min<size_t>({_maxLen - len, Log_RingBufferHead - _pos, LOG_BUFFER_SIZE - offset, maxBytesPerLock});
+			memcpy(_dst + len, Log_RingBuffer + offset, copied);
+		}
+		portEXIT_CRITICAL(&Log_RingBufferMux);
+
+		if (copied == 0) {
+			break;
+		}
+		len += copied;
+		_pos += copied;
+	}
+
+	return len;
 }
@@ -21,4 +21,11 @@ void Log_Print(const char *_logBuffer, const uint8_t _minLogLevel, bool printTim
 int Log_Printf(const uint8_t _minLogLevel, const char *format, ...);
 
 void Log_Init(void);
-String Log_GetRingBuffer(void);
+
+/* Log ring buffer access via cursors (absolute byte positions that only grow).
+   Head: cursor behind the latest byte written
+   Tail: cursor of the oldest complete line that's still available
+*/
+uint32_t Log_GetRingBufferHead(void);
+uint32_t Log_GetRingBufferTail(void);
+size_t Log_ReadRingBuffer(uint32_t _pos, uint8_t *_dst, size_t _maxLen);
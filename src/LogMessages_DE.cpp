@@ -55,6 +55,9 @@ const char rfidScannerReady[] = "RFID-Tags koennen jetzt gescannt werden...";
 const char rfidTagDetected[] = "RFID-Karte erkannt: %s";
 const char rfid15693TagDetected[] = "RFID-Karte (ISO-15693) erkannt: ";
 const char rfidTagReceived[] = "RFID-Karte empfangen";
+const char rfidGestureDetected[] = "RFID-Geste erkannt: %s";
+const char rfidGestureNotAssigned[] = "RFID-Geste %s ist nicht zugewiesen";
+const char rfidGesturesLoaded[] = "%u RFID-Gesten zugewiesen";
 const char dontAccepctSameRfid[] = "Aktuelle RFID-Karte erneut aufgelegt - abgelehnt! (%s)";
 const char rfidTagUnknownInNvs[] = "RFID-Karte ist im NVS nicht hinterlegt.";
 const char goToSleepDueToIdle[] = "Gehe in Deep Sleep wegen Inaktivität...";
@@ -113,6 +116,7 @@ const char unableToMountSd[] = "SD-Karte konnte nicht gemountet werden.";
 const char unableToCreateVolQ[] = "Konnte Volume-Queue nicht anlegen.";
 const char unableToCreateRfidQ[] = "Konnte RFID-Queue nicht anlegen.";
 const char unableToCreateButtonQ[] = "Konnte Button-Queue nicht anlegen.";
+const char unableToCreateIdQSet[] = "Konnte Queue-Set für RFID- und Button-Queue nicht anlegen.";
 const char unableToCreateMgmtQ[] = "Konnte Play-Management-Queue nicht anlegen.";
 const char unableToCreatePlayQ[] = "Konnte Track-Queue nicht anlegen..";
 const char initialBrightnessfromNvs[] = "Initiale LED-Helligkeit wurde aus NVS geladen: %u";
@@ -149,7 +153,12 @@ const char mqttWithoutPwd[] = "Verbinde zu MQTT-Server ohne User und Passwort";
 const char ssidNotFoundInNvs[] = "SSID wurde im NVS nicht gefunden.";
 const char wifiStaticIpConfigNotFoundInNvs[] = "Statische WLAN-IP-Konfiguration wurde im NVS nicht gefunden.";
 const char wifiHostnameNotSet[] = "Keine Hostname-Konfiguration im NVS gefunden.";
-const char mqttConnFailed[] = "Verbindung fehlgeschlagen, versuche in Kürze erneut: rc=%i (%d / %d)";
+const char mqttConnFailed[] = "Verbindung fehlgeschlagen: rc=%i, versuche erneut in %u ms";
+const char mqttConnLost[] = "Verbindung zum MQTT-Server verloren";
+const char mqttDiscoveryPublished[] = "Home Assistant MQTT-Discovery veröffentlicht (%u Entitäten)";
+const char mqttBatchInvalid[] = "Ungültiges MQTT Batch-Kommando, nichts ausgeführt (%s)";
+const char mqttTopicUnknown[] = "MQTT-Topic %s ist nicht in der Topic-Tabelle, Nachricht wird verworfen";
+const char mqttShutdownTimeout[] = "MQTT-Task reagiert nicht (Verbindungsaufbau läuft?), Beenden übersprungen";
 const char restoredHostnameFromNvs[] = "Hostname aus NVS geladen: %s";
 const char currentBattVoltageMsg[] = "Aktuelle Batteriespannung: %.2f V";
 const char currentSysVoltageMsg[] = "Aktuelle Systempannung: %.2f V";
@@ -193,6 +202,8 @@ const char tryStaticIpConfig[] = "Statische IP-Konfiguration wird durchgeführt.
 const char staticIPConfigFailed[] = "Statische IP-Konfiguration fehlgeschlagen";
 const char wakeUpRfidNoCard[] = "ESP32 wurde vom Kartenleser aus dem Deepsleep aufgeweckt. Allerdings wurde keine Karte gefunden. Gehe zurück in den Deepsleep...";
 const char lowPowerCardSuccess[] = "Kartenerkennung via 'low power' erfolgreich durchgeführt";
+const char rfidLpcdIdle[] = "Länger keine RFID-Karte, warte auf Kartenerkennung via 'low power'";
+const char rfidLpcdWakeup[] = "Kartenerkennung via 'low power': HF-Feld hat sich verändert, suche RFID-Karte";
 const char rememberLastVolume[] = "Lautstärke vor dem letzten Shutdown wird wiederhergestellt. Dies überschreibt die Einstellung der initialen Lautstärke aus der GUI.";
 const char unableToStartFtpServer[] = "Der FTP-Server konnte nicht gestartet werden. Entweder weil er ist bereits gestartet oder kein WLAN verfügbar ist.";
 const char unableToTellIpAddress[] = "IP-Adresse kann nicht angesagt werden, da keine WLAN-Verbindung besteht.";
@@ -239,7 +250,23 @@ const char wroteLastTrackToNvs[] = "Schreibe '%s' in NVS für RFID-Card-ID %s mi
 const char wifiConnectionInProgress[] = "Versuche mit WLAN '%s' zu verbinden...";
 const char wifiConnectionSuccess[] = "Verbunden mit WLAN '%s' (Signalstärke: %d dBm, Kanal: %d, MAC-Adresse: %s)";
 const char wifiCurrentIp[] = "Aktuelle IP: %s";
+const char wifiFastConnect[] = "Schnellverbindung mit WLAN '%s' ohne Suche (Kanal: %u%s)";
+const char wifiBootToIp[] = "IP-Adresse %u ms nach Start (Verbindungsaufbau dauerte %u ms)";
+const char bootStepTime[] = "Boot-Schritt %s: gestartet bei %u ms, dauerte %u ms%s";
+const char bootReadyTime[] = "Start abgeschlossen nach %u ms";
+const char errorWritingFile[] = "Beim Schreiben der Datei %s ist ein Fehler aufgetreten";
+const char playlistResumeSaved[] = "Playlist für Fortsetzen nach Deepsleep gespeichert (Track %u von %u an Position %u)";
+const char playlistResumed[] = "Playlist nach Deepsleep ohne Durchsuchen der SD fortgesetzt (Track %u von %u an Position %u)";
+const char playlistResumeInvalid[] = "Gespeicherte Playlist ist veraltet, Playlist wird neu erstellt";
+const char modeSwitchStarted[] = "Wechsle Betriebsmodus %u => %u";
+const char modeSwitchDone[] = "Betriebsmodus %u aktiv nach %u ms";
+const char modeSwitchHeap[] = "Freier Heap nach Beenden: %u Bytes (Basis: %u, Differenz: %d), nach Starten: %u Bytes (nach Start des Geräts: %u Bytes in Modus %u)";
+const char modeSwitchAborted[] = "Wechsel des Betriebsmodus abgebrochen, aktueller Modus bleibt aktiv";
+const char audioTaskStopTimeoutMsg[] = "Audio-Task kann nicht beendet werden (beschäftigt)";
+const char btClassicMemoryKept[] = "Speicher für klassisches BT bleibt für Wechsel des Betriebsmodus reserviert, freier Heap: %u Bytes";
 const char jsonErrorMsg[] = "deserializeJson() fehlgeschlagen: %s";
+const char ledAnimationLoaded[] = "LED-Animation \"%s\" von SD geladen";
+const char ledAnimationInvalid[] = "LED-Animation \"%s\" auf SD ist ungültig";
 const char jsonbufferOverflow[] = "JSON-Puffer zu klein für Daten";
 const char wifiDeleteNetwork[] = "Lösche gespeichertes WLAN %s";
 const char wifiNetworkLoaded[] = "SSID %d von NVS geladen: %s";
@@ -55,6 +55,9 @@ const char rfidScannerReady[] = "RFID-tags can now be applied...";
 const char rfidTagDetected[] = "RFID-tag detected: %s";
 const char rfid15693TagDetected[] = "RFID-ta (ISO-15693) detected: ";
 const char rfidTagReceived[] = "RFID-tag received";
+const char rfidGestureDetected[] = "RFID-gesture detected: %s";
+const char rfidGestureNotAssigned[] = "RFID-gesture %s is not assigned";
+const char rfidGesturesLoaded[] = "%u RFID-gestures assigned";
 const char dontAccepctSameRfid[] = "Reapplied same rfid-tag - rejected! (%s)";
 const char rfidTagUnknownInNvs[] = "RFID-tag is unkown to NVS.";
 const char goToSleepDueToIdle[] = "Going to deepsleep due to inactivity-timer...";
@@ -114,6 +117,7 @@ const char unableToMountSd[] = "Unable to mount sd-card.";
 const char unableToCreateVolQ[] = "Unable to create volume-queue.";
 const char unableToCreateRfidQ[] = "Unable to create RFID-queue.";
 const char unableToCreateButtonQ[] = "Unable to create button-queue.";
+const char unableToCreateIdQSet[] = "Unable to create queue-set for RFID- and button-queue.";
 const char unableToCreateMgmtQ[] = "Unable to play-management-queue.";
 const char unableToCreatePlayQ[] = "Unable to create track-queue..";
 const char initialBrightnessfromNvs[] = "Restoring initial LED-brightness from NVS: %u";
@@ -150,7 +154,12 @@ const char mqttWithoutPwd[] = "Try to connect to MQTT-server without user und pa
 const char ssidNotFoundInNvs[] = "Unable to find SSID to NVS.";
 const char wifiStaticIpConfigNotFoundInNvs[] = "Unable to find wifi-ip-configuration to NVS.";
 const char wifiHostnameNotSet[] = "Unable to find hostname-configuration to NVS.";
-const char mqttConnFailed[] = "Unable to establish mqtt-connection, trying again: rc=%i (%d / %d)";
+const char mqttConnFailed[] = "Unable to establish mqtt-connection: rc=%i, trying again in %u ms";
+const char mqttConnLost[] = "Connection to MQTT-server lost";
+const char mqttDiscoveryPublished[] = "Home Assistant MQTT-discovery published (%u entities)";
+const char mqttBatchInvalid[] = "Invalid MQTT batch-command, nothing executed (%s)";
+const char mqttTopicUnknown[] = "MQTT-topic %s isn't in the topic-table, message is dropped";
+const char mqttShutdownTimeout[] = "MQTT-task doesn't respond (connection attempt in progress?), shutdown skipped";
 const char restoredHostnameFromNvs[] = "Restored hostname from NVS: %s";
 const char currentBattVoltageMsg[] = "Current battery-voltage: %.2f V";
 const char currentSysVoltageMsg[] = "Current system-voltage: %.2f V";
@@ -194,6 +203,8 @@ const char tryStaticIpConfig[] = "Performing IP-configuration...";
 const char staticIPConfigFailed[] = "IP-configuration failed";
 const char wakeUpRfidNoCard[] = "Wakeup caused by low power card-detection. RF-field changed but no card on reader was found. So I'll return back to sleep now...";
 const char lowPowerCardSuccess[] = "Switch to low power card-detection: success";
+const char rfidLpcdIdle[] = "No RFID-tag for a while, waiting for low power card-detection";
+const char rfidLpcdWakeup[] = "Low power card-detection: RF-field changed, scanning for RFID-tag";
 const char rememberLastVolume[] = "Restored volume used before last shutdown. This overwrites the initial volume configured via webgui.";
 const char unableToStartFtpServer[] = "FTP-server cannot be started. This is because FTP-service is already active or because WiFi is unavailable.";
 const char unableToTellIpAddress[] = "IP-address can't be announced as there's no WiFi-connection available.";
@@ -240,7 +251,23 @@ const char wroteLastTrackToNvs[] = "Write '%s' to NVS for RFID-Card-ID %s with p
 const char wifiConnectionInProgress[] = "Try to connect to WiFi with SSID '%s'...";
 const char wifiConnectionSuccess[] = "Connected with WiFi '%s' (signal strength: %d dBm, channel: %d, BSSID: %s)";
 const char wifiCurrentIp[] = "Current IP: %s";
+const char wifiFastConnect[] = "Fast connect to WiFi '%s' without scan (channel: %u%s)";
+const char wifiBootToIp[] = "IP-address %u ms after boot (connecting took %u ms)";
+const char bootStepTime[] = "Boot-step %s: started at %u ms, took %u ms%s";
+const char bootReadyTime[] = "Boot completed after %u ms";
+const char errorWritingFile[] = "Error occured while writing file %s";
+const char playlistResumeSaved[] = "Playlist saved for resume after deep-sleep (track %u of %u at position %u)";
+const char playlistResumed[] = "Playlist resumed after deep-sleep without scanning SD (track %u of %u at position %u)";
+const char playlistResumeInvalid[] = "Saved playlist is outdated, playlist is created again";
+const char modeSwitchStarted[] = "Switching operation-mode %u => %u";
+const char modeSwitchDone[] = "Operation-mode %u active after %u ms";
+const char modeSwitchHeap[] = "Free heap after tear-down: %u bytes (baseline: %u, delta: %d), after bring-up: %u bytes (after boot: %u bytes in mode %u)";
+const char modeSwitchAborted[] = "Switch of operation-mode aborted, current mode is kept";
+const char audioTaskStopTimeoutMsg[] = "Audio-task can't be stopped (busy)";
+const char btClassicMemoryKept[] = "Memory of classic BT is kept for switch of operation-mode, free heap: %u bytes";
 const char jsonErrorMsg[] = "deserializeJson() failed: %s";
+const char ledAnimationLoaded[] = "LED-animation \"%s\" loaded from SD";
+const char ledAnimationInvalid[] = "LED-animation \"%s\" on SD is invalid";
 const char jsonbufferOverflow[] = "JSON buffer too small for data";
 const char wifiDeleteNetwork[] = "Deleting saved WiFi %s";
 const char wifiNetworkLoaded[] = "Loaded SSID %d from NVS: %s";
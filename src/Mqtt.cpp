@@ -3,11 +3,13 @@
 
 #include "Mqtt.h"
 
+#include "ArduinoJson.h"
 #include "AudioPlayer.h"
 #include "Led.h"
 #include "Log.h"
 #include "MemX.h"
 #include "Queues.h"
+#include "Rfid.h"
 #include "System.h"
 #include "Wlan.h"
 #include "revision.h"
@@ -33,11 +35,76 @@ uint16_t gMqttPort = 1883; // MQTT-Port
 
 // MQTT
 static bool Mqtt_Enabled = true;
+mqttStats_t gMqttStats;
 
 #ifdef MQTT_ENABLE
+// Outbound messages: one slot per topic, a new value replaces a not yet sent one.
+// Only Mqtt_Task talks to the broker, so publishing never blocks the caller (e.g. the audio-task) on TCP.
+typedef struct {
+	const char *topic;
+	char payload[mqttPayloadLength];
+	bool retained;
+	bool dirty; // not yet sent
+} mqttSlot_t;
+
+// Topics that are published; the table gets one slot per topic and isn't changed after Mqtt_Init(), so it's searched without lock
+static const char *const Mqtt_OutboundTopics[] = {
+	topicState,
+	topicCurrentIPv4IP,
+	topicSRevisionState,
+	topicWiFiRssiState,
+	topicSleepState,
+	topicSleepTimerState,
+	topicLockControlsState,
+	topicLoudnessState,
+	topicPlaymodeState,
+	topicRepeatModeState,
+	topicTrackState,
+	topicCoverChangedState,
+	topicLedBrightnessState,
+	topicRfidState,
+	topicAudioStatsState,
+	topicRfidStatsState,
+	#ifdef BATTERY_MEASURE_ENABLE
+	topicBatteryVoltage,
+	topicBatterySOC,
+	#endif
+};
+static constexpr uint8_t Mqtt_NumSlots = sizeof(Mqtt_OutboundTopics) / sizeof(Mqtt_OutboundTopics[0]);
+
+static mqttSlot_t *Mqtt_Slots = NULL;
+static portMUX_TYPE Mqtt_SlotsMux = portMUX_INITIALIZER_UNLOCKED; // payload, retained & dirty of the slots
+static TaskHandle_t Mqtt_TaskHandle = NULL;
+static volatile bool Mqtt_ShutdownRequested = false;
+static volatile bool Mqtt_ShutdownDone = false;
+static constexpr uint32_t Mqtt_LoopInterval = 50u; // ms; MQTT-task polls for incoming messages and keep-alive at least this often
+
+// Connection state machine (see Mqtt_Reconnect())
+enum class MqttConnState : uint8_t {
+	Offline = 0, // no WiFi
+	Connecting, // next attempt at Mqtt_NextAttempt
+	Online
+};
+static MqttConnState Mqtt_ConnState = MqttConnState::Offline;
+static uint32_t Mqtt_Backoff = 0u; // ms; 0: no attempt failed so far
+static uint32_t Mqtt_NextAttempt = 0u; // millis()
+static constexpr uint32_t Mqtt_BackoffMin = 1000u; // ms; back-off after first failed attempt
+
+// Discovery-documents are retained by the broker, so they're only sent if revision or configuration changed. Hash of the
+// last ones sent is kept in NVS, so neither a reboot nor a wake-up from deep-sleep sends them again. Home Assistant
+// announcing a restart sends them anyway, as the broker might have lost them.
+static uint32_t Mqtt_DiscoverySentHash = 0u; // restored from NVS by Mqtt_Init()
+static char Mqtt_DiscoveryStatusTopic[64] = ""; // <prefix>/status: birth-message of Home Assistant
+static volatile bool Mqtt_DiscoveryRequested = false; // birth-message received: send even if hash didn't change
+
 static void Mqtt_ClientCallback(const char *topic, const byte *payload, uint32_t length);
-static bool Mqtt_Reconnect(void);
+static bool Mqtt_Connect(void);
+static void Mqtt_Reconnect(void);
 static void Mqtt_PostWiFiRssi(void);
+static void Mqtt_Task(void *parameter);
+static void Mqtt_PublishDiscovery(const bool force);
+static void Mqtt_CommandTablesBuild(void);
+static void Mqtt_Subscribe(void);
 #endif
 
 void Mqtt_Init() {
@@ -108,10 +175,29 @@ void Mqtt_Init() {
 		Log_Printf(LOGLEVEL_INFO, restoredMqttPortFromNvs, gMqttPort);
 	}
 
+	Mqtt_DiscoverySentHash = gPrefsSettings.getULong("mqttDiscHash", 0u);
+
 	// Only enable MQTT if requested
 	if (Mqtt_Enabled) {
 		Mqtt_PubSubClient.setServer(gMqttServer.c_str(), gMqttPort);
 		Mqtt_PubSubClient.setCallback(Mqtt_ClientCallback);
+		Mqtt_CommandTablesBuild();
+
+		Mqtt_ResetStats();
+		mqttSlot_t *slots = (mqttSlot_t *) x_calloc(Mqtt_NumSlots, sizeof(mqttSlot_t));
+		for (uint8_t i = 0u; slots != NULL && i < Mqtt_NumSlots; i++) {
+			slots[i].topic = Mqtt_OutboundTopics[i];
+		}
+		Mqtt_Slots = slots;
+		xTaskCreatePinnedToCore(
+			Mqtt_Task, /* Function to implement the task */
+			"mqtt", /* Name of the task */
+			4096, /* Stack size in words */
+			NULL, /* Task input parameter */
+			1, /* Priority of the task */
+			&Mqtt_TaskHandle, /* Task handle. */
+			1 /* Core where the task should run */
+		);
 	}
 #else
 	Mqtt_Enabled = false;
@@ -121,8 +207,6 @@ void Mqtt_Init() {
 void Mqtt_Cyclic(void) {
 #ifdef MQTT_ENABLE
 	if (Mqtt_Enabled && Wlan_IsConnected()) {
-		Mqtt_Reconnect();
-		Mqtt_PubSubClient.loop();
 		Mqtt_PostWiFiRssi();
 	}
 #endif
@@ -131,9 +215,27 @@ void Mqtt_Cyclic(void) {
 void Mqtt_Exit(void) {
 #ifdef MQTT_ENABLE
 	Log_Println("shutdown MQTT..", LOGLEVEL_NOTICE);
-	publishMqtt(topicState, "Offline", false);
-	publishMqtt(topicTrackState, "---", false);
-	Mqtt_PubSubClient.disconnect();
+	if (!Mqtt_TaskHandle) {
+		return;
+	}
+	if (Mqtt_ConnState == MqttConnState::Online) {
+		publishMqtt(topicState, "Offline", true);
+		publishMqtt(topicTrackState, "---", false);
+	}
+
+	// MQTT-task sends the pending messages and disconnects (wait max. 1s)
+	Mqtt_ShutdownRequested = true;
+	xTaskNotifyGive(Mqtt_TaskHandle);
+	for (uint8_t i = 0u; i < 100u && !Mqtt_ShutdownDone; i++) {
+		vTaskDelay(portTICK_PERIOD_MS * 10u);
+	}
+	// task might be blocked in connect() (TCP-timeout): deleting it within a lwIP-call isn't safe, so it's left alone
+	if (!Mqtt_ShutdownDone) {
+		Log_Println(mqttShutdownTimeout, LOGLEVEL_ERROR);
+		return;
+	}
+	vTaskDelete(Mqtt_TaskHandle);
+	Mqtt_TaskHandle = NULL;
 #endif
 }
 
@@ -141,19 +243,55 @@ bool Mqtt_IsEnabled(void) {
 	return Mqtt_Enabled;
 }
 
+void Mqtt_ResetStats(void) {
+	gMqttStats.published = 0;
+	gMqttStats.coalesced = 0;
+	gMqttStats.failed = 0;
+	gMqttStats.dropped = 0;
+	gMqttStats.connects = 0;
+	gMqttStats.connectFailures = 0;
+	gMqttStats.connectTimeHist.reset();
+	gMqttStats.since = millis();
+}
+
 /* Wrapper-functions for MQTT-publish */
 bool publishMqtt(const char *topic, const char *payload, bool retained) {
 #ifdef MQTT_ENABLE
-	if (strcmp(topic, "") != 0) {
-		if (Mqtt_PubSubClient.connected()) {
-			Mqtt_PubSubClient.publish(topic, payload, retained);
-			// delay(100);
-			return true;
+	if (Mqtt_Slots == NULL || strcmp(topic, "") == 0) {
+		return false;
+	}
+
+	mqttSlot_t *slot = NULL;
+	for (uint8_t i = 0u; i < Mqtt_NumSlots; i++) {
+		if (strcmp(Mqtt_Slots[i].topic, topic) == 0) {
+			slot = &Mqtt_Slots[i];
+			break;
 		}
 	}
-#endif
+	if (slot == NULL) {
+		gMqttStats.dropped++;
+		Log_Printf(LOGLEVEL_ERROR, mqttTopicUnknown, topic);
+		return false;
+	}
 
+	const size_t length = strnlen(payload, sizeof(slot->payload) - 1u);
+	portENTER_CRITICAL(&Mqtt_SlotsMux);
+	if (slot->dirty) {
+		gMqttStats.coalesced++;
+	}
+	memcpy(slot->payload, payload, length);
+	slot->payload[length] = '\0';
+	slot->retained = retained;
+	slot->dirty = true;
+	portEXIT_CRITICAL(&Mqtt_SlotsMux);
+
+	if (Mqtt_TaskHandle) {
+		xTaskNotifyGive(Mqtt_TaskHandle);
+	}
+	return true;
+#else
 	return false;
+#endif
 }
 
 bool publishMqtt(const char *topic, int32_t payload, bool retained) {
@@ -198,260 +336,569 @@ void Mqtt_PostWiFiRssi(void) {
 #endif
 }
 
-/* Connects/reconnects to MQTT-Broker unless connection is not already available.
-	Manages MQTT-subscriptions.
-*/
-bool Mqtt_Reconnect() {
 #ifdef MQTT_ENABLE
-	static uint32_t mqttLastRetryTimestamp = 0u;
-	uint8_t connect = false;
-	uint8_t i = 0;
-
-	if (!mqttLastRetryTimestamp || millis() - mqttLastRetryTimestamp >= mqttRetryInterval * 1000) {
-		mqttLastRetryTimestamp = millis();
-	} else {
-		return false;
+// Marks all topics as not sent (after a reconnect the broker gets the current state again)
+static void Mqtt_MarkAllDirty(void) {
+	portENTER_CRITICAL(&Mqtt_SlotsMux);
+	for (uint8_t i = 0u; i < Mqtt_NumSlots; i++) {
+		Mqtt_Slots[i].dirty = true;
 	}
+	portEXIT_CRITICAL(&Mqtt_SlotsMux);
+}
 
-	while (!Mqtt_PubSubClient.connected() && i < mqttMaxRetriesPerInterval) {
-		i++;
-		Log_Printf(LOGLEVEL_NOTICE, tryConnectMqttS, gMqttServer.c_str());
+// Sends all topics that changed since they were sent last time
+static void Mqtt_Flush(void) {
+	char payload[mqttPayloadLength];
+
+	for (uint8_t i = 0u; i < Mqtt_NumSlots && Mqtt_PubSubClient.connected(); i++) {
+		mqttSlot_t &slot = Mqtt_Slots[i];
+		portENTER_CRITICAL(&Mqtt_SlotsMux);
+		const bool dirty = slot.dirty;
+		const bool retained = slot.retained;
+		if (dirty) {
+			memcpy(payload, slot.payload, strlen(slot.payload) + 1u);
+			slot.dirty = false;
+		}
+		portEXIT_CRITICAL(&Mqtt_SlotsMux);
+		if (!dirty) {
+			continue;
+		}
 
-		// Try to connect to MQTT-server. If username AND password are set, they'll be used
-		if ((gMqttUser.length() < 1u) || (gMqttPassword.length()) < 1u) {
-			Log_Println(mqttWithoutPwd, LOGLEVEL_NOTICE);
-			if (Mqtt_PubSubClient.connect(gMqttClientId.c_str())) {
-				connect = true;
-			}
+		if (Mqtt_PubSubClient.publish(slot.topic, payload, retained)) {
+			gMqttStats.published++;
 		} else {
-			Log_Println(mqttWithPwd, LOGLEVEL_NOTICE);
-			if (Mqtt_PubSubClient.connect(gMqttClientId.c_str(), gMqttUser.c_str(), gMqttPassword.c_str(), topicState, 0, false, "Offline")) {
-				connect = true;
+			gMqttStats.failed++;
+			if (!Mqtt_PubSubClient.connected()) {
+				// send again after reconnect (unless a newer value arrives in between)
+				portENTER_CRITICAL(&Mqtt_SlotsMux);
+				slot.dirty = true;
+				portEXIT_CRITICAL(&Mqtt_SlotsMux);
+			}
+		}
+	}
+}
+
+// Owns the connection to the broker: (re-)connects, handles incoming messages and sends the outbound topics.
+// Changes are collected for mqttPublishBatchTime, so e.g. a track-change (title, playmode, repeat-mode, cover) is sent in one go.
+static void Mqtt_Task(void *parameter) {
+	for (;;) {
+		if (ulTaskNotifyTake(pdTRUE, portTICK_PERIOD_MS * Mqtt_LoopInterval) && !Mqtt_ShutdownRequested) {
+			vTaskDelay(portTICK_PERIOD_MS * mqttPublishBatchTime);
+			ulTaskNotifyTake(pdTRUE, 0);
+		}
+
+		Mqtt_Reconnect();
+		if (Mqtt_ConnState == MqttConnState::Online) {
+			Mqtt_PubSubClient.loop();
+			if (Mqtt_DiscoveryRequested) {
+				Mqtt_DiscoveryRequested = false;
+				Mqtt_PublishDiscovery(true);
 			}
+			Mqtt_Flush();
 		}
-		if (connect) {
-			Log_Println(mqttOk, LOGLEVEL_NOTICE);
 
-			// Deepsleep-subscription
-			Mqtt_PubSubClient.subscribe(topicSleepCmnd);
+		if (Mqtt_ShutdownRequested) {
+			Mqtt_PubSubClient.disconnect();
+			Mqtt_ShutdownDone = true;
+			vTaskSuspend(NULL);
+		}
+	}
+}
+#endif
 
-			// RFID-Tag-ID-subscription
-			Mqtt_PubSubClient.subscribe(topicRfidCmnd);
+#ifdef MQTT_ENABLE
+// Home Assistant MQTT-discovery: one entity per state/command-topic pair
+typedef struct {
+	const char *component; // Home Assistant component (sensor, number, select, switch, text, button)
+	const char *objectId;
+	const char *name;
+	const char *stateTopic; // NULL: none
+	const char *commandTopic; // NULL: none
+	const char *options; // further JSON-members of the entity (starting with ',') or ""
+} mqttDiscoveryEntity_t;
+
+static constexpr mqttDiscoveryEntity_t Mqtt_DiscoveryEntities[] = {
+	{"sensor", "track", "Track", topicTrackState, NULL, ",\"ic\":\"mdi:music\""},
+	{"sensor", "playmode", "Playmode", topicPlaymodeState, NULL, ",\"ic\":\"mdi:playlist-play\""},
+	{"number", "loudness", "Loudness", topicLoudnessState, topicLoudnessCmnd, ",\"min\":0,\"max\":21,\"ic\":\"mdi:volume-high\""},
+	{"number", "led_brightness", "LED brightness", topicLedBrightnessState, topicLedBrightnessCmnd, ",\"min\":0,\"max\":255,\"ic\":\"mdi:brightness-6\""},
+	{"select", "repeat_mode", "Repeat mode", topicRepeatModeState, topicRepeatModeCmnd, ",\"options\":[\"0\",\"1\",\"2\",\"3\"]"},
+	{"switch", "lock_controls", "Lock controls", topicLockControlsState, topicLockControlsCmnd, ",\"val_tpl\":\"{{ 'ON' if value in ['ON', '1'] else 'OFF' }}\",\"ic\":\"mdi:lock\""},
+	{"sensor", "sleep_timer", "Sleep timer", topicSleepTimerState, NULL, ",\"ic\":\"mdi:timer-outline\""},
+	{"text", "rfid", "RFID", topicRfidState, topicRfidCmnd, ",\"ic\":\"mdi:nfc\""},
+	{"button", "pause_play", "Play/pause", NULL, topicTrackControlCmnd, ",\"pl_prs\":\"3\",\"ic\":\"mdi:play-pause\""},
+	{"button", "next_track", "Next track", NULL, topicTrackControlCmnd, ",\"pl_prs\":\"4\",\"ic\":\"mdi:skip-next\""},
+	{"button", "previous_track", "Previous track", NULL, topicTrackControlCmnd, ",\"pl_prs\":\"5\",\"ic\":\"mdi:skip-previous\""},
+	{"button", "sleep", "Sleep", NULL, topicSleepCmnd, ",\"pl_prs\":\"0\",\"ic\":\"mdi:power-sleep\""},
+	{"sensor", "rssi", "WiFi signal", topicWiFiRssiState, NULL, ",\"dev_cla\":\"signal_strength\",\"unit_of_meas\":\"dBm\",\"ent_cat\":\"diagnostic\""},
+	{"sensor", "ip", "IP address", topicCurrentIPv4IP, NULL, ",\"ent_cat\":\"diagnostic\""},
+	{"sensor", "revision", "Software revision", topicSRevisionState, NULL, ",\"ent_cat\":\"diagnostic\""},
+	#ifdef BATTERY_MEASURE_ENABLE
+	{"sensor", "voltage", "Battery voltage", topicBatteryVoltage, NULL, ",\"dev_cla\":\"voltage\",\"unit_of_meas\":\"V\""},
+	{"sensor", "battery", "Battery", topicBatterySOC, NULL, ",\"dev_cla\":\"battery\",\"unit_of_meas\":\"%\""},
+	#endif
+};
+
+// FNV-1a over revision & configuration
+static uint32_t Mqtt_DiscoveryHash(void) {
+	const char *parts[] = {softwareRevision, gitRevision, gMqttClientId.c_str(), gMqttServer.c_str(), mqttDiscoveryPrefix};
+	uint32_t hash = 2166136261u;
+	for (const char *part : parts) {
+		for (const char *c = part; *c; c++) {
+			hash = (hash ^ (uint8_t) *c) * 16777619u;
+		}
+		hash *= 16777619u; // separator
+	}
+	return (hash ^ (uint8_t) (sizeof(Mqtt_DiscoveryEntities) / sizeof(Mqtt_DiscoveryEntities[0]))) * 16777619u;
+}
 
-			// Loudness-subscription
-			Mqtt_PubSubClient.subscribe(topicLoudnessCmnd);
+// Publishes the (retained) discovery-documents of all entities, directly as they don't fit into the topic-table
+static void Mqtt_PublishDiscovery(const bool force) {
+	if (mqttDiscoveryPrefix[0] == '\0') {
+		return;
+	}
+	const uint32_t hash = Mqtt_DiscoveryHash();
+	if (!force && Mqtt_DiscoverySentHash == hash) {
+		return;
+	}
 
-			// Sleep-Timer-subscription
-			Mqtt_PubSubClient.subscribe(topicSleepTimerCmnd);
+	char revBuf[12];
+	strncpy(revBuf, softwareRevision + 19, sizeof(revBuf) - 1);
+	revBuf[sizeof(revBuf) - 1] = '\0';
+	const char *id = gMqttClientId.c_str();
+	char topic[128];
+	char payload[640];
+
+	for (const mqttDiscoveryEntity_t &entity : Mqtt_DiscoveryEntities) {
+		snprintf(topic, sizeof(topic), "%s/%s/%s/%s/config", mqttDiscoveryPrefix, entity.component, id, entity.objectId);
+		const int len = snprintf(payload, sizeof(payload), "{\"name\":\"%s\",\"uniq_id\":\"%s_%s\",\"obj_id\":\"%s_%s\"%s%s%s%s%s%s%s,\"avty_t\":\"%s\",\"pl_avail\":\"Online\",\"pl_not_avail\":\"Offline\",\"dev\":{\"ids\":[\"%s\"],\"name\":\"%s\",\"mf\":\"ESPuino\",\"sw\":\"%s\"}}",
+			entity.name, id, entity.objectId, id, entity.objectId,
+			entity.stateTopic ? ",\"stat_t\":\"" : "", entity.stateTopic ? entity.stateTopic : "", entity.stateTopic ? "\"" : "",
+			entity.commandTopic ? ",\"cmd_t\":\"" : "", entity.commandTopic ? entity.commandTopic : "", entity.commandTopic ? "\"" : "",
+			entity.options, topicState, id, id, revBuf);
+		if (len < 0 || (size_t) len >= sizeof(payload)) {
+			continue;
+		}
 
-			// Next/previous/stop/play-track-subscription
-			Mqtt_PubSubClient.subscribe(topicTrackControlCmnd);
+		// PubSubClient's buffer is too small for these documents => stream them
+		if (!Mqtt_PubSubClient.beginPublish(topic, len, true) || Mqtt_PubSubClient.write((const uint8_t *) payload, len) != (size_t) len || !Mqtt_PubSubClient.endPublish()) {
+			gMqttStats.failed++;
+			return; // try again with next connect
+		}
+		gMqttStats.published++;
+	}
+	if (Mqtt_DiscoverySentHash != hash) {
+		Mqtt_DiscoverySentHash = hash;
+		gPrefsSettings.putULong("mqttDiscHash", hash);
+	}
+	Log_Printf(LOGLEVEL_INFO, mqttDiscoveryPublished, (unsigned int) (sizeof(Mqtt_DiscoveryEntities) / sizeof(Mqtt_DiscoveryEntities[0])));
+}
+#endif
 
-			// Lock controls
-			Mqtt_PubSubClient.subscribe(topicLockControlsCmnd);
+/* Connection state machine, runs in MQTT-task only: the main loop never waits for the broker.
+	Failed attempts are repeated with exponential back-off (1s, 2s, 4s, .. up to mqttRetryInterval) and +-25% jitter,
+	so several devices don't hit a restarted broker all at the same time.
+*/
+void Mqtt_Reconnect(void) {
+#ifdef MQTT_ENABLE
+	if (!Wlan_IsConnected()) {
+		Mqtt_ConnState = MqttConnState::Offline;
+		Mqtt_Backoff = 0u;
+		return;
+	}
 
-			// Current repeat-Mode
-			Mqtt_PubSubClient.subscribe(topicRepeatModeCmnd);
+	if (Mqtt_ConnState == MqttConnState::Online) {
+		if (Mqtt_PubSubClient.connected()) {
+			return;
+		}
+		Log_Println(mqttConnLost, LOGLEVEL_NOTICE);
+		Mqtt_ConnState = MqttConnState::Offline;
+	}
+	if (Mqtt_ConnState == MqttConnState::Offline) {
+		// WiFi is back or connection was lost => first attempt immediately
+		Mqtt_ConnState = MqttConnState::Connecting;
+		Mqtt_NextAttempt = millis();
+	}
+	if ((int32_t) (millis() - Mqtt_NextAttempt) < 0) {
+		return;
+	}
 
-			// LED-brightness
-			Mqtt_PubSubClient.subscribe(topicLedBrightnessCmnd);
+	if (Mqtt_Connect()) {
+		Mqtt_ConnState = MqttConnState::Online;
+		Mqtt_Backoff = 0u;
+		return;
+	}
+	Mqtt_Backoff = Mqtt_Backoff ? std::min<uint32_t>(Mqtt_Backoff * 2u, mqttRetryInterval * 1000u) : Mqtt_BackoffMin;
+	const uint32_t delay = Mqtt_Backoff - Mqtt_Backoff / 4u + esp_random() % (Mqtt_Backoff / 2u + 1u);
+	Mqtt_NextAttempt = millis() + delay;
+	Log_Printf(LOGLEVEL_ERROR, mqttConnFailed, Mqtt_PubSubClient.state(), delay);
+#endif
+}
 
-			// Publish current state
-			publishMqtt(topicState, "Online", false);
-			publishMqtt(topicTrackState, gPlayProperties.title, false);
-			publishMqtt(topicCoverChangedState, "", false);
-			publishMqtt(topicLoudnessState, AudioPlayer_GetCurrentVolume(), false);
-			publishMqtt(topicSleepTimerState, System_GetSleepTimerTimeStamp(), false);
-			publishMqtt(topicLockControlsState, System_AreControlsLocked(), false);
-			publishMqtt(topicPlaymodeState, gPlayProperties.playMode, false);
-			publishMqtt(topicLedBrightnessState, Led_GetBrightness(), false);
-			publishMqtt(topicCurrentIPv4IP, Wlan_GetIpAddress().c_str(), false);
-			publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
+/* Single attempt to connect to MQTT-Broker (blocks MQTT-task up to TCP-timeout if broker is unreachable).
+	Manages MQTT-subscriptions.
+*/
+bool Mqtt_Connect(void) {
+#ifdef MQTT_ENABLE
+	bool connect = false;
 
-			char revBuf[12];
-			strncpy(revBuf, softwareRevision + 19, sizeof(revBuf) - 1);
-			revBuf[sizeof(revBuf) - 1] = '\0';
-			publishMqtt(topicSRevisionState, revBuf, false);
+	Log_Printf(LOGLEVEL_NOTICE, tryConnectMqttS, gMqttServer.c_str());
+	const uint32_t connectStart = millis();
 
-			return Mqtt_PubSubClient.connected();
-		} else {
-			Log_Printf(LOGLEVEL_ERROR, mqttConnFailed, Mqtt_PubSubClient.state(), i, mqttMaxRetriesPerInterval);
+	// Try to connect to MQTT-server. If username AND password are set, they'll be used
+	if ((gMqttUser.length() < 1u) || (gMqttPassword.length()) < 1u) {
+		Log_Println(mqttWithoutPwd, LOGLEVEL_NOTICE);
+		if (Mqtt_PubSubClient.connect(gMqttClientId.c_str(), topicState, 0, true, "Offline")) {
+			connect = true;
+		}
+	} else {
+		Log_Println(mqttWithPwd, LOGLEVEL_NOTICE);
+		if (Mqtt_PubSubClient.connect(gMqttClientId.c_str(), gMqttUser.c_str(), gMqttPassword.c_str(), topicState, 0, true, "Offline")) {
+			connect = true;
 		}
 	}
-	return false;
+	gMqttStats.connectTimeHist.add(millis() - connectStart);
+	if (!connect) {
+		gMqttStats.connectFailures++;
+		return false;
+	}
+
+	Log_Println(mqttOk, LOGLEVEL_NOTICE);
+	gMqttStats.connects++;
+
+	Mqtt_Subscribe();
+
+	// Publish current state (and all other topics published so far)
+	playerState_t playerState;
+	AudioPlayer_GetState(playerState);
+	Mqtt_MarkAllDirty();
+	publishMqtt(topicState, "Online", true); // availability of Home Assistant-entities, has to be known after its restart
+	publishMqtt(topicTrackState, playerState.title, false);
+	publishMqtt(topicCoverChangedState, "", false);
+	publishMqtt(topicLoudnessState, AudioPlayer_GetCurrentVolume(), false);
+	publishMqtt(topicSleepTimerState, System_GetSleepTimerTimeStamp(), false);
+	publishMqtt(topicLockControlsState, System_AreControlsLocked(), false);
+	publishMqtt(topicPlaymodeState, playerState.playMode, false);
+	publishMqtt(topicLedBrightnessState, Led_GetBrightness(), false);
+	publishMqtt(topicCurrentIPv4IP, Wlan_GetIpAddress().c_str(), false);
+	publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
+
+	char revBuf[12];
+	strncpy(revBuf, softwareRevision + 19, sizeof(revBuf) - 1);
+	revBuf[sizeof(revBuf) - 1] = '\0';
+	publishMqtt(topicSRevisionState, revBuf, false);
+
+	Mqtt_PublishDiscovery(false);
+
+	return Mqtt_PubSubClient.connected();
 #else
 	return false;
 #endif
 }
 
-// Is called if there's a new MQTT-message for us
-void Mqtt_ClientCallback(const char *topic, const byte *payload, uint32_t length) {
 #ifdef MQTT_ENABLE
-	char *receivedString = (char *) x_calloc(length + 1u, sizeof(char));
-	memcpy(receivedString, (char *) payload, length);
+static void Mqtt_CmdSleep(const char *value) {
+	if ((strcmp(value, "OFF") == 0) || (strcmp(value, "0") == 0)) {
+		System_RequestSleep();
+	}
+}
 
-	Log_Printf(LOGLEVEL_INFO, mqttMsgReceived, topic, receivedString);
+// New track to play? Take RFID-ID as input
+static void Mqtt_CmdRfid(const char *value) {
+	Rfid_SendId(gRfidInjectQueue, value);
+}
 
-	// Go to sleep?
-	if (strcmp_P(topic, topicSleepCmnd) == 0) {
-		if ((strcmp(receivedString, "OFF") == 0) || (strcmp(receivedString, "0") == 0)) {
-			System_RequestSleep();
-		}
-	}
-	// New track to play? Take RFID-ID as input
-	else if (strcmp_P(topic, topicRfidCmnd) == 0) {
-		xQueueSend(gRfidCardQueue, receivedString, 0);
-	}
-	// Loudness to change?
-	else if (strcmp_P(topic, topicLoudnessCmnd) == 0) {
-		unsigned long vol = strtoul(receivedString, NULL, 10);
-		AudioPlayer_VolumeToQueueSender(vol, true);
+static void Mqtt_CmdLoudness(const char *value) {
+	unsigned long vol = strtoul(value, NULL, 10);
+	AudioPlayer_VolumeToQueueSender(vol, true);
+}
+
+static void Mqtt_CmdSleepTimer(const char *value) {
+	if (gPlayProperties.playMode == NO_PLAYLIST) { // Don't allow sleep-modications if no playlist is active
+		Log_Println(modificatorNotallowedWhenIdle, LOGLEVEL_INFO);
+		publishMqtt(topicSleepState, 0, false);
+		System_IndicateError();
+		return;
 	}
-	// Modify sleep-timer?
-	else if (strcmp_P(topic, topicSleepTimerCmnd) == 0) {
-		if (gPlayProperties.playMode == NO_PLAYLIST) { // Don't allow sleep-modications if no playlist is active
-			Log_Println(modificatorNotallowedWhenIdle, LOGLEVEL_INFO);
+	if (strcmp(value, "EOP") == 0) {
+		gPlayProperties.sleepAfterPlaylist = true;
+		Log_Println(sleepTimerEOP, LOGLEVEL_NOTICE);
+		publishMqtt(topicSleepTimerState, "EOP", false);
+		Led_SetNightmode(true);
+		System_IndicateOk();
+		return;
+	} else if (strcmp(value, "EOT") == 0) {
+		gPlayProperties.sleepAfterCurrentTrack = true;
+		Log_Println(sleepTimerEOT, LOGLEVEL_NOTICE);
+		publishMqtt(topicSleepTimerState, "EOT", false);
+		Led_SetNightmode(true);
+		System_IndicateOk();
+		return;
+	} else if (strcmp(value, "EO5T") == 0) {
+		if ((gPlayProperties.numberOfTracks - 1) >= (gPlayProperties.currentTrackNumber + 5)) {
+			gPlayProperties.playUntilTrackNumber = gPlayProperties.currentTrackNumber + 5;
+		} else {
+			gPlayProperties.sleepAfterPlaylist = true; // If +5 tracks is > than active playlist, take end of current playlist
+		}
+		Log_Println(sleepTimerEO5, LOGLEVEL_NOTICE);
+		publishMqtt(topicSleepTimerState, "EO5T", false);
+		Led_SetNightmode(true);
+		System_IndicateOk();
+		return;
+	} else if (strcmp(value, "0") == 0) { // Disable sleep after it was active previously
+		if (System_IsSleepTimerEnabled()) {
+			System_DisableSleepTimer();
+			Log_Println(sleepTimerStop, LOGLEVEL_NOTICE);
+			System_IndicateOk();
+			Led_SetNightmode(false);
 			publishMqtt(topicSleepState, 0, false);
+			gPlayProperties.sleepAfterPlaylist = false;
+			gPlayProperties.sleepAfterCurrentTrack = false;
+			gPlayProperties.playUntilTrackNumber = 0;
+		} else {
+			Log_Println(sleepTimerAlreadyStopped, LOGLEVEL_INFO);
 			System_IndicateError();
-			free(receivedString);
-			return;
 		}
-		if (strcmp(receivedString, "EOP") == 0) {
-			gPlayProperties.sleepAfterPlaylist = true;
-			Log_Println(sleepTimerEOP, LOGLEVEL_NOTICE);
-			publishMqtt(topicSleepTimerState, "EOP", false);
-			Led_SetNightmode(true);
-			System_IndicateOk();
-			free(receivedString);
-			return;
-		} else if (strcmp(receivedString, "EOT") == 0) {
-			gPlayProperties.sleepAfterCurrentTrack = true;
-			Log_Println(sleepTimerEOT, LOGLEVEL_NOTICE);
-			publishMqtt(topicSleepTimerState, "EOT", false);
-			Led_SetNightmode(true);
-			System_IndicateOk();
-			free(receivedString);
-			return;
-		} else if (strcmp(receivedString, "EO5T") == 0) {
-			if ((gPlayProperties.numberOfTracks - 1) >= (gPlayProperties.currentTrackNumber + 5)) {
-				gPlayProperties.playUntilTrackNumber = gPlayProperties.currentTrackNumber + 5;
-			} else {
-				gPlayProperties.sleepAfterPlaylist = true; // If +5 tracks is > than active playlist, take end of current playlist
-			}
-			Log_Println(sleepTimerEO5, LOGLEVEL_NOTICE);
-			publishMqtt(topicSleepTimerState, "EO5T", false);
-			Led_SetNightmode(true);
-			System_IndicateOk();
-			free(receivedString);
-			return;
-		} else if (strcmp(receivedString, "0") == 0) { // Disable sleep after it was active previously
-			if (System_IsSleepTimerEnabled()) {
-				System_DisableSleepTimer();
-				Log_Println(sleepTimerStop, LOGLEVEL_NOTICE);
-				System_IndicateOk();
-				Led_SetNightmode(false);
-				publishMqtt(topicSleepState, 0, false);
-				gPlayProperties.sleepAfterPlaylist = false;
-				gPlayProperties.sleepAfterCurrentTrack = false;
-				gPlayProperties.playUntilTrackNumber = 0;
-			} else {
-				Log_Println(sleepTimerAlreadyStopped, LOGLEVEL_INFO);
-				System_IndicateError();
+		return;
+	}
+	System_SetSleepTimer((uint8_t) strtoul(value, NULL, 10));
+	Log_Printf(LOGLEVEL_NOTICE, sleepTimerSetTo, System_GetSleepTimer());
+	System_IndicateOk();
+
+	gPlayProperties.sleepAfterPlaylist = false;
+	gPlayProperties.sleepAfterCurrentTrack = false;
+}
+
+// Track-control (pause/play, stop, first, last, next, previous)
+static void Mqtt_CmdTrackControl(const char *value) {
+	uint8_t controlCommand = strtoul(value, NULL, 10);
+	AudioPlayer_TrackControlToQueueSender(controlCommand);
+}
+
+static void Mqtt_CmdLockControls(const char *value) {
+	if (strcmp(value, "OFF") == 0) {
+		System_SetLockControls(false);
+		Log_Println(allowButtons, LOGLEVEL_NOTICE);
+		publishMqtt(topicLockControlsState, "OFF", false);
+		System_IndicateOk();
+	} else if (strcmp(value, "ON") == 0) {
+		System_SetLockControls(true);
+		Log_Println(lockButtons, LOGLEVEL_NOTICE);
+		publishMqtt(topicLockControlsState, "ON", false);
+		System_IndicateOk();
+	}
+}
+
+static void Mqtt_CmdRepeatMode(const char *value) {
+	uint8_t repeatMode = strtoul(value, NULL, 10);
+	Log_Printf(LOGLEVEL_NOTICE, "Repeat: %d", repeatMode);
+	if (gPlayProperties.playMode != NO_PLAYLIST) {
+		if (gPlayProperties.playMode == NO_PLAYLIST) {
+			publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
+			Log_Println(noPlaylistNotAllowedMqtt, LOGLEVEL_ERROR);
+			System_IndicateError();
+		} else {
+			switch (repeatMode) {
+				case NO_REPEAT:
+					gPlayProperties.repeatCurrentTrack = false;
+					gPlayProperties.repeatPlaylist = false;
+					publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
+					Log_Println(modeRepeatNone, LOGLEVEL_INFO);
+					System_IndicateOk();
+					break;
+
+				case TRACK:
+					gPlayProperties.repeatCurrentTrack = true;
+					gPlayProperties.repeatPlaylist = false;
+					publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
+					Log_Println(modeRepeatTrack, LOGLEVEL_INFO);
+					System_IndicateOk();
+					break;
+
+				case PLAYLIST:
+					gPlayProperties.repeatCurrentTrack = false;
+					gPlayProperties.repeatPlaylist = true;
+					publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
+					Log_Println(modeRepeatPlaylist, LOGLEVEL_INFO);
+					System_IndicateOk();
+					break;
+
+				case TRACK_N_PLAYLIST:
+					gPlayProperties.repeatCurrentTrack = true;
+					gPlayProperties.repeatPlaylist = true;
+					publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
+					Log_Println(modeRepeatTracknPlaylist, LOGLEVEL_INFO);
+					System_IndicateOk();
+					break;
+
+				default:
+					System_IndicateError();
+					publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
+					break;
 			}
-			free(receivedString);
-			return;
 		}
-		System_SetSleepTimer((uint8_t) strtoul(receivedString, NULL, 10));
-		Log_Printf(LOGLEVEL_NOTICE, sleepTimerSetTo, System_GetSleepTimer());
-		System_IndicateOk();
+	}
+}
 
-		gPlayProperties.sleepAfterPlaylist = false;
-		gPlayProperties.sleepAfterCurrentTrack = false;
+static void Mqtt_CmdLedBrightness(const char *value) {
+	Led_SetBrightness(strtoul(value, NULL, 10));
+}
+
+static void Mqtt_CmdBatch(const byte *payload, uint32_t length);
+
+// Commands: topic (subscribed) & name (key in batch-command)
+typedef struct {
+	const char *topic;
+	const char *name;
+	void (*handler)(const char *value); // NULL: batch-command
+} mqttCommand_t;
+
+static constexpr mqttCommand_t Mqtt_Commands[] = {
+	{topicSleepCmnd, "sleep", Mqtt_CmdSleep},
+	{topicRfidCmnd, "rfid", Mqtt_CmdRfid},
+	{topicLoudnessCmnd, "loudness", Mqtt_CmdLoudness},
+	{topicSleepTimerCmnd, "sleepTimer", Mqtt_CmdSleepTimer},
+	{topicTrackControlCmnd, "trackControl", Mqtt_CmdTrackControl},
+	{topicLockControlsCmnd, "lockControls", Mqtt_CmdLockControls},
+	{topicRepeatModeCmnd, "repeatMode", Mqtt_CmdRepeatMode},
+	{topicLedBrightnessCmnd, "ledBrightness", Mqtt_CmdLedBrightness},
+	{topicBatchCmnd, "batch", NULL},
+};
+
+// Hash-tables (open addressing, linear probing) topic => command and name => command, built once in Mqtt_Init().
+// A lookup costs one hash and (usually) one strcmp instead of comparing against every topic.
+static constexpr uint8_t Mqtt_CommandTableSize = 32u;
+static constexpr uint8_t Mqtt_CommandTableEmpty = 0xFFu;
+static_assert((Mqtt_CommandTableSize & (Mqtt_CommandTableSize - 1u)) == 0, "size of command-table has to be a power of 2");
+static_assert(sizeof(Mqtt_Commands) / sizeof(Mqtt_Commands[0]) <= Mqtt_CommandTableSize / 2u, "command-table is too small");
+static uint8_t Mqtt_TopicTable[Mqtt_CommandTableSize];
+static uint8_t Mqtt_NameTable[Mqtt_CommandTableSize];
+
+static void Mqtt_Subscribe(void) {
+	for (const mqttCommand_t &command : Mqtt_Commands) {
+		Mqtt_PubSubClient.subscribe(command.topic);
+	}
+	if (mqttDiscoveryPrefix[0] != '\0') {
+		snprintf(Mqtt_DiscoveryStatusTopic, sizeof(Mqtt_DiscoveryStatusTopic), "%s/status", mqttDiscoveryPrefix);
+		Mqtt_PubSubClient.subscribe(Mqtt_DiscoveryStatusTopic);
 	}
-	// Track-control (pause/play, stop, first, last, next, previous)
-	else if (strcmp_P(topic, topicTrackControlCmnd) == 0) {
-		uint8_t controlCommand = strtoul(receivedString, NULL, 10);
-		AudioPlayer_TrackControlToQueueSender(controlCommand);
+}
+
+// FNV-1a
+static uint32_t Mqtt_CommandHash(const char *key) {
+	uint32_t hash = 2166136261u;
+	for (const char *c = key; *c; c++) {
+		hash = (hash ^ (uint8_t) *c) * 16777619u;
 	}
+	return hash;
+}
 
-	// Check if controls should be locked
-	else if (strcmp_P(topic, topicLockControlsCmnd) == 0) {
-		if (strcmp(receivedString, "OFF") == 0) {
-			System_SetLockControls(false);
-			Log_Println(allowButtons, LOGLEVEL_NOTICE);
-			publishMqtt(topicLockControlsState, "OFF", false);
-			System_IndicateOk();
-		} else if (strcmp(receivedString, "ON") == 0) {
-			System_SetLockControls(true);
-			Log_Println(lockButtons, LOGLEVEL_NOTICE);
-			publishMqtt(topicLockControlsState, "ON", false);
-			System_IndicateOk();
+static void Mqtt_CommandTablesBuild(void) {
+	memset(Mqtt_TopicTable, Mqtt_CommandTableEmpty, sizeof(Mqtt_TopicTable));
+	memset(Mqtt_NameTable, Mqtt_CommandTableEmpty, sizeof(Mqtt_NameTable));
+	for (uint8_t i = 0u; i < sizeof(Mqtt_Commands) / sizeof(Mqtt_Commands[0]); i++) {
+		uint8_t slot = Mqtt_CommandHash(Mqtt_Commands[i].topic) & (Mqtt_CommandTableSize - 1u);
+		while (Mqtt_TopicTable[slot] != Mqtt_CommandTableEmpty) {
+			slot = (slot + 1u) & (Mqtt_CommandTableSize - 1u);
 		}
+		Mqtt_TopicTable[slot] = i;
+
+		slot = Mqtt_CommandHash(Mqtt_Commands[i].name) & (Mqtt_CommandTableSize - 1u);
+		while (Mqtt_NameTable[slot] != Mqtt_CommandTableEmpty) {
+			slot = (slot + 1u) & (Mqtt_CommandTableSize - 1u);
+		}
+		Mqtt_NameTable[slot] = i;
 	}
+}
 
-	// Check if playmode should be adjusted
-	else if (strcmp_P(topic, topicRepeatModeCmnd) == 0) {
-		uint8_t repeatMode = strtoul(receivedString, NULL, 10);
-		Log_Printf(LOGLEVEL_NOTICE, "Repeat: %d", repeatMode);
-		if (gPlayProperties.playMode != NO_PLAYLIST) {
-			if (gPlayProperties.playMode == NO_PLAYLIST) {
-				publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
-				Log_Println(noPlaylistNotAllowedMqtt, LOGLEVEL_ERROR);
-				System_IndicateError();
-			} else {
-				switch (repeatMode) {
-					case NO_REPEAT:
-						gPlayProperties.repeatCurrentTrack = false;
-						gPlayProperties.repeatPlaylist = false;
-						publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
-						Log_Println(modeRepeatNone, LOGLEVEL_INFO);
-						System_IndicateOk();
-						break;
-
-					case TRACK:
-						gPlayProperties.repeatCurrentTrack = true;
-						gPlayProperties.repeatPlaylist = false;
-						publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
-						Log_Println(modeRepeatTrack, LOGLEVEL_INFO);
-						System_IndicateOk();
-						break;
-
-					case PLAYLIST:
-						gPlayProperties.repeatCurrentTrack = false;
-						gPlayProperties.repeatPlaylist = true;
-						publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
-						Log_Println(modeRepeatPlaylist, LOGLEVEL_INFO);
-						System_IndicateOk();
-						break;
-
-					case TRACK_N_PLAYLIST:
-						gPlayProperties.repeatCurrentTrack = true;
-						gPlayProperties.repeatPlaylist = true;
-						publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
-						Log_Println(modeRepeatTracknPlaylist, LOGLEVEL_INFO);
-						System_IndicateOk();
-						break;
-
-					default:
-						System_IndicateError();
-						publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
-						break;
-				}
-			}
+// Returns command by topic (byName == false) or name (byName == true); NULL if unknown
+static const mqttCommand_t *Mqtt_CommandFind(const char *key, const bool byName) {
+	const uint8_t *table = byName ? Mqtt_NameTable : Mqtt_TopicTable;
+	for (uint8_t slot = Mqtt_CommandHash(key) & (Mqtt_CommandTableSize - 1u); table[slot] != Mqtt_CommandTableEmpty; slot = (slot + 1u) & (Mqtt_CommandTableSize - 1u)) {
+		const mqttCommand_t &command = Mqtt_Commands[table[slot]];
+		if (strcmp(byName ? command.name : command.topic, key) == 0) {
+			return &command;
+		}
+	}
+	return NULL;
+}
+
+// Value of a batch-action as string (like it would be received by the command-topic)
+static bool Mqtt_BatchValue(JsonVariantConst value, char *buf, const size_t bufSize) {
+	if (value.is<const char *>()) {
+		snprintf(buf, bufSize, "%s", value.as<const char *>());
+		return true;
+	}
+	if (value.is<long>()) {
+		snprintf(buf, bufSize, "%ld", value.as<long>());
+		return true;
+	}
+	return false;
+}
+
+/* Executes an ordered list of commands in one go, e.g. [{"loudness":12},{"sleepTimer":30},{"rfid":"123456789012"}].
+	Payload is JSON or MessagePack. The whole batch is checked first: if one action is invalid, none is executed.
+*/
+static void Mqtt_CmdBatch(const byte *payload, uint32_t length) {
+	StaticJsonDocument<512> doc;
+	// JSON may start with whitespace; a MessagePack-array never starts with one of these bytes
+	uint32_t start = 0u;
+	while (start < length && isspace(payload[start])) {
+		start++;
+	}
+	const DeserializationError error = (start < length && payload[start] == '[') ? deserializeJson(doc, (const char *) payload, length) : deserializeMsgPack(doc, (const char *) payload, length);
+	if (error || !doc.is<JsonArray>() || doc.size() > mqttBatchMaxActions) {
+		Log_Printf(LOGLEVEL_ERROR, mqttBatchInvalid, error ? error.c_str() : "format");
+		System_IndicateError();
+		return;
+	}
+
+	char value[mqttPayloadLength];
+	JsonArrayConst actions = doc.as<JsonArrayConst>();
+	for (JsonObjectConst action : actions) {
+		const mqttCommand_t *command = (action.size() == 1u) ? Mqtt_CommandFind(action.begin()->key().c_str(), true) : NULL;
+		if (command == NULL || command->handler == NULL || !Mqtt_BatchValue(action.begin()->value(), value, sizeof(value))) {
+			Log_Printf(LOGLEVEL_ERROR, mqttBatchInvalid, action.isNull() ? "action" : action.begin()->key().c_str());
+			System_IndicateError();
+			return;
 		}
 	}
 
-	// Check if LEDs should be dimmed
-	else if (strcmp_P(topic, topicLedBrightnessCmnd) == 0) {
-		Led_SetBrightness(strtoul(receivedString, NULL, 10));
+	for (JsonObjectConst action : actions) {
+		Mqtt_BatchValue(action.begin()->value(), value, sizeof(value));
+		Mqtt_CommandFind(action.begin()->key().c_str(), true)->handler(value);
 	}
+}
+#endif
 
-	// Requested something that isn't specified?
-	else {
+// Is called if there's a new MQTT-message for us
+void Mqtt_ClientCallback(const char *topic, const byte *payload, uint32_t length) {
+#ifdef MQTT_ENABLE
+	if (strcmp(topic, Mqtt_DiscoveryStatusTopic) == 0) {
+		// Home Assistant (re-)started => discovery-documents are sent again by MQTT-task (not from within the callback)
+		if (length == 6u && memcmp(payload, "online", 6u) == 0) {
+			Mqtt_DiscoveryRequested = true;
+		}
+		return;
+	}
+	const mqttCommand_t *command = Mqtt_CommandFind(topic, false);
+	if (command == NULL) { // Requested something that isn't specified?
 		Log_Printf(LOGLEVEL_ERROR, noValidTopic, topic);
 		System_IndicateError();
+		return;
+	}
+	if (command->handler == NULL) {
+		Log_Printf(LOGLEVEL_INFO, mqttMsgReceived, topic, "(batch)");
+		Mqtt_CmdBatch(payload, length);
+		return;
 	}
 
-	free(receivedString);
+	char receivedString[mqttPayloadLength];
+	const uint32_t len = std::min<uint32_t>(length, sizeof(receivedString) - 1u);
+	memcpy(receivedString, payload, len);
+	receivedString[len] = '\0';
+
+	Log_Printf(LOGLEVEL_INFO, mqttMsgReceived, topic, receivedString);
+	command->handler(receivedString);
 #endif
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Histogram.h"
+
 #ifdef MQTT_ENABLE
 	#define MQTT_SOCKET_TIMEOUT 1 // https://github.com/knolleary/pubsubclient/issues/403
 	#include <PubSubClient.h>
@@ -10,6 +12,22 @@ constexpr uint8_t mqttClientIdLength = 16u;
 constexpr uint8_t mqttServerLength = 32u;
 constexpr uint8_t mqttUserLength = 16u;
 constexpr uint8_t mqttPasswordLength = 16u;
+constexpr uint16_t mqttPayloadLength = 256u; // max. length of a payload (incl. \0), longer ones are truncated
+constexpr uint8_t mqttBatchMaxActions = 16u; // max. number of actions in a batch-command
+
+// Outbound MQTT statistics
+typedef struct {
+	uint32_t published; // messages sent to the broker
+	uint32_t coalesced; // updates that replaced a not yet sent value of the same topic
+	uint32_t failed; // publish failed (connection lost or message too large)
+	uint32_t dropped; // messages dropped as their topic isn't in the topic-table
+	uint32_t connects; // successful (re-)connects to the broker
+	uint32_t connectFailures; // failed connection attempts
+	Histogram connectTimeHist; // duration of a connection attempt (in ms), spent in MQTT-task
+	uint32_t since; // millis() of last reset
+} mqttStats_t;
+
+extern mqttStats_t gMqttStats;
 
 extern String gMqttUser;
 extern String gMqttPassword;
@@ -19,7 +37,10 @@ void Mqtt_Init(void);
 void Mqtt_Cyclic(void);
 void Mqtt_Exit(void);
 bool Mqtt_IsEnabled(void);
+void Mqtt_ResetStats(void);
 
+// Publishing is asynchronous: the message is stored in the topic-table and sent by the MQTT-task (last value per topic wins).
+// Only the pointer to topic is stored: it has to be a string with static storage duration (the topics from settings.h), no buffer on the stack.
 bool publishMqtt(const char *topic, const char *payload, bool retained);
 bool publishMqtt(const char *topic, int32_t payload, bool retained);
 bool publishMqtt(const char *topic, unsigned long payload, bool retained);
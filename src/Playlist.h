@@ -0,0 +1,145 @@
+#pragma once
+
+// Playlist helpers without dependencies to Arduino/FreeRTOS, so they can be compiled and profiled on a host as well.
+// A playlist is an array of char* (one entry per track).
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// Supported audio- and playlist-formats (lower case)
+static const char *const Playlist_ValidExtensions[] = {
+	// audio file formats
+	".mp3", ".aac", ".m4a", ".wav", ".flac", ".ogg", ".oga", ".opus",
+	// playlist file formats
+	".m3u", ".m3u8", ".pls", ".asx"};
+
+// Checks if a file can be added to a playlist: name doesn't start with "." and extension is supported (case insensitive).
+// Doesn't allocate, as it's called for every file of a directory.
+inline bool Playlist_FileValid(const char *path) {
+	const char *name = strrchr(path, '/');
+	if (name != NULL && name[1] == '.') {
+		return false;
+	}
+	const size_t len = strlen(path);
+	for (const char *ext : Playlist_ValidExtensions) {
+		const size_t extLen = strlen(ext);
+		if (len >= extLen && !strcasecmp(path + len - extLen, ext)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Knuth-Fisher-Yates-algorithm to randomize playlist
+inline void Playlist_Randomize(char **str, const uint32_t count) {
+	if (!count) {
+		return;
+	}
+
+	uint32_t i, r;
+	char *swap = NULL;
+	uint32_t max = count - 1;
+
+	for (i = 0; i < count; i++) {
+		r = (max > 0) ? rand() % max : 0;
+		swap = *(str + max);
+		*(str + max) = *(str + r);
+		*(str + r) = swap;
+		max--;
+	}
+}
+
+// Helper to sort playlist alphabetically
+inline int Playlist_SortHelper(const void *a, const void *b) {
+	return strcmp(*(const char **) a, *(const char **) b);
+}
+
+// Sort playlist alphabetically
+inline void Playlist_Sort(char **arr, const uint32_t count) {
+	qsort(arr, count, sizeof(const char *), Playlist_SortHelper);
+}
+
+// Appends <delimiter><name> to a serialized playlist of the given length and returns its new length.
+// The length is tracked by the caller instead of strlen()/strcat(), so building a list of n files stays linear.
+// list has to provide length + nameLength + 2 bytes.
+inline size_t Playlist_Append(char *list, size_t length, const char *name, const size_t nameLength, const char delimiter) {
+	list[length++] = delimiter;
+	memcpy(list + length, name, nameLength + 1);
+	return length + nameLength;
+}
+
+// Number of entries of a serialized playlist (one delimiter per entry)
+inline uint32_t Playlist_Count(const char *list, const char delimiter) {
+	uint32_t cnt = 0;
+	for (const char *c = list; *c != '\0'; c++) {
+		if (*c == delimiter) {
+			cnt++;
+		}
+	}
+	return cnt;
+}
+
+// FNV-1a over all entries (in order), e.g. to check whether a stored playlist is still the same
+inline uint32_t Playlist_Hash(char **files, const uint32_t count) {
+	uint32_t hash = 2166136261u;
+	for (uint32_t i = 0; i < count; i++) {
+		for (const char *c = files[i]; *c != '\0'; c++) {
+			hash = (hash ^ (uint8_t) *c) * 16777619u;
+		}
+		hash = (hash ^ '\n') * 16777619u;
+	}
+	return hash;
+}
+
+// Settings of a RFID-tag as stored in NVS: #<file/folder>#<startPlayPositionInBytes>#<playmode>#<trackNumberToStartWith>
+typedef struct {
+	char file[255];
+	uint32_t lastPlayPos;
+	uint32_t playMode;
+	uint16_t trackLastPlayed;
+} rfidEntry_t;
+
+// Extracts the settings of a RFID-tag out of its serialized NVS-string (input isn't modified).
+// Like strtok(), empty fields are skipped. Returns true if exactly four fields were found.
+inline bool Playlist_ParseRfidEntry(const char *str, const char delimiter, rfidEntry_t &entry) {
+	uint8_t field = 0;
+
+	entry.file[0] = '\0';
+	entry.lastPlayPos = 0;
+	entry.playMode = 1;
+	entry.trackLastPlayed = 0;
+
+	while (*str != '\0') {
+		if (*str == delimiter) {
+			str++;
+			continue;
+		}
+		const char *end = strchr(str, delimiter);
+		const size_t len = end ? (size_t) (end - str) : strlen(str);
+		switch (field) {
+			case 0: {
+				const size_t n = (len < sizeof(entry.file) - 1) ? len : sizeof(entry.file) - 1;
+				memcpy(entry.file, str, n);
+				entry.file[n] = '\0';
+				break;
+			}
+			case 1:
+				entry.lastPlayPos = strtoul(str, NULL, 10);
+				break;
+			case 2:
+				entry.playMode = strtoul(str, NULL, 10);
+				break;
+			case 3:
+				entry.trackLastPlayed = strtoul(str, NULL, 10);
+				break;
+			default:
+				break;
+		}
+		field++;
+		str += len;
+	}
+
+	return field == 4;
+}
@@ -9,6 +9,8 @@ QueueHandle_t gTrackQueue;
 QueueHandle_t gTrackControlQueue;
 QueueHandle_t gRfidCardQueue;
 QueueHandle_t gButtonIdQueue;
+QueueHandle_t gRfidInjectQueue;
+QueueSetHandle_t gIdQueueSet;
 
 void Queues_Init(void) {
 	// Create queues
@@ -27,6 +29,17 @@ void Queues_Init(void) {
 		Log_Println(unableToCreateButtonQ, LOGLEVEL_ERROR);
 	}
 
+	gRfidInjectQueue = xQueueCreate(1, ID_STRING_SIZE);
+	if (gRfidInjectQueue == NULL) {
+		Log_Println(unableToCreateRfidQ, LOGLEVEL_ERROR);
+	}
+
+	// Allows to block on RFID- and button-queues at once. Queues have to be empty when added, so do it right away
+	gIdQueueSet = xQueueCreateSet(3);
+	if (gIdQueueSet == NULL || xQueueAddToSet(gRfidCardQueue, gIdQueueSet) != pdPASS || xQueueAddToSet(gButtonIdQueue, gIdQueueSet) != pdPASS || xQueueAddToSet(gRfidInjectQueue, gIdQueueSet) != pdPASS) {
+		Log_Println(unableToCreateIdQSet, LOGLEVEL_ERROR);
+	}
+
 	gTrackControlQueue = xQueueCreate(1, sizeof(uint8_t));
 	if (gTrackControlQueue == NULL) {
 		Log_Println(unableToCreateMgmtQ, LOGLEVEL_ERROR);
@@ -5,5 +5,7 @@ extern QueueHandle_t gTrackQueue;
 extern QueueHandle_t gTrackControlQueue;
 extern QueueHandle_t gRfidCardQueue;
 extern QueueHandle_t gButtonIdQueue;
+extern QueueHandle_t gRfidInjectQueue; // RFID-ids that aren't read from a card (MQTT, re-injected by audio-player/after reboot); no part of gestures
+extern QueueSetHandle_t gIdQueueSet; // gRfidCardQueue + gButtonIdQueue + gRfidInjectQueue
 
 void Queues_Init(void);
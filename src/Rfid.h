@@ -1,18 +1,34 @@
 #pragma once
 
+#include "Histogram.h"
+
+#include <algorithm>
 
 constexpr uint8_t cardIdSize = 4u;
 constexpr uint8_t CARD_ID_STR_SIZE = (cardIdSize * 3u) + 1u;
 constexpr uint8_t BUTTON_ID_STR_SIZE = 12; //sizeof("BTNxx_SHORT") + 1u;
+// Size of every id (RFID-tag, gesture, button) incl. \0: buffers, items of the id-queues and copies
+constexpr uint8_t ID_STRING_SIZE = std::max(CARD_ID_STR_SIZE, BUTTON_ID_STR_SIZE);
 
+extern char gCurrentId[ID_STRING_SIZE];
 
-#if CARD_ID_STR_SIZE > BUTTON_ID_STR_SIZE
-	constexpr uint8_t ID_STRING_SIZE = CARD_ID_STR_SIZE;
-#else
-	constexpr uint8_t ID_STRING_SIZE = BUTTON_ID_STR_SIZE;
-#endif
+// Reader statistics (used to tune RFID_SCAN_INTERVAL and antenna placement)
+typedef struct {
+	uint32_t scans; // read attempts (polls) of the reader
+	uint32_t readErrors; // card (maybe) present but reading failed
+	uint32_t cardsDetected; // cards applied
+	uint32_t removals; // cards removed
+	uint32_t flaps; // single scans without card while card was still considered as applied (debounce)
+	uint32_t since; // millis() of last reset
+	Histogram readTimeHist; // duration of a single read attempt (in µs)
+	Histogram cardReadTimeHist; // duration of read attempts that returned a card (in µs)
+} rfidStats_t;
 
-extern char gCurrentId[ID_STRING_SIZE];
+extern rfidStats_t gRfidStats;
+
+// RFID-gestures are mapped to virtual RFID-ids ("91"/"92" + 10 digits), so they can be assigned like normal RFID-tags
+constexpr uint8_t RFID_GESTURE_SEQUENCE = 91u; // card A followed by card B within rfidSequenceTimeout
+constexpr uint8_t RFID_GESTURE_HOLD = 92u; // card A held on the reader for rfidHoldTime
 
 #ifndef PAUSE_WHEN_RFID_REMOVED
 	#ifdef DONT_ACCEPT_SAME_RFID_TWICE // ignore feature silently if PAUSE_WHEN_RFID_REMOVED is active
@@ -30,4 +46,10 @@ void Rfid_Exit(void);
 void Rfid_TaskPause(void);
 void Rfid_TaskResume(void);
 void Rfid_WakeupCheck(void);
-void Rfid_PreferenceLookupHandler(void);
+void Rfid_DispatcherInit(void);
+const char *Rfid_GetReaderName(void);
+void Rfid_ResetStats(void);
+void Rfid_GestureId(char *_dst, const uint8_t _type, const char *_idA, const char *_idB);
+bool Rfid_SendId(QueueHandle_t queue, const char *id);
+void Rfid_GesturesRebuild(void);
+const char *Rfid_GetUnassignedGestureId(void);
@@ -7,104 +7,284 @@
 #include "Log.h"
 #include "MemX.h"
 #include "Mqtt.h"
+#include "Playlist.h"
 #include "Queues.h"
 #include "Rfid.h"
 #include "System.h"
+#include "TapTrace.h"
 #include "Web.h"
 #include "String.h"
 
-unsigned long Rfid_LastRfidCheckTimestamp = 0;
+#include <algorithm>
+#include <vector>
+
 char gCurrentId[ID_STRING_SIZE] = ""; // No crap here as otherwise it could be shown in GUI
 #ifdef DONT_ACCEPT_SAME_RFID_TWICE_ENABLE
 char gOldRfidTagId[ID_STRING_SIZE] = "X"; // Init with crap
 #endif
+rfidStats_t gRfidStats;
 
 // check if we have RFID-reader enabled
 #if defined(RFID_READER_TYPE_MFRC522_SPI) || defined(RFID_READER_TYPE_MFRC522_I2C) || defined(RFID_READER_TYPE_PN5180)
 	#define RFID_READER_ENABLED 1
 #endif
 
-// Tries to lookup RFID-tag-string in NVS and extracts parameter from it if found
-void Rfid_PreferenceLookupHandler(void) {
 #if defined(RFID_READER_ENABLED)
+static TaskHandle_t Rfid_DispatcherTaskHandle;
+static void Rfid_DispatcherTask(void *parameter);
+static void Rfid_Dispatch(QueueSetMemberHandle_t queue, const char *newId);
+static void Rfid_PreferenceLookupHandler(const char *newId);
+static bool Rfid_GestureAssigned(const char *gestureId);
+static void Rfid_GestureNotAssigned(const char *gestureId);
+#endif
+
+// Transition-table of assigned RFID-gestures: (type << 32 | hash), sorted for binary search.
+// Rebuilt whenever rfid-assignments change, so the dispatcher never has to scan NVS.
+static std::vector<uint64_t> Rfid_GestureTable;
+static portMUX_TYPE Rfid_GestureTableMux = portMUX_INITIALIZER_UNLOCKED;
+static char Rfid_UnassignedGestureId[ID_STRING_SIZE] = ""; // last gesture without assignment (shown in GUI)
+
+// FNV-1a: cheap and good enough to avoid collisions between a few hundred cards
+static uint32_t Rfid_GestureHash(const char *_idA, const char *_idB) {
+	uint32_t hash = 2166136261u;
+	for (const char *c = _idA; *c; c++) {
+		hash = (hash ^ (uint8_t) *c) * 16777619u;
+	}
+	if (_idB != nullptr) {
+		hash = (hash ^ (uint8_t) stringDelimiter[0]) * 16777619u;
+		for (const char *c = _idB; *c; c++) {
+			hash = (hash ^ (uint8_t) *c) * 16777619u;
+		}
+	}
+	return hash;
+}
+
+// Builds virtual RFID-id of a gesture (_dst needs ID_STRING_SIZE bytes). First digit-group > 255 => can't collide with a real card
+void Rfid_GestureId(char *_dst, const uint8_t _type, const char *_idA, const char *_idB) {
+	snprintf(_dst, ID_STRING_SIZE, "%02u%010lu", _type % 100u, (unsigned long) Rfid_GestureHash(_idA, _idB));
+}
+
+// Id-queues copy ID_STRING_SIZE bytes: shorter ids (button-ids, ids from NVS/MQTT) are padded, longer ones are cut
+bool Rfid_SendId(QueueHandle_t queue, const char *id) {
+	char item[ID_STRING_SIZE] = {0};
+	strncpy(item, id, sizeof(item) - 1u);
+	return xQueueSend(queue, item, 0) == pdPASS;
+}
+
+static bool Rfid_GestureTableCallback(const char *key, void *data) {
+	if (strlen(key) != CARD_ID_STR_SIZE - 1u || key[0] != '9' || (key[1] != '1' && key[1] != '2')) {
+		return true;
+	}
+	const uint64_t type = (key[1] == '1') ? RFID_GESTURE_SEQUENCE : RFID_GESTURE_HOLD;
+	((std::vector<uint64_t> *) data)->push_back((type << 32) | strtoul(key + 2, nullptr, 10));
+	return true;
+}
+
+// Has to be called after RFID-assignments were changed
+void Rfid_GesturesRebuild(void) {
+	std::vector<uint64_t> table;
+	listNVSKeys("rfidTags", &table, Rfid_GestureTableCallback);
+	std::sort(table.begin(), table.end());
+
+	portENTER_CRITICAL(&Rfid_GestureTableMux);
+	Rfid_GestureTable.swap(table);
+	portEXIT_CRITICAL(&Rfid_GestureTableMux);
+	Log_Printf(LOGLEVEL_DEBUG, rfidGesturesLoaded, (unsigned int) Rfid_GestureTable.size());
+}
+
+const char *Rfid_GetUnassignedGestureId(void) {
+	return Rfid_UnassignedGestureId;
+}
+
+// Starts task that handles RFID-tags (and button-ids) as soon as they're received
+void Rfid_DispatcherInit(void) {
+#if defined(RFID_READER_ENABLED)
+	Rfid_GesturesRebuild();
+	xTaskCreatePinnedToCore(
+		Rfid_DispatcherTask, /* Function to implement the task */
+		"rfidDispatch", /* Name of the task */
+		6000, /* Stack size in words */
+		NULL, /* Task input parameter */
+		1, /* Priority of the task */
+		&Rfid_DispatcherTaskHandle, /* Task handle. */
+		1 /* Core where the task should run */
+	);
+#endif
+}
+
+#if defined(RFID_READER_ENABLED)
+// Blocks until a RFID-tag or button-id is received, so it's not delayed by whatever loop() is busy with.
+// Same priority as loop(): audio-task isn't slowed down while a playlist is generated.
+static void Rfid_DispatcherTask(void *parameter) {
 	char newId[ID_STRING_SIZE];
-	char _file[255];
-	uint32_t _lastPlayPos = 0;
-	uint16_t _trackLastPlayed = 0;
-	uint32_t _playMode = 1;
-
-	BaseType_t newQueueReceived = xQueueReceive(gRfidCardQueue, &newId, 0) == pdPASS;
-	if(newQueueReceived != pdPASS) { // If no new card was read, try to read button-queue, just one queue at a time
-    	newQueueReceived = xQueueReceive(gButtonIdQueue, &newId, 0) == pdPASS;
+
+	for (;;) {
+		QueueSetMemberHandle_t queue = xQueueSelectFromSet(gIdQueueSet, portMAX_DELAY);
+		if (queue != NULL && xQueueReceive(queue, &newId, 0) == pdPASS) {
+			Cmd_Lock(); // lookup may start a playlist or run a command: not at the same time as loop() does
+			Rfid_Dispatch(queue, newId);
+			Cmd_Unlock();
+		}
 	}
+}
 
-	if (newQueueReceived) {
-		System_UpdateActivityTimer();
-		strncpy(gCurrentId, newId, ID_STRING_SIZE - 1);
-		Log_Printf(LOGLEVEL_INFO, "%s: %s", rfidTagReceived, gCurrentId);
-		Web_SendWebsocketData(0, 10); // Push new rfidTagId to all websocket-clients
-		String idStr = "-1";
-		if (gPrefsRfid.isKey(gCurrentId)) {
-			idStr = gPrefsRfid.getString(gCurrentId, "-1"); // Try to lookup rfidId in NVS
+// Handles an id received from one of the id-queues: single cards, gestures (only ids read from a card) and button-ids
+static void Rfid_Dispatch(QueueSetMemberHandle_t queue, const char *newId) {
+	static char lastCardId[ID_STRING_SIZE] = "";
+	static uint32_t lastCardTimestamp = 0;
+
+	if (queue != gRfidCardQueue) { // button-ids and injected RFID-ids are no part of gestures
+		Rfid_PreferenceLookupHandler(newId);
+		return;
+	}
+	if (strncmp(newId, "92", 2) == 0) { // hold-gesture from reader
+		if (Rfid_GestureAssigned(newId)) {
+			Log_Printf(LOGLEVEL_NOTICE, rfidGestureDetected, newId);
+			Rfid_PreferenceLookupHandler(newId);
+		} else {
+			Rfid_GestureNotAssigned(newId);
 		}
-		if (!idStr.compareTo("-1")) {
-			Log_Println(rfidTagUnknownInNvs, LOGLEVEL_ERROR);
-			System_IndicateError();
-			// allow to escape from bluetooth mode with an unknown card, switch back to normal mode
-			System_SetOperationMode(OPMODE_NORMAL);
+		return;
+	}
+
+	// card A followed by card B: A was already handled (single card doesn't wait for a possible sequence), B is replaced by the sequence
+	char sequenceId[ID_STRING_SIZE] = "";
+	if (*lastCardId && millis() - lastCardTimestamp < rfidSequenceTimeout) {
+		Rfid_GestureId(sequenceId, RFID_GESTURE_SEQUENCE, lastCardId, newId);
+		if (Rfid_GestureAssigned(sequenceId)) {
+			Log_Printf(LOGLEVEL_NOTICE, rfidGestureDetected, sequenceId);
+			*lastCardId = '\0';
+			Rfid_PreferenceLookupHandler(sequenceId);
 			return;
 		}
+	}
+	strncpy(lastCardId, newId, ID_STRING_SIZE - 1);
+	lastCardTimestamp = millis();
+	Rfid_PreferenceLookupHandler(newId);
+	if (*sequenceId) {
+		Rfid_GestureNotAssigned(sequenceId); // after the lookup, so it isn't replaced in GUI by the id of the second card
+	}
+}
 
-		char *token;
-		uint8_t i = 1;
-		token = strtok((char *) idStr.c_str(), stringDelimiter);
-		while (token != NULL) { // Try to extract data from string after lookup
-			if (i == 1) {
-				strncpy(_file, token, sizeof(_file) / sizeof(_file[0]));
-			} else if (i == 2) {
-				_lastPlayPos = strtoul(token, NULL, 10);
-			} else if (i == 3) {
-				_playMode = strtoul(token, NULL, 10);
-			} else if (i == 4) {
-				_trackLastPlayed = strtoul(token, NULL, 10);
-			}
-			i++;
-			token = strtok(NULL, stringDelimiter);
-		}
+// Unassigned gestures are shown in GUI (without becoming gCurrentId, as playback isn't affected), so they can be assigned
+static void Rfid_GestureNotAssigned(const char *gestureId) {
+	Log_Printf(LOGLEVEL_INFO, rfidGestureNotAssigned, gestureId);
+	strncpy(Rfid_UnassignedGestureId, gestureId, ID_STRING_SIZE - 1);
+	Web_SendWebsocketData(0, 11);
+}
 
-		if (i != 5) {
-			Log_Println(errorOccuredNvs, LOGLEVEL_ERROR);
-			System_IndicateError();
+// Binary search in transition-table (no NVS-access)
+static bool Rfid_GestureAssigned(const char *gestureId) {
+	const uint64_t type = (gestureId[1] == '1') ? RFID_GESTURE_SEQUENCE : RFID_GESTURE_HOLD;
+	const uint64_t entry = (type << 32) | strtoul(gestureId + 2, nullptr, 10);
+
+	portENTER_CRITICAL(&Rfid_GestureTableMux);
+	const bool found = std::binary_search(Rfid_GestureTable.begin(), Rfid_GestureTable.end(), entry);
+	portEXIT_CRITICAL(&Rfid_GestureTableMux);
+	return found;
+}
+
+// Tries to lookup RFID-tag-string in NVS and extracts parameter from it if found
+static void Rfid_PreferenceLookupHandler(const char *newId) {
+	rfidEntry_t rfidEntry;
+
+	TapTrace_Mark(TAP_TRACE_LOOKUP);
+	System_UpdateActivityTimer();
+	strncpy(gCurrentId, newId, ID_STRING_SIZE - 1);
+	Log_Printf(LOGLEVEL_INFO, "%s: %s", rfidTagReceived, gCurrentId);
+	Web_SendWebsocketData(0, 10); // Push new rfidTagId to all websocket-clients
+	String idStr = "-1";
+	if (gPrefsRfid.isKey(gCurrentId)) {
+		idStr = gPrefsRfid.getString(gCurrentId, "-1"); // Try to lookup rfidId in NVS
+	}
+	if (!idStr.compareTo("-1")) {
+		Log_Println(rfidTagUnknownInNvs, LOGLEVEL_ERROR);
+		TapTrace_Abort();
+		System_IndicateError();
+		// allow to escape from bluetooth mode with an unknown card, switch back to normal mode
+		System_SetOperationMode(OPMODE_NORMAL);
+		return;
+	}
+
+	if (!Playlist_ParseRfidEntry(idStr.c_str(), stringDelimiter[0], rfidEntry)) {
+		Log_Println(errorOccuredNvs, LOGLEVEL_ERROR);
+		TapTrace_Abort();
+		System_IndicateError();
+	} else {
+		// Only pass file to queue if all four items were found
+		if (rfidEntry.playMode >= 100) {
+			// Modification-cards can change some settings (e.g. introducing track-looping or sleep after track/playlist).
+			TapTrace_Abort();
+			Cmd_Action(rfidEntry.playMode);
 		} else {
-			// Only pass file to queue if strtok revealed 3 items
-			if (_playMode >= 100) {
-				// Modification-cards can change some settings (e.g. introducing track-looping or sleep after track/playlist).
-				Cmd_Action(_playMode);
+#ifdef DONT_ACCEPT_SAME_RFID_TWICE_ENABLE
+			if (strncmp(gCurrentId, gOldRfidTagId, ID_STRING_SIZE - 1) == 0) {
+				Log_Printf(LOGLEVEL_ERROR, dontAccepctSameRfid, gCurrentId);
+				TapTrace_Abort();
+				// System_IndicateError(); // Enable to have shown error @neopixel every time
+				return;
 			} else {
-	#ifdef DONT_ACCEPT_SAME_RFID_TWICE_ENABLE
-				if (strncmp(gCurrentId, gOldRfidTagId, ID_STRING_SIZE - 1) == 0) {
-					Log_Printf(LOGLEVEL_ERROR, dontAccepctSameRfid, gCurrentId);
-					// System_IndicateError(); // Enable to have shown error @neopixel every time
-					return;
-				} else {
-					strncpy(gOldRfidTagId, gCurrentId, ID_STRING_SIZE - 1);
-				}
-	#endif
-	#ifdef MQTT_ENABLE
-				publishMqtt(topicRfidState, gCurrentId, false);
-	#endif
-
-	#ifdef BLUETOOTH_ENABLE
-				// if music rfid was read, go back to normal mode
-				if (System_GetOperationMode() == OPMODE_BLUETOOTH_SINK) {
-					System_SetOperationMode(OPMODE_NORMAL);
-				}
-	#endif
-
-				AudioPlayer_TrackQueueDispatcher(_file, _lastPlayPos, _playMode, _trackLastPlayed);
+				strncpy(gOldRfidTagId, gCurrentId, ID_STRING_SIZE - 1);
 			}
+#endif
+#ifdef MQTT_ENABLE
+			publishMqtt(topicRfidState, gCurrentId, false);
+#endif
+
+#ifdef BLUETOOTH_ENABLE
+			// if music rfid was read, go back to normal mode
+			if (System_GetOperationMode() == OPMODE_BLUETOOTH_SINK) {
+				System_SetOperationMode(OPMODE_NORMAL);
+			}
+#endif
+
+			AudioPlayer_TrackQueueDispatcher(rfidEntry.file, rfidEntry.lastPlayPos, rfidEntry.playMode, rfidEntry.trackLastPlayed);
 		}
 	}
+}
+#endif
+
+const char *Rfid_GetReaderName(void) {
+#if defined(RFID_READER_TYPE_PN5180)
+	return "PN5180";
+#elif defined(RFID_READER_TYPE_MFRC522_SPI)
+	return "MFRC522 (SPI)";
+#elif defined(RFID_READER_TYPE_MFRC522_I2C)
+	return "MFRC522 (I2C)";
+#else
+	return "none";
+#endif
+}
+
+void Rfid_ResetStats(void) {
+	gRfidStats.scans = 0;
+	gRfidStats.readErrors = 0;
+	gRfidStats.cardsDetected = 0;
+	gRfidStats.removals = 0;
+	gRfidStats.flaps = 0;
+	gRfidStats.since = millis();
+	gRfidStats.readTimeHist.reset();
+	gRfidStats.cardReadTimeHist.reset();
+}
+
+// Publishes reader statistics every 5 minutes (if reader was active)
+void Rfid_Cyclic(void) {
+#if defined(RFID_READER_ENABLED) && defined(MQTT_ENABLE)
+	static uint32_t lastStatsTimestamp = 0;
+	static uint32_t lastScans = 0;
+
+	if ((millis() - lastStatsTimestamp < 300000) || (gRfidStats.scans == lastScans)) {
+		return;
+	}
+	lastStatsTimestamp = millis();
+	lastScans = gRfidStats.scans;
+
+	const uint32_t duration = (millis() - gRfidStats.since) / 1000u;
+	char buf[200];
+	snprintf(buf, sizeof(buf), "{\"reader\":\"%s\",\"scans\":%u,\"scansPerMin\":%u,\"readErrors\":%u,\"cards\":%u,\"removals\":%u,\"flaps\":%u,\"readP50\":%u,\"readP99\":%u}",
+		Rfid_GetReaderName(), gRfidStats.scans, duration ? (uint32_t) ((uint64_t) gRfidStats.scans * 60u / duration) : 0u, gRfidStats.readErrors, gRfidStats.cardsDetected, gRfidStats.removals, gRfidStats.flaps,
+		gRfidStats.readTimeHist.percentile(50), gRfidStats.readTimeHist.percentile(99));
+	publishMqtt(topicRfidStatsState, buf, false);
 #endif
 }
 
@@ -7,6 +7,7 @@
 #include "MemX.h"
 #include "Queues.h"
 #include "Rfid.h"
+#include "RfidReader.h"
 #include "System.h"
 
 #include <esp_task_wdt.h>
@@ -22,7 +23,6 @@
 		#include <MFRC522_I2C.h>
 	#endif
 
-extern unsigned long Rfid_LastRfidCheckTimestamp;
 TaskHandle_t rfidTaskHandle;
 static void Rfid_Task(void *parameter);
 
@@ -64,130 +64,99 @@ void Rfid_Init(void) {
 	#endif
 }
 
-void Rfid_Task(void *parameter) {
-	#ifdef PAUSE_WHEN_RFID_REMOVED
-	uint8_t control = 0x00;
-	#endif
-
-	for (;;) {
-		if (RFID_SCAN_INTERVAL / 2 >= 20) {
-			vTaskDelay(portTICK_PERIOD_MS * (RFID_SCAN_INTERVAL / 2));
-		} else {
-			vTaskDelay(portTICK_PERIOD_MS * 20);
-		}
-		byte cardId[cardIdSize];
-		String cardIdString;
+// Driver for RfidReader. PICC_IsNewCardPresent() only finds cards that aren't halted yet, so a card is read once.
+// If PAUSE_WHEN_RFID_REMOVED is active, the card isn't halted and its presence is checked until it's removed.
+class RfidMfrc522Driver {
+public:
+	rfidPollResult_t poll(uint8_t *uid) {
 	#ifdef PAUSE_WHEN_RFID_REMOVED
-		byte lastValidcardId[cardIdSize];
-		bool sameCardReapplied = false;
-	#endif
-		if ((millis() - Rfid_LastRfidCheckTimestamp) >= RFID_SCAN_INTERVAL) {
-			// Log_Printf(LOGLEVEL_DEBUG, "%u", uxTaskGetStackHighWaterMark(NULL));
-
-			Rfid_LastRfidCheckTimestamp = millis();
-			// Reset the loop if no new card is present on the sensor/reader. This saves the entire process when idle.
-
-			if (!mfrc522.PICC_IsNewCardPresent()) {
-				continue;
-			}
-
-			// Select one of the cards
-			if (!mfrc522.PICC_ReadCardSerial()) {
-				continue;
+		if (cardActive) {
+			if (cardStillPresent()) {
+				memcpy(uid, mfrc522.uid.uidByte, cardIdSize);
+				return RFID_POLL_CARD;
 			}
-
-	#ifndef PAUSE_WHEN_RFID_REMOVED
+			cardActive = false;
 			mfrc522.PICC_HaltA();
 			mfrc522.PCD_StopCrypto1();
+			return RFID_POLL_NO_CARD;
+		}
 	#endif
+		// Reset the loop if no new card is present on the sensor/reader. This saves the entire process when idle.
+		if (!mfrc522.PICC_IsNewCardPresent()) {
+			return RFID_POLL_NO_CARD;
+		}
 
-			memcpy(cardId, mfrc522.uid.uidByte, cardIdSize);
+		// Select one of the cards
+		if (!mfrc522.PICC_ReadCardSerial()) {
+			return RFID_POLL_ERROR;
+		}
+		memcpy(uid, mfrc522.uid.uidByte, cardIdSize);
 
-	#ifdef HALLEFFECT_SENSOR_ENABLE
-			cardId[cardIdSize - 1] = cardId[cardIdSize - 1] + gHallEffectSensor.waitForState(HallEffectWaitMS);
+	#ifdef PAUSE_WHEN_RFID_REMOVED
+		cardActive = true;
+	#else
+		mfrc522.PICC_HaltA();
+		mfrc522.PCD_StopCrypto1();
 	#endif
+		return RFID_POLL_CARD;
+	}
 
+	uint32_t pollInterval(void) {
 	#ifdef PAUSE_WHEN_RFID_REMOVED
-			if (memcmp((const void *) lastValidcardId, (const void *) cardId, sizeof(cardId)) == 0) {
-				sameCardReapplied = true;
-			}
+		if (cardActive) {
+			return (RFID_SCAN_INTERVAL / 2 >= 20) ? (RFID_SCAN_INTERVAL / 2) : 20;
+		}
 	#endif
+		return (RFID_SCAN_INTERVAL >= 20) ? RFID_SCAN_INTERVAL : 20;
+	}
 
-			String hexString;
-			for (uint8_t i = 0u; i < cardIdSize; i++) {
-				char str[4];
-				snprintf(str, sizeof(str), "%02x%c", cardId[i], (i < cardIdSize - 1u) ? '-' : ' ');
-				hexString += str;
-			}
-			Log_Printf(LOGLEVEL_NOTICE, rfidTagDetected, hexString.c_str());
-
-			for (uint8_t i = 0u; i < cardIdSize; i++) {
-				char num[4];
-				snprintf(num, sizeof(num), "%03d", cardId[i]);
-				cardIdString += num;
-			}
+	uint32_t debounceTime(void) {
+		return 0u; // removal is detected by cardStillPresent()
+	}
 
+	bool detectsRemoval(void) {
 	#ifdef PAUSE_WHEN_RFID_REMOVED
-		#ifdef ACCEPT_SAME_RFID_AFTER_TRACK_END
-			if (!sameCardReapplied || gPlayProperties.trackFinished || gPlayProperties.playlistFinished) { // Don't allow to send card to queue if it's the same card again if track or playlist is unfnished
-		#else
-			if (!sameCardReapplied) { // Don't allow to send card to queue if it's the same card again...
-		#endif
-				xQueueSend(gRfidCardQueue, cardIdString.c_str(), 0);
-			} else {
-				// If pause-button was pressed while card was not applied, playback could be active. If so: don't pause when card is reapplied again as the desired functionality would be reversed in this case.
-				if (gPlayProperties.pausePlay && System_GetOperationMode() != OPMODE_BLUETOOTH_SINK) {
-					AudioPlayer_TrackControlToQueueSender(PAUSEPLAY); // ... play/pause instead (but not for BT)
-				}
-			}
-			memcpy(lastValidcardId, mfrc522.uid.uidByte, cardIdSize);
+		return true;
 	#else
-			xQueueSend(gRfidCardQueue, cardIdString.c_str(), 0); // If PAUSE_WHEN_RFID_REMOVED isn't active, every card-apply leads to new playlist-generation
+		return false; // card is halted after reading
 	#endif
+	}
 
+	const char *cardType(void) {
+		return "ISO-14443";
+	}
+
+private:
 	#ifdef PAUSE_WHEN_RFID_REMOVED
-			// https://github.com/miguelbalboa/rfid/issues/188; voodoo! :-)
-			while (true) {
-				if (RFID_SCAN_INTERVAL / 2 >= 20) {
-					vTaskDelay(portTICK_PERIOD_MS * (RFID_SCAN_INTERVAL / 2));
-				} else {
-					vTaskDelay(portTICK_PERIOD_MS * 20);
-				}
-				control = 0;
-				for (uint8_t i = 0u; i < 3; i++) {
-					if (!mfrc522.PICC_IsNewCardPresent()) {
-						if (mfrc522.PICC_ReadCardSerial()) {
-							control |= 0x16;
-						}
-						if (mfrc522.PICC_ReadCardSerial()) {
-							control |= 0x16;
-						}
-						control += 0x1;
-					}
-					control += 0x4;
-				}
+	bool cardActive = false;
 
-				if (control == 13 || control == 14) {
-					// card is still there
-				} else {
-					break;
+	// https://github.com/miguelbalboa/rfid/issues/188; voodoo! :-)
+	bool cardStillPresent(void) {
+		uint8_t control = 0x00;
+		for (uint8_t i = 0u; i < 3; i++) {
+			if (!mfrc522.PICC_IsNewCardPresent()) {
+				if (mfrc522.PICC_ReadCardSerial()) {
+					control |= 0x16;
 				}
+				if (mfrc522.PICC_ReadCardSerial()) {
+					control |= 0x16;
+				}
+				control += 0x1;
 			}
-
-			Log_Println(rfidTagRemoved, LOGLEVEL_NOTICE);
-			if (!gPlayProperties.pausePlay && System_GetOperationMode() != OPMODE_BLUETOOTH_SINK) {
-				AudioPlayer_TrackControlToQueueSender(PAUSEPLAY);
-				Log_Println(rfidTagReapplied, LOGLEVEL_NOTICE);
-			}
-			mfrc522.PICC_HaltA();
-			mfrc522.PCD_StopCrypto1();
-	#endif
+			control += 0x4;
 		}
+		return (control == 13 || control == 14);
 	}
-}
+	#endif
+};
+
+void Rfid_Task(void *parameter) {
+	static RfidReader<RfidMfrc522Driver> reader;
 
-void Rfid_Cyclic(void) {
-	// Not necessary as cyclic stuff performed by task Rfid_Task()
+	for (;;) {
+		vTaskDelay(portTICK_PERIOD_MS * reader.pollInterval());
+		reader.cycle();
+	}
 }
 
 void Rfid_Exit(void) {
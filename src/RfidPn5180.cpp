@@ -8,6 +8,7 @@
 #include "Port.h"
 #include "Queues.h"
 #include "Rfid.h"
+#include "RfidReader.h"
 #include "System.h"
 
 #include <Wire.h>
@@ -22,6 +23,7 @@
 #endif
 
 #define RFID_PN5180_STATE_INIT 0u
+#define RFID_PN5180_STATE_LPCD 50u // idle: waiting for low power card detection (IRQ)
 
 #define RFID_PN5180_NFC14443_STATE_RESET	1u
 #define RFID_PN5180_NFC14443_STATE_READCARD 2u
@@ -34,7 +36,14 @@
 #define RFID_PN5180_NFC15693_STATE_GETINVENTORY_PRIVACY 7u
 #define RFID_PN5180_NFC15693_STATE_ACTIVE				100u
 
-extern unsigned long Rfid_LastRfidCheckTimestamp;
+// Adaptive polling: poll fast while a card is applied or was seen lately, back off exponentially when idle
+constexpr uint32_t rfidPn5180FastPollInterval = 10u; // ms between two steps of the state machine (fast)
+constexpr uint32_t rfidPn5180MaxPollInterval = 40u; // ms between two steps of the state machine (idle), doubled after every cycle without card
+constexpr uint32_t rfidPn5180FastPollPeriod = 5000u; // ms to keep polling fast after a card was seen/removed
+#ifdef PN5180_ENABLE_LPCD
+constexpr uint32_t rfidPn5180LpcdIdleTimeout = 30000u; // ms without card until low power card detection is used while running
+constexpr uint16_t rfidPn5180LpcdWakeupCounter = 0x96; // LPCD-check interval while running (~150 ms)
+#endif
 
 #if (defined(PORT_EXPANDER_ENABLE) && (RFID_IRQ > 99))
 extern TwoWire i2cBusTwo;
@@ -102,47 +111,16 @@ void Rfid_Init(void) {
 	);
 }
 
-void Rfid_Cyclic(void) {
-	// Not necessary as cyclic stuff performed by task Rfid_Task()
-}
+// Driver for RfidReader: state machine cycling through ISO-14443 and ISO-15693 (incl. privacy-mode) detection.
+// Poll interval adapts to activity, protocol of the last card is checked first.
+class RfidPn5180Driver {
+public:
+	RfidPn5180Driver()
+		: nfc14443(RFID_CS, RFID_BUSY, RFID_RST)
+		, nfc15693(RFID_CS, RFID_BUSY, RFID_RST) { }
 
-void Rfid_Task(void *parameter) {
-	static PN5180ISO14443 nfc14443(RFID_CS, RFID_BUSY, RFID_RST);
-	static PN5180ISO15693 nfc15693(RFID_CS, RFID_BUSY, RFID_RST);
-	uint32_t lastTimeDetected14443 = 0;
-	uint32_t lastTimeDetected15693 = 0;
-	#ifdef PAUSE_WHEN_RFID_REMOVED
-	byte lastValidcardId[cardIdSize];
-	bool cardAppliedCurrentRun = false;
-	bool cardAppliedLastRun = false;
-	#endif
-	uint8_t stateMachine = RFID_PN5180_STATE_INIT;
-	static byte cardId[cardIdSize], lastCardId[cardIdSize];
-	uint8_t uid[10];
-	bool showDisablePrivacyNotification = true;
-
-	// wait until queues are created
-	while (gRfidCardQueue == NULL) {
-		Log_Println(waitingForTaskQueues, LOGLEVEL_DEBUG);
-		vTaskDelay(50);
-	}
-
-	for (;;) {
-		vTaskDelay(portTICK_PERIOD_MS * 10u);
-	#ifdef PN5180_ENABLE_LPCD
-		if (Rfid_GetLpcdShutdownStatus()) {
-			Rfid_EnableLpcd();
-			Rfid_SetLpcdShutdownStatus(false); // give feedback that execution is complete
-			while (true) {
-				vTaskDelay(portTICK_PERIOD_MS * 100u); // there's no way back if shutdown was initiated
-			}
-		}
-	#endif
-		String cardIdString;
-		bool cardReceived = false;
-	#ifdef PAUSE_WHEN_RFID_REMOVED
-		bool sameCardReapplied = false;
-	#endif
+	rfidPollResult_t poll(uint8_t *uid) {
+		rfidPollResult_t result = RFID_POLL_PENDING;
 
 		if (RFID_PN5180_STATE_INIT == stateMachine) {
 			nfc14443.begin();
@@ -151,36 +129,44 @@ void Rfid_Task(void *parameter) {
 			uint8_t firmwareVersion[2];
 			nfc14443.readEEprom(FIRMWARE_VERSION, firmwareVersion, sizeof(firmwareVersion));
 			Log_Printf(LOGLEVEL_DEBUG, "PN5180 firmware version=%d.%d", firmwareVersion[1], firmwareVersion[0]);
+	#ifdef PN5180_ENABLE_LPCD
+			// PN5180 firmware < 4.0 has several bugs preventing the LPCD mode
+			if (firmwareVersion[1] >= 4) {
+				uint8_t irqConfig = 0b0000000; // Set IRQ active low + clear IRQ-register
+				nfc14443.writeEEprom(IRQ_PIN_CONFIG, &irqConfig, 1);
+				nfc14443.prepareLPCD();
+				lpcdSupported = true;
+			}
+	#endif
 
 			// activate RF field
 			delay(4u);
 			Log_Println(rfidScannerReady, LOGLEVEL_DEBUG);
+	#ifdef PN5180_ENABLE_LPCD
+		} else if (RFID_PN5180_STATE_LPCD == stateMachine) {
+			// PN5180 stays in LPCD until RF-field changes; IRQ is cleared by reset() of the next state
+			if (Port_Read(RFID_IRQ) == LOW) {
+				Log_Println(rfidLpcdWakeup, LOGLEVEL_DEBUG);
+				interval = rfidPn5180FastPollInterval;
+				stateMachine = lastProtocolState;
+			}
+			return RFID_POLL_PENDING;
+	#endif
 
 			// 1. check for an ISO-14443 card
 		} else if (RFID_PN5180_NFC14443_STATE_RESET == stateMachine) {
 			nfc14443.reset();
-			// Log_Printf(LOGLEVEL_DEBUG, "%u", uxTaskGetStackHighWaterMark(NULL));
 		} else if (RFID_PN5180_NFC14443_STATE_READCARD == stateMachine) {
-
+			debounce = 1000u;
 			if (nfc14443.readCardSerial(uid) >= 4) {
-				cardReceived = true;
+				result = RFID_POLL_CARD;
 				stateMachine = RFID_PN5180_NFC14443_STATE_ACTIVE;
 				lastTimeDetected14443 = millis();
-	#ifdef PAUSE_WHEN_RFID_REMOVED
-				cardAppliedCurrentRun = true;
-	#endif
 			} else {
-				// Reset to dummy-value if no card is there
-				// Necessary to differentiate between "card is still applied" and "card is re-applied again after removal"
+				result = RFID_POLL_NO_CARD;
 				// lastTimeDetected14443 is used to prevent "new card detection with old card" with single events where no card was detected
-				if (!lastTimeDetected14443 || (millis() - lastTimeDetected14443 >= 1000)) {
+				if (!lastTimeDetected14443 || (millis() - lastTimeDetected14443 >= debounce)) {
 					lastTimeDetected14443 = 0;
-	#ifdef PAUSE_WHEN_RFID_REMOVED
-					cardAppliedCurrentRun = false;
-	#endif
-					for (uint8_t i = 0; i < cardIdSize; i++) {
-						lastCardId[i] = 0;
-					}
 				} else {
 					stateMachine = RFID_PN5180_NFC14443_STATE_ACTIVE; // Still consider first event as "active"
 				}
@@ -210,113 +196,116 @@ void Rfid_Task(void *parameter) {
 				}
 			}
 		} else if ((RFID_PN5180_NFC15693_STATE_GETINVENTORY == stateMachine) || (RFID_PN5180_NFC15693_STATE_GETINVENTORY_PRIVACY == stateMachine)) {
+			debounce = 400u;
 			// try to read ISO15693 inventory
 			ISO15693ErrorCode rc = nfc15693.getInventory(uid);
 			if (rc == ISO15693_EC_OK) {
-				cardReceived = true;
+				result = RFID_POLL_CARD;
 				stateMachine = RFID_PN5180_NFC15693_STATE_ACTIVE;
 				lastTimeDetected15693 = millis();
-	#ifdef PAUSE_WHEN_RFID_REMOVED
-				cardAppliedCurrentRun = true;
-	#endif
+				showDisablePrivacyNotification = true;
 			} else {
+				result = (rc == EC_NO_CARD) ? RFID_POLL_NO_CARD : RFID_POLL_ERROR;
 				// lastTimeDetected15693 is used to prevent "new card detection with old card" with single events where no card was detected
-				if (!lastTimeDetected15693 || (millis() - lastTimeDetected15693 >= 400)) {
+				if (!lastTimeDetected15693 || (millis() - lastTimeDetected15693 >= debounce)) {
 					lastTimeDetected15693 = 0;
-	#ifdef PAUSE_WHEN_RFID_REMOVED
-					cardAppliedCurrentRun = false;
-	#endif
-					for (uint8_t i = 0; i < cardIdSize; i++) {
-						lastCardId[i] = 0;
-					}
 				} else {
 					stateMachine = RFID_PN5180_NFC15693_STATE_ACTIVE;
 				}
 			}
 		}
 
-	#ifdef PAUSE_WHEN_RFID_REMOVED
-		if (!cardAppliedCurrentRun && cardAppliedLastRun && !gPlayProperties.pausePlay && System_GetOperationMode() != OPMODE_BLUETOOTH_SINK) { // Card removed => pause
-			AudioPlayer_TrackControlToQueueSender(PAUSEPLAY);
-			Log_Println(rfidTagRemoved, LOGLEVEL_NOTICE);
-		}
-		cardAppliedLastRun = cardAppliedCurrentRun;
-	#endif
+		nextState();
+		return result;
+	}
 
-		// send card to queue
-		if (cardReceived) {
-			memcpy(cardId, uid, cardIdSize);
-
-			// check for different card id
-			if (memcmp((const void *) cardId, (const void *) lastCardId, sizeof(cardId)) == 0) {
-				// reset state machine
-				if (RFID_PN5180_NFC14443_STATE_ACTIVE == stateMachine) {
-					stateMachine = RFID_PN5180_NFC14443_STATE_RESET;
-					continue;
-				} else if (RFID_PN5180_NFC15693_STATE_ACTIVE == stateMachine) {
-					stateMachine = RFID_PN5180_NFC15693_STATE_RESET;
-					continue;
-				}
-			}
+	uint32_t pollInterval(void) {
+		return interval;
+	}
 
-			memcpy(lastCardId, cardId, cardIdSize);
-			showDisablePrivacyNotification = true;
+	uint32_t debounceTime(void) {
+		return debounce;
+	}
 
-	#ifdef HALLEFFECT_SENSOR_ENABLE
-			cardId[cardIdSize - 1] = cardId[cardIdSize - 1] + gHallEffectSensor.waitForState(HallEffectWaitMS);
-	#endif
+	bool detectsRemoval(void) {
+		return true;
+	}
 
-	#ifdef PAUSE_WHEN_RFID_REMOVED
-			if (memcmp((const void *) lastValidcardId, (const void *) cardId, sizeof(cardId)) == 0) {
-				sameCardReapplied = true;
-			}
+	const char *cardType(void) {
+		return (RFID_PN5180_NFC14443_STATE_RESET == lastProtocolState) ? "ISO-14443" : "ISO-15693";
+	}
+
+private:
+	PN5180ISO14443 nfc14443;
+	PN5180ISO15693 nfc15693;
+	uint8_t stateMachine = RFID_PN5180_STATE_INIT;
+	uint32_t lastTimeDetected14443 = 0;
+	uint32_t lastTimeDetected15693 = 0;
+	uint32_t debounce = 1000u;
+	bool showDisablePrivacyNotification = true;
+	uint32_t interval = rfidPn5180FastPollInterval;
+	uint32_t lastCardActivity = 0; // last time a card was applied
+	uint8_t lastProtocolState = RFID_PN5180_NFC14443_STATE_RESET; // protocol of the last card is checked first
+	#ifdef PN5180_ENABLE_LPCD
+	bool lpcdSupported = false; // needs PN5180 firmware >= 4.0
 	#endif
 
-			String hexString;
-			for (uint8_t i = 0u; i < cardIdSize; i++) {
-				char str[4];
-				snprintf(str, sizeof(str), "%02x%c", cardId[i], (i < cardIdSize - 1u) ? '-' : ' ');
-				hexString += str;
-			}
-			Log_Printf(LOGLEVEL_NOTICE, rfidTagDetected, hexString.c_str());
-			Log_Printf(LOGLEVEL_NOTICE, "Card type: %s", (RFID_PN5180_NFC14443_STATE_ACTIVE == stateMachine) ? "ISO-14443" : "ISO-15693");
+	void nextState(void) {
+		if ((RFID_PN5180_NFC14443_STATE_ACTIVE == stateMachine) || (RFID_PN5180_NFC15693_STATE_ACTIVE == stateMachine)) {
+			// card is (still) applied: poll fast to recognize removal or next card quickly and bypass other protocol (performance)
+			lastCardActivity = millis();
+			interval = rfidPn5180FastPollInterval;
+			lastProtocolState = (RFID_PN5180_NFC14443_STATE_ACTIVE == stateMachine) ? RFID_PN5180_NFC14443_STATE_RESET : RFID_PN5180_NFC15693_STATE_RESET;
+			stateMachine = lastProtocolState;
+			return;
+		}
 
-			for (uint8_t i = 0u; i < cardIdSize; i++) {
-				char num[4];
-				snprintf(num, sizeof(num), "%03d", cardId[i]);
-				cardIdString += num;
+		stateMachine++;
+		if (stateMachine > RFID_PN5180_NFC15693_STATE_GETINVENTORY_PRIVACY) {
+			stateMachine = RFID_PN5180_NFC14443_STATE_RESET;
+		}
+		if (stateMachine == lastProtocolState) { // complete cycle without card
+			if (millis() - lastCardActivity >= rfidPn5180FastPollPeriod) {
+				interval = std::min<uint32_t>(interval * 2u, rfidPn5180MaxPollInterval);
 			}
-
-	#ifdef PAUSE_WHEN_RFID_REMOVED
-		#ifdef ACCEPT_SAME_RFID_AFTER_TRACK_END
-			if (!sameCardReapplied || gPlayProperties.trackFinished || gPlayProperties.playlistFinished) { // Don't allow to send card to queue if it's the same card again if track or playlist is unfnished
-		#else
-			if (!sameCardReapplied) { // Don't allow to send card to queue if it's the same card again...
-		#endif
-				xQueueSend(gRfidCardQueue, cardIdString.c_str(), 0);
-			} else {
-				// If pause-button was pressed while card was not applied, playback could be active. If so: don't pause when card is reapplied again as the desired functionality would be reversed in this case.
-				if (gPlayProperties.pausePlay && System_GetOperationMode() != OPMODE_BLUETOOTH_SINK) {
-					AudioPlayer_TrackControlToQueueSender(PAUSEPLAY); // ... play/pause instead
-					Log_Println(rfidTagReapplied, LOGLEVEL_NOTICE);
+	#ifdef PN5180_ENABLE_LPCD
+			if (lpcdSupported && (millis() - lastCardActivity >= rfidPn5180LpcdIdleTimeout)) {
+				nfc14443.reset();
+				if (nfc14443.switchToLPCD(rfidPn5180LpcdWakeupCounter)) {
+					Log_Println(rfidLpcdIdle, LOGLEVEL_DEBUG);
+					stateMachine = RFID_PN5180_STATE_LPCD;
+					interval = rfidPn5180MaxPollInterval;
+				} else {
+					Log_Println("switchToLPCD failed", LOGLEVEL_ERROR);
+					lpcdSupported = false;
 				}
 			}
-			memcpy(lastValidcardId, uid, cardIdSize);
-	#else
-			xQueueSend(gRfidCardQueue, cardIdString.c_str(), 0); // If PAUSE_WHEN_RFID_REMOVED isn't active, every card-apply leads to new playlist-generation
 	#endif
 		}
+	}
+};
 
-		if (RFID_PN5180_NFC14443_STATE_ACTIVE == stateMachine) { // If 14443 is active, bypass 15693 as next check (performance)
-			stateMachine = RFID_PN5180_NFC14443_STATE_RESET;
-		} else if (RFID_PN5180_NFC15693_STATE_ACTIVE == stateMachine) { // If 15693 is active, bypass 14443 as next check (performance)
-			stateMachine = RFID_PN5180_NFC15693_STATE_RESET;
-		} else {
-			stateMachine++;
-			if (stateMachine > RFID_PN5180_NFC15693_STATE_GETINVENTORY_PRIVACY) {
-				stateMachine = RFID_PN5180_NFC14443_STATE_RESET;
+void Rfid_Task(void *parameter) {
+	static RfidReader<RfidPn5180Driver> reader;
+
+	// wait until queues are created
+	while (gRfidCardQueue == NULL) {
+		Log_Println(waitingForTaskQueues, LOGLEVEL_DEBUG);
+		vTaskDelay(50);
+	}
+
+	for (;;) {
+		vTaskDelay(portTICK_PERIOD_MS * reader.pollInterval());
+	#ifdef PN5180_ENABLE_LPCD
+		if (Rfid_GetLpcdShutdownStatus()) {
+			Rfid_EnableLpcd();
+			Rfid_SetLpcdShutdownStatus(false); // give feedback that execution is complete
+			while (true) {
+				vTaskDelay(portTICK_PERIOD_MS * 100u); // there's no way back if shutdown was initiated
 			}
 		}
+	#endif
+		reader.cycle();
 	}
 }
 
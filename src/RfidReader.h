@@ -0,0 +1,160 @@
+#pragma once
+
+#include "AudioPlayer.h"
+#include "HallEffectSensor.h"
+#include "Log.h"
+#include "Queues.h"
+#include "Rfid.h"
+#include "System.h"
+#include "TapTrace.h"
+
+// Result of a single poll-step of a reader-driver
+enum rfidPollResult_t : uint8_t {
+	RFID_POLL_PENDING = 0, // no read attempt in this step (e.g. reset, rf-setup)
+	RFID_POLL_NO_CARD, // read attempt: no card found
+	RFID_POLL_CARD, // read attempt: card found, uid is valid
+	RFID_POLL_ERROR // read attempt: card (maybe) present but reading failed
+};
+
+/* State machine shared by all RFID-readers: debounce, removal detection, statistics and hand-off to gRfidCardQueue.
+   The reader-specific part is provided by a driver-class (selected at compile time, no virtual calls):
+
+	class Driver {
+		rfidPollResult_t poll(uint8_t *uid); // performs one step of reading (uid needs at least cardIdSize bytes)
+		uint32_t pollInterval(void); // delay (in ms) until next poll()
+		uint32_t debounceTime(void); // time (in ms) a card can be missed in poll() and is still considered as applied
+		bool detectsRemoval(void); // false: card is halted after reading and not seen again until it's re-applied (no removal-detection)
+		const char *cardType(void); // type of the card found in last poll()
+	};
+*/
+template <class Driver>
+class RfidReader {
+public:
+	Driver driver;
+
+	uint32_t pollInterval(void) {
+		return driver.pollInterval();
+	}
+
+	void cycle(void) {
+		uint8_t uid[10];
+
+		const uint32_t readStart = micros();
+		const rfidPollResult_t result = driver.poll(uid);
+		if (result == RFID_POLL_PENDING) {
+			return;
+		}
+		const uint32_t readTime = micros() - readStart;
+		gRfidStats.scans++;
+		gRfidStats.readTimeHist.add(readTime);
+
+		if (result == RFID_POLL_CARD) {
+			gRfidStats.cardReadTimeHist.add(readTime);
+			lastTimeDetected = millis();
+			cardReceived(uid);
+			checkHold();
+			return;
+		}
+
+		if (result == RFID_POLL_ERROR) {
+			gRfidStats.readErrors++;
+		}
+		if (!cardApplied) {
+			return;
+		}
+		if (!driver.detectsRemoval()) {
+			// halted card isn't seen anymore: ready for re-apply, but that's no removal
+			cardApplied = false;
+			memset(lastCardId, 0, sizeof(lastCardId));
+			return;
+		}
+		// debounce: single events where no card was detected don't count as removal
+		if (millis() - lastTimeDetected < driver.debounceTime()) {
+			gRfidStats.flaps++;
+			return;
+		}
+		cardApplied = false;
+		gRfidStats.removals++;
+		// Necessary to differentiate between "card is still applied" and "card is re-applied again after removal"
+		memset(lastCardId, 0, sizeof(lastCardId));
+#ifdef PAUSE_WHEN_RFID_REMOVED
+		if (!gPlayProperties.pausePlay && System_GetOperationMode() != OPMODE_BLUETOOTH_SINK) { // Card removed => pause
+			AudioPlayer_TrackControlToQueueSender(PAUSEPLAY);
+			Log_Println(rfidTagRemoved, LOGLEVEL_NOTICE);
+		}
+#endif
+	}
+
+private:
+	uint8_t lastCardId[cardIdSize] = {0};
+#ifdef PAUSE_WHEN_RFID_REMOVED
+	uint8_t lastValidCardId[cardIdSize] = {0};
+#endif
+	char lastCardIdString[CARD_ID_STR_SIZE] = {0};
+	uint32_t lastTimeDetected = 0;
+	uint32_t appliedSince = 0;
+	bool cardApplied = false;
+	bool holdReported = false;
+
+	// card is still applied after rfidHoldTime => send hold-gesture once (dispatcher decides whether it's assigned)
+	void checkHold(void) {
+		if (holdReported || millis() - appliedSince < rfidHoldTime) {
+			return;
+		}
+		holdReported = true;
+		char holdId[ID_STRING_SIZE];
+		Rfid_GestureId(holdId, RFID_GESTURE_HOLD, lastCardIdString, nullptr);
+		xQueueSend(gRfidCardQueue, holdId, 0);
+	}
+
+	void cardReceived(const uint8_t *uid) {
+		uint8_t cardId[cardIdSize];
+		memcpy(cardId, uid, cardIdSize);
+		cardApplied = true;
+
+		// check for different card id
+		if (memcmp(cardId, lastCardId, sizeof(cardId)) == 0) {
+			return; // same card is still applied
+		}
+		memcpy(lastCardId, cardId, cardIdSize);
+		gRfidStats.cardsDetected++;
+		appliedSince = millis();
+		holdReported = false;
+
+#ifdef HALLEFFECT_SENSOR_ENABLE
+		cardId[cardIdSize - 1] = cardId[cardIdSize - 1] + gHallEffectSensor.waitForState(HallEffectWaitMS);
+#endif
+
+		char hexString[CARD_ID_STR_SIZE];
+		char cardIdString[ID_STRING_SIZE];
+		for (uint8_t i = 0u; i < cardIdSize; i++) {
+			snprintf(&hexString[i * 3u], 4, "%02x%c", cardId[i], (i < cardIdSize - 1u) ? '-' : ' ');
+			snprintf(&cardIdString[i * 3u], 4, "%03d", cardId[i]);
+		}
+		memcpy(lastCardIdString, cardIdString, sizeof(lastCardIdString));
+		Log_Printf(LOGLEVEL_NOTICE, rfidTagDetected, hexString);
+		Log_Printf(LOGLEVEL_NOTICE, "Card type: %s", driver.cardType());
+
+#ifdef PAUSE_WHEN_RFID_REMOVED
+		const bool sameCardReapplied = (memcmp(lastValidCardId, cardId, sizeof(cardId)) == 0);
+		memcpy(lastValidCardId, uid, cardIdSize);
+	#ifdef ACCEPT_SAME_RFID_AFTER_TRACK_END
+		if (!sameCardReapplied || gPlayProperties.trackFinished || gPlayProperties.playlistFinished) { // Don't allow to send card to queue if it's the same card again if track or playlist is unfnished
+	#else
+		if (!sameCardReapplied) { // Don't allow to send card to queue if it's the same card again...
+	#endif
+			TapTrace_Start();
+			xQueueSend(gRfidCardQueue, cardIdString, 0);
+		} else {
+			// If pause-button was pressed while card was not applied, playback could be active. If so: don't pause when card is reapplied again as the desired functionality would be reversed in this case.
+			if (gPlayProperties.pausePlay && System_GetOperationMode() != OPMODE_BLUETOOTH_SINK) {
+				AudioPlayer_TrackControlToQueueSender(PAUSEPLAY); // ... play/pause instead (but not for BT)
+				Log_Println(rfidTagReapplied, LOGLEVEL_NOTICE);
+			}
+		}
+#else
+		TapTrace_Start();
+		xQueueSend(gRfidCardQueue, cardIdString, 0); // If PAUSE_WHEN_RFID_REMOVED isn't active, every card-apply leads to new playlist-generation
+#endif
+	}
+};
@@ -7,6 +7,7 @@
 #include "Led.h"
 #include "Log.h"
 #include "MemX.h"
+#include "Playlist.h"
 #include "System.h"
 
 #ifdef SD_MMC_1BIT_MODE
@@ -121,27 +122,6 @@ void SdCard_PrintInfo() {
 	Log_Printf(LOGLEVEL_NOTICE, sdInfo, cardSize, freeSize);
 }
 
-// Check if file-type is correct
-bool fileValid(const char *_fileItem) {
-	// make file extension to lowercase (compare case insenstive)
-	char *lFileItem;
-	lFileItem = x_strdup(_fileItem);
-	if (lFileItem == NULL) {
-		return false;
-	}
-	lFileItem = strlwr(lFileItem);
-	const char ch = '/';
-	char *subst;
-	subst = strrchr(lFileItem, ch); // Don't use files that start with .
-	bool isValid = (!startsWith(subst, (char *) "/.")) && (
-					   // audio file formats
-					   endsWith(lFileItem, ".mp3") || endsWith(lFileItem, ".aac") || endsWith(lFileItem, ".m4a") || endsWith(lFileItem, ".wav") || endsWith(lFileItem, ".flac") || endsWith(lFileItem, ".ogg") || endsWith(lFileItem, ".oga") || endsWith(lFileItem, ".opus") ||
-					   // playlist file formats
-					   endsWith(lFileItem, ".m3u") || endsWith(lFileItem, ".m3u8") || endsWith(lFileItem, ".pls") || endsWith(lFileItem, ".asx"));
-	free(lFileItem);
-	return isValid;
-}
-
 // Takes a directory as input and returns a random subdirectory from it
 char *SdCard_pickRandomSubdirectory(char *_directory) {
 	uint32_t listStartTimestamp = millis();
@@ -167,6 +147,7 @@ char *SdCard_pickRandomSubdirectory(char *_directory) {
 	}
 
 	// Create linear list of subdirectories with #-delimiters
+	size_t listLength = 0; // Track length instead of strlen()/strcat() to keep it linear for huge directories
 	while (true) {
 		bool isDir = false;
 		String MyfileName = directory.getNextFileName(&isDir);
@@ -178,7 +159,8 @@ char *SdCard_pickRandomSubdirectory(char *_directory) {
 		} else {
 			strncpy(buffer, MyfileName.c_str(), 255);
 			// Log_Printf(LOGLEVEL_INFO, nameOfFileFound, buffer);
-			if ((strlen(subdirectoryList) + strlen(buffer) + 2) >= allocCount * allocSize) {
+			const size_t nameLength = strlen(buffer);
+			if ((listLength + nameLength + 2) >= allocCount * allocSize) {
 				char *tmp = (char *) realloc(subdirectoryList, ++allocCount * allocSize);
 				Log_Println(reallocCalled, LOGLEVEL_DEBUG);
 				if (tmp == NULL) {
@@ -189,12 +171,12 @@ char *SdCard_pickRandomSubdirectory(char *_directory) {
 				}
 				subdirectoryList = tmp;
 			}
-			strcat(subdirectoryList, stringDelimiter);
-			strcat(subdirectoryList, buffer);
+			listLength = Playlist_Append(subdirectoryList, listLength, buffer, nameLength, stringDelimiter[0]);
 			directoryCount++;
 		}
 	}
-	strcat(subdirectoryList, stringDelimiter);
+	subdirectoryList[listLength++] = stringDelimiter[0];
+	subdirectoryList[listLength] = '\0';
 
 	if (!directoryCount) {
 		free(subdirectoryList);
@@ -300,6 +282,7 @@ char **SdCard_ReturnPlaylist(const char *fileName, const uint32_t _playMode) {
 					}
 				}
 			}
+			serializedPlaylist[fPos] = '\0'; // realloc() doesn't zero new memory
 			if (serializedPlaylist[fPos - 1] == '#') { // Remove trailing delimiter if set
 				serializedPlaylist[fPos - 1] = '\0';
 			}
@@ -322,7 +305,7 @@ char **SdCard_ReturnPlaylist(const char *fileName, const uint32_t _playMode) {
 			}
 			Log_Println(fileModeDetected, LOGLEVEL_INFO);
 			strncpy(fileNameBuf, fileOrDirectory.path(), sizeof(fileNameBuf) / sizeof(fileNameBuf[0]));
-			if (fileValid(fileNameBuf)) {
+			if (Playlist_FileValid(fileNameBuf)) {
 				files[1] = x_strdup(fileNameBuf);
 			}
 			files[0] = x_strdup("1"); // Number of files is always 1 in file-mode
@@ -338,6 +321,12 @@ char **SdCard_ReturnPlaylist(const char *fileName, const uint32_t _playMode) {
 		}
 
 		serializedPlaylist = (char *) x_calloc(allocSize, sizeof(char));
+		if (serializedPlaylist == NULL) {
+			Log_Println(unableToAllocateMemForLinearPlaylist, LOGLEVEL_ERROR);
+			System_IndicateError();
+			return nullptr;
+		}
+		size_t serializedLength = 0; // Track length instead of strlen()/strcat() to keep it linear for huge directories
 		while (true) {
 			bool isDir = false;
 			String MyfileName = fileOrDirectory.getNextFileName(&isDir);
@@ -349,9 +338,10 @@ char **SdCard_ReturnPlaylist(const char *fileName, const uint32_t _playMode) {
 			} else {
 				strncpy(fileNameBuf, MyfileName.c_str(), sizeof(fileNameBuf) / sizeof(fileNameBuf[0]));
 				// Don't support filenames that start with "." and only allow .mp3 and other supported audio file formats
-				if (fileValid(fileNameBuf)) {
+				if (Playlist_FileValid(fileNameBuf)) {
 					// Log_Printf(LOGLEVEL_INFO, "%s: %s", nameOfFileFound), fileNameBuf);
-					if ((strlen(serializedPlaylist) + strlen(fileNameBuf) + 2) >= allocCount * allocSize) {
+					const size_t nameLength = strlen(fileNameBuf);
+					if ((serializedLength + nameLength + 2) >= allocCount * allocSize) {
 						char *tmp = (char *) realloc(serializedPlaylist, ++allocCount * allocSize);
 						Log_Println(reallocCalled, LOGLEVEL_DEBUG);
 						if (tmp == nullptr) {
@@ -362,20 +352,14 @@ char **SdCard_ReturnPlaylist(const char *fileName, const uint32_t _playMode) {
 						}
 						serializedPlaylist = tmp;
 					}
-					strcat(serializedPlaylist, stringDelimiter);
-					strcat(serializedPlaylist, fileNameBuf);
+					serializedLength = Playlist_Append(serializedPlaylist, serializedLength, fileNameBuf, nameLength, stringDelimiter[0]);
 				}
 			}
 		}
 	}
 
 	// Get number of elements out of serialized playlist
-	uint32_t cnt = 0;
-	for (uint32_t k = 0; k < (strlen(serializedPlaylist)); k++) {
-		if (serializedPlaylist[k] == '#') {
-			cnt++;
-		}
-	}
+	const uint32_t cnt = Playlist_Count(serializedPlaylist, '#');
 
 	// Alloc only necessary number of playlist-pointers
 	files = (char **) x_malloc(sizeof(char *) * (cnt + 1));
@@ -412,3 +396,18 @@ char **SdCard_ReturnPlaylist(const char *fileName, const uint32_t _playMode) {
 
 	return &(files[1]); // return ptr+1 (starting at 1st payload-item); ptr+0 contains number of items
 }
+
+// Writes playlist as m3u (one entry per line), so it can be read again by SdCard_ReturnPlaylist(fileName, LOCAL_M3U)
+bool SdCard_WritePlaylist(const char *fileName, char **files, const uint32_t count) {
+	File file = gFSystem.open(fileName, FILE_WRITE);
+	if (!file) {
+		Log_Printf(LOGLEVEL_ERROR, errorWritingFile, fileName);
+		return false;
+	}
+	bool success = true;
+	for (uint32_t i = 0; i < count && success; i++) {
+		success = file.print(files[i]) > 0 && file.print('\n') == 1;
+	}
+	file.close();
+	return success;
+}
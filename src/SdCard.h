@@ -15,4 +15,5 @@ uint64_t SdCard_GetSize();
 uint64_t SdCard_GetFreeSize();
 void SdCard_PrintInfo();
 char **SdCard_ReturnPlaylist(const char *fileName, const uint32_t _playMode);
+bool SdCard_WritePlaylist(const char *fileName, char **files, const uint32_t count);
 char *SdCard_pickRandomSubdirectory(char *_directory);
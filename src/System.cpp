@@ -5,6 +5,7 @@
 
 #include "Audio.h"
 #include "AudioPlayer.h"
+#include "Bluetooth.h"
 #include "Led.h"
 #include "Log.h"
 #include "Mqtt.h"
@@ -12,6 +13,7 @@
 #include "Power.h"
 #include "Rfid.h"
 #include "SdCard.h"
+#include "Wlan.h"
 #include "esp_system.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -38,9 +40,17 @@ uint8_t System_SleepTimer = 30u; // Sleep timer in minutes that can be optionall
 
 // Operation Mode
 volatile uint8_t System_OperationMode;
+modeSwitchStats_t gModeSwitchStats;
+#ifdef RUNTIME_MODE_SWITCH_ENABLE
+constexpr uint8_t opModeNone = 0xFF;
+static volatile uint8_t System_PendingOperationMode = opModeNone; // switch is done by System_Cyclic()
+#endif
 
 void System_SleepHandler(void);
 void System_DeepSleepManager(void);
+#ifdef RUNTIME_MODE_SWITCH_ENABLE
+static void System_SwitchOperationMode(const uint8_t opMode);
+#endif
 
 void System_Init(void) {
 	srand(esp_random());
@@ -64,9 +74,16 @@ void System_Init(void) {
 void System_Cyclic(void) {
 	System_SleepHandler();
 	System_DeepSleepManager();
-	
-
 
+#ifdef RUNTIME_MODE_SWITCH_ENABLE
+	const uint8_t opMode = System_PendingOperationMode;
+	if (opMode != opModeNone && !System_Sleeping) {
+		System_PendingOperationMode = opModeNone;
+		if (opMode != System_OperationMode) {
+			System_SwitchOperationMode(opMode);
+		}
+	}
+#endif
 }
 
 void System_UpdateActivityTimer(void) {
@@ -150,16 +167,74 @@ void System_IndicateOk(void) {
 	Led_Indicate(LedIndicatorType::Ok);
 }
 
-// Writes to NVS, if bluetooth or "normal" mode is desired
+// Writes to NVS, if bluetooth or "normal" mode is desired.
+// Mode is switched at runtime by System_Cyclic() (RUNTIME_MODE_SWITCH_ENABLE), otherwise by restart.
 void System_SetOperationMode(uint8_t opMode) {
 	uint8_t currentOperationMode = gPrefsSettings.getUChar("operationMode", OPMODE_NORMAL);
+#ifdef RUNTIME_MODE_SWITCH_ENABLE
+	if (currentOperationMode != opMode) {
+		gPrefsSettings.putUChar("operationMode", opMode);
+	}
+	System_PendingOperationMode = opMode;
+#else
 	if (currentOperationMode != opMode) {
 		if (gPrefsSettings.putUChar("operationMode", opMode)) {
 			ESP.restart();
 		}
 	}
+#endif
 }
 
+#ifdef RUNTIME_MODE_SWITCH_ENABLE
+// Tears down audio-task, WiFi & A2DP-stack of the current mode and brings up the ones needed by the new mode.
+// WiFi and BT can't be active at the same time and the A2DP-sink needs I2S for itself (so the audio-task is restarted for every switch).
+static void System_SwitchOperationMode(const uint8_t opMode) {
+	const uint32_t switchStart = millis();
+	Log_Printf(LOGLEVEL_NOTICE, modeSwitchStarted, System_OperationMode, opMode);
+
+	// tear-down; audio-task first, as it's the only step that can fail (busy for too long)
+	if (!AudioPlayer_StopTask()) {
+		Log_Println(modeSwitchAborted, LOGLEVEL_ERROR);
+		gPrefsSettings.putUChar("operationMode", System_OperationMode);
+		System_IndicateError();
+		return;
+	}
+	if (System_OperationMode == OPMODE_NORMAL) {
+		Wlan_Stop();
+	} else {
+		Bluetooth_Exit();
+	}
+
+	// nothing mode-specific is active now => free heap has to be the same for every switch
+	vTaskDelay(portTICK_PERIOD_MS * 20u); // idle-task frees memory of self-deleted tasks (e.g. BT-stack)
+	gModeSwitchStats.idleHeap = ESP.getFreeHeap();
+	if (gModeSwitchStats.switches == 0u) {
+		gModeSwitchStats.idleHeapBaseline = gModeSwitchStats.idleHeap;
+	}
+	gModeSwitchStats.idleHeapDelta = (int32_t) gModeSwitchStats.idleHeap - (int32_t) gModeSwitchStats.idleHeapBaseline;
+
+	// bring-up
+	System_OperationMode = opMode;
+	if (opMode == OPMODE_NORMAL) {
+		Wlan_Start();
+	} else {
+		Bluetooth_Init();
+	}
+	if (opMode != OPMODE_BLUETOOTH_SINK) {
+		AudioPlayer_StartTask();
+	}
+	System_UpdateActivityTimer();
+
+	gModeSwitchStats.switches++;
+	gModeSwitchStats.lastSwitchTime = millis() - switchStart;
+	if (gModeSwitchStats.lastSwitchTime > gModeSwitchStats.maxSwitchTime) {
+		gModeSwitchStats.maxSwitchTime = gModeSwitchStats.lastSwitchTime;
+	}
+	Log_Printf(LOGLEVEL_NOTICE, modeSwitchDone, opMode, gModeSwitchStats.lastSwitchTime);
+	Log_Printf(LOGLEVEL_INFO, modeSwitchHeap, gModeSwitchStats.idleHeap, gModeSwitchStats.idleHeapBaseline, gModeSwitchStats.idleHeapDelta, ESP.getFreeHeap(), gModeSwitchStats.bootHeap, gModeSwitchStats.bootMode);
+}
+#endif
+
 uint8_t System_GetOperationMode(void) {
 	return System_OperationMode;
 }
@@ -225,6 +300,10 @@ void System_DeepSleepManager(void) {
 
 		System_Sleeping = true;
 		Log_Println(goToSleepNow, LOGLEVEL_NOTICE);
+#ifdef PLAY_LAST_RFID_AFTER_REBOOT
+		// has to be done while SD is still active (stops playback)
+		AudioPlayer_SaveResumeState();
+#endif
 		// prepare power down (shutdown common modules)
 		System_PreparePowerDown();
 
@@ -5,6 +5,20 @@ extern Preferences gPrefsRfid;
 extern Preferences gPrefsSettings;
 extern TaskHandle_t AudioTaskHandle;
 
+// Runtime-switch of operation-mode (tear-down of the old mode & bring-up of the new one without reboot, RUNTIME_MODE_SWITCH_ENABLE)
+typedef struct {
+	uint32_t bootHeap; // free heap after boot (compare with a build without RUNTIME_MODE_SWITCH_ENABLE for the memory kept for classic BT)
+	uint8_t bootMode; // operation-mode at boot
+	uint32_t switches; // number of switches since boot
+	uint32_t lastSwitchTime; // duration of last switch (in ms)
+	uint32_t maxSwitchTime; // longest switch (in ms)
+	uint32_t idleHeap; // free heap after tear-down of the last mode (no mode-specific task/stack active)
+	uint32_t idleHeapBaseline; // free heap after tear-down at the first switch
+	int32_t idleHeapDelta; // idleHeap - idleHeapBaseline; stays at ~0 if switches don't leak memory
+} modeSwitchStats_t;
+
+extern modeSwitchStats_t gModeSwitchStats;
+
 void System_Init(void);
 void System_Cyclic(void);
 void System_UpdateActivityTimer(void);
@@ -0,0 +1,106 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "TapTrace.h"
+
+#include "Log.h"
+
+#include <esp_timer.h>
+
+// Trace of the latency between applying a RFID-tag and audible output. Every stage is timestamped,
+// the time elapsed since the previous stage is collected per stage in a histogram.
+// Only one trace can be active at a time; a new tap replaces an unfinished one. Marks which don't
+// follow the previous stage are ignored, so playback started by other sources (web, MQTT, ...) isn't counted.
+
+static Histogram TapTrace_StageHist[TAP_TRACE_STAGE_COUNT]; // duration from previous stage (in µs); unused for TAP_TRACE_DETECTED
+static Histogram TapTrace_TotalHist; // duration from TAP_TRACE_DETECTED to TAP_TRACE_FIRST_AUDIO (in µs)
+static int64_t TapTrace_Timestamps[TAP_TRACE_STAGE_COUNT];
+static int8_t TapTrace_LastStage = -1; // -1: no active trace
+static portMUX_TYPE TapTrace_Mux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *TapTrace_StageNames[TAP_TRACE_STAGE_COUNT] = {
+	"detected",
+	"lookup",
+	"playlist",
+	"queued",
+	"opened",
+	"firstAudio",
+};
+
+void TapTrace_Start(void) {
+	portENTER_CRITICAL(&TapTrace_Mux);
+	TapTrace_Timestamps[TAP_TRACE_DETECTED] = esp_timer_get_time();
+	TapTrace_LastStage = TAP_TRACE_DETECTED;
+	portEXIT_CRITICAL(&TapTrace_Mux);
+}
+
+void TapTrace_Mark(const tapTraceStage_t stage) {
+	if (stage == TAP_TRACE_DETECTED || stage >= TAP_TRACE_STAGE_COUNT) {
+		return;
+	}
+	const int64_t now = esp_timer_get_time();
+	int64_t total = -1;
+
+	portENTER_CRITICAL(&TapTrace_Mux);
+	if (TapTrace_LastStage == stage - 1) {
+		if (now - TapTrace_Timestamps[TAP_TRACE_DETECTED] > (int64_t) tapTraceTimeout * 1000) {
+			TapTrace_LastStage = -1;
+		} else {
+			TapTrace_Timestamps[stage] = now;
+			TapTrace_StageHist[stage].add(now - TapTrace_Timestamps[stage - 1]);
+			TapTrace_LastStage = stage;
+			if (stage == TAP_TRACE_FIRST_AUDIO) {
+				total = now - TapTrace_Timestamps[TAP_TRACE_DETECTED];
+				TapTrace_TotalHist.add(total);
+				TapTrace_LastStage = -1;
+			}
+		}
+	}
+	portEXIT_CRITICAL(&TapTrace_Mux);
+
+	if (total >= 0) {
+		Log_Printf(LOGLEVEL_DEBUG, "Tap to first audio: %u ms", (uint32_t) (total / 1000));
+	}
+}
+
+// Drops active trace (e.g. tag was a modification-card or unknown)
+void TapTrace_Abort(void) {
+	portENTER_CRITICAL(&TapTrace_Mux);
+	TapTrace_LastStage = -1;
+	portEXIT_CRITICAL(&TapTrace_Mux);
+}
+
+// Returns true if the given stage is expected to be marked next
+bool TapTrace_Pending(const tapTraceStage_t stage) {
+	return TapTrace_LastStage == stage - 1;
+}
+
+const char *TapTrace_StageName(const tapTraceStage_t stage) {
+	return (stage < TAP_TRACE_STAGE_COUNT) ? TapTrace_StageNames[stage] : "";
+}
+
+void TapTrace_GetHistogram(const tapTraceStage_t stage, Histogram &dst) {
+	if (stage >= TAP_TRACE_STAGE_COUNT) {
+		dst.reset();
+		return;
+	}
+	portENTER_CRITICAL(&TapTrace_Mux);
+	dst = TapTrace_StageHist[stage];
+	portEXIT_CRITICAL(&TapTrace_Mux);
+}
+
+void TapTrace_GetTotalHistogram(Histogram &dst) {
+	portENTER_CRITICAL(&TapTrace_Mux);
+	dst = TapTrace_TotalHist;
+	portEXIT_CRITICAL(&TapTrace_Mux);
+}
+
+void TapTrace_Reset(void) {
+	portENTER_CRITICAL(&TapTrace_Mux);
+	for (uint8_t i = 0; i < TAP_TRACE_STAGE_COUNT; i++) {
+		TapTrace_StageHist[i].reset();
+	}
+	TapTrace_TotalHist.reset();
+	TapTrace_LastStage = -1;
+	portEXIT_CRITICAL(&TapTrace_Mux);
+}
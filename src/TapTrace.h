@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Histogram.h"
+
+// Stages of the path from applying a RFID-tag to the first audio being sent to I2S (in chronological order)
+enum tapTraceStage_t : uint8_t {
+	TAP_TRACE_DETECTED = 0, // RFID-task: tag was read and pushed to gRfidCardQueue
+	TAP_TRACE_LOOKUP, // tag was received from queue and is looked up in NVS
+	TAP_TRACE_PLAYLIST, // playlist was generated (SD-scan/m3u/webstream)
+	TAP_TRACE_QUEUED, // playlist was sorted/shuffled and passed to gTrackQueue
+	TAP_TRACE_OPENED, // audio-task opened first track
+	TAP_TRACE_FIRST_AUDIO, // first decoded data was sent to I2S
+	TAP_TRACE_STAGE_COUNT
+};
+
+constexpr uint32_t tapTraceTimeout = 10000u; // Traces older than this (in ms) are dropped
+
+void TapTrace_Start(void);
+void TapTrace_Mark(const tapTraceStage_t stage);
+void TapTrace_Abort(void);
+bool TapTrace_Pending(const tapTraceStage_t stage);
+const char *TapTrace_StageName(const tapTraceStage_t stage);
+void TapTrace_GetHistogram(const tapTraceStage_t stage, Histogram &dst);
+void TapTrace_GetTotalHistogram(Histogram &dst);
+void TapTrace_Reset(void);
@@ -0,0 +1,255 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Telemetry.h"
+
+#include "Log.h"
+#include "MemX.h"
+#include "esp_heap_caps.h"
+
+// Sampling telemetry: Records heap-usage and (if available) cpu-load + stack high-water mark
+// per task at a fixed interval into a ring buffer. Task-related values are stored in slots,
+// a slot is assigned to a task the first time it shows up.
+
+typedef struct {
+	char name[configMAX_TASK_NAME_LEN];
+	UBaseType_t taskNumber; // unique id of task (FreeRTOS)
+	uint32_t lastRunTime; // runtime counter at the previous sample
+	uint32_t lastSeen; // sample-number the task was seen last
+	bool used;
+} telemetryTask_t;
+
+typedef struct {
+	uint32_t timestamp; // millis() when sample was taken
+	uint32_t freeHeap;
+	uint32_t largestFreeBlock;
+	uint32_t freePsram;
+	uint32_t maxLoopTime; // longest Arduino-loop (ms between two calls of Telemetry_Cyclic()) since previous sample
+	uint16_t cpuPermille[telemetryMaxTasks]; // load of a single core; telemetryNoValue if task doesn't exist
+	uint16_t stackHighWaterMark[telemetryMaxTasks]; // minimum free stack (unit as reported by FreeRTOS: bytes on ESP32)
+} telemetrySample_t;
+
+static constexpr uint16_t telemetryNoValue = 0xFFFF;
+
+static telemetrySample_t *Telemetry_Samples = NULL;
+static telemetryTask_t Telemetry_Tasks[telemetryMaxTasks];
+static uint32_t Telemetry_SampleCount = 0; // number of samples taken since boot
+static uint32_t Telemetry_LastTotalRunTime = 0;
+static uint32_t Telemetry_MaxLoopTime = 0; // ms; since previous sample
+static portMUX_TYPE Telemetry_Mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void Telemetry_TakeSample(void);
+
+void Telemetry_Init(void) {
+	Telemetry_Samples = (telemetrySample_t *) x_calloc(telemetryHistoryLength, sizeof(telemetrySample_t));
+	if (Telemetry_Samples == NULL) {
+		Log_Println(unableToAllocateMem, LOGLEVEL_ERROR);
+	}
+	memset(Telemetry_Tasks, 0, sizeof(Telemetry_Tasks));
+}
+
+void Telemetry_Cyclic(void) {
+	static uint32_t lastSampleTimestamp = 0;
+	static uint32_t lastCallTimestamp = 0;
+
+	if (Telemetry_Samples == NULL) {
+		return;
+	}
+	// called once per loop: time between two calls shows if the loop was blocked (e.g. by a blocking connect)
+	const uint32_t now = millis();
+	if (lastCallTimestamp && now - lastCallTimestamp > Telemetry_MaxLoopTime) {
+		Telemetry_MaxLoopTime = now - lastCallTimestamp;
+	}
+	lastCallTimestamp = now;
+	if (millis() - lastSampleTimestamp >= telemetrySampleInterval) {
+		lastSampleTimestamp = millis();
+		Telemetry_TakeSample();
+	}
+}
+
+#ifdef CONFIG_FREERTOS_USE_TRACE_FACILITY
+// Returns the slot of a task. Assigns a new slot if the task is unknown yet.
+// Slots are only reused after their task vanished from the whole history.
+static int8_t Telemetry_GetTaskSlot(const TaskStatus_t &task) {
+	int8_t freeSlot = -1;
+
+	for (uint8_t i = 0; i < telemetryMaxTasks; i++) {
+		if (Telemetry_Tasks[i].used && Telemetry_Tasks[i].taskNumber == task.xTaskNumber) {
+			return i;
+		}
+		if (freeSlot < 0 && (!Telemetry_Tasks[i].used || (Telemetry_SampleCount - Telemetry_Tasks[i].lastSeen) > telemetryHistoryLength)) {
+			freeSlot = i;
+		}
+	}
+
+	if (freeSlot >= 0) {
+		telemetryTask_t &slot = Telemetry_Tasks[freeSlot];
+		strncpy(slot.name, task.pcTaskName, sizeof(slot.name) - 1);
+		slot.name[sizeof(slot.name) - 1] = '\0';
+		slot.taskNumber = task.xTaskNumber;
+		slot.lastRunTime = task.ulRunTimeCounter;
+		slot.used = true;
+	}
+	return freeSlot;
+}
+#endif
+
+static void Telemetry_TakeSample(void) {
+	telemetrySample_t sample;
+
+	sample.timestamp = millis();
+	sample.freeHeap = ESP.getFreeHeap();
+	sample.largestFreeBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+	sample.freePsram = psramFound() ? ESP.getFreePsram() : 0u;
+	sample.maxLoopTime = Telemetry_MaxLoopTime;
+	Telemetry_MaxLoopTime = 0;
+	for (uint8_t i = 0; i < telemetryMaxTasks; i++) {
+		sample.cpuPermille[i] = telemetryNoValue;
+		sample.stackHighWaterMark[i] = telemetryNoValue;
+	}
+
+#ifdef CONFIG_FREERTOS_USE_TRACE_FACILITY
+	// allocate some more entries in case tasks are created in between
+	const UBaseType_t maxTasks = uxTaskGetNumberOfTasks() + 4u;
+	TaskStatus_t *taskStatus = (TaskStatus_t *) malloc(maxTasks * sizeof(TaskStatus_t));
+	if (taskStatus != NULL) {
+		uint32_t totalRunTime;
+		const UBaseType_t taskCount = uxTaskGetSystemState(taskStatus, maxTasks, &totalRunTime);
+		const uint32_t deltaTotalRunTime = totalRunTime - Telemetry_LastTotalRunTime;
+
+		portENTER_CRITICAL(&Telemetry_Mux);
+		for (UBaseType_t i = 0; i < taskCount; i++) {
+			const int8_t slot = Telemetry_GetTaskSlot(taskStatus[i]);
+			if (slot < 0) {
+				continue; // no more slots
+			}
+			telemetryTask_t &task = Telemetry_Tasks[slot];
+			if (deltaTotalRunTime > 0 && Telemetry_LastTotalRunTime > 0) {
+				const uint32_t deltaRunTime = taskStatus[i].ulRunTimeCounter - task.lastRunTime;
+				sample.cpuPermille[slot] = std::min<uint64_t>(1000u, (uint64_t) deltaRunTime * 1000u / deltaTotalRunTime);
+			}
+			sample.stackHighWaterMark[slot] = std::min<uint32_t>(telemetryNoValue - 1, taskStatus[i].usStackHighWaterMark);
+			task.lastRunTime = taskStatus[i].ulRunTimeCounter;
+			task.lastSeen = Telemetry_SampleCount;
+		}
+		portEXIT_CRITICAL(&Telemetry_Mux);
+		Telemetry_LastTotalRunTime = totalRunTime;
+		free(taskStatus);
+	}
+#endif
+
+	portENTER_CRITICAL(&Telemetry_Mux);
+	Telemetry_Samples[Telemetry_SampleCount % telemetryHistoryLength] = sample;
+	Telemetry_SampleCount++;
+	portEXIT_CRITICAL(&Telemetry_Mux);
+}
+
+// Copies a sample (0 = oldest one available). Returns false if there's no such sample.
+static bool Telemetry_GetSample(uint32_t index, telemetrySample_t &sample) {
+	bool ret = false;
+
+	portENTER_CRITICAL(&Telemetry_Mux);
+	const uint32_t available = std::min<uint32_t>(Telemetry_SampleCount, telemetryHistoryLength);
+	if (Telemetry_Samples != NULL && index < available) {
+		sample = Telemetry_Samples[(Telemetry_SampleCount - available + index) % telemetryHistoryLength];
+		ret = true;
+	}
+	portEXIT_CRITICAL(&Telemetry_Mux);
+
+	return ret;
+}
+
+// Copies the task-table (names can change if a slot was reassigned)
+static void Telemetry_GetTasks(telemetryTask_t *tasks) {
+	portENTER_CRITICAL(&Telemetry_Mux);
+	memcpy(tasks, Telemetry_Tasks, sizeof(Telemetry_Tasks));
+	portEXIT_CRITICAL(&Telemetry_Mux);
+}
+
+// {"interval":5000,"tasks":["loopTask",..],"samples":[{"time":..,"freeHeap":..,"largestFreeBlock":..,"freePsram":..,"maxLoopMs":..,"cpu":[..],"stack":[..]},..]}
+// cpu is given in percent of one core, null if task didn't exist at that time
+void Telemetry_PrintJson(Print &out) {
+	telemetryTask_t *tasks = (telemetryTask_t *) malloc(sizeof(Telemetry_Tasks));
+	if (tasks == NULL) {
+		out.print("{}");
+		return;
+	}
+	Telemetry_GetTasks(tasks);
+
+	// only print slots that were ever used
+	uint8_t taskCount = 0;
+	for (uint8_t i = 0; i < telemetryMaxTasks; i++) {
+		if (tasks[i].used) {
+			taskCount = i + 1;
+		}
+	}
+
+	out.printf("{\"interval\":%u,\"tasks\":[", telemetrySampleInterval);
+	for (uint8_t i = 0; i < taskCount; i++) {
+		out.printf("%s\"%s\"", i ? "," : "", tasks[i].used ? tasks[i].name : "");
+	}
+	out.print("],\"samples\":[");
+
+	telemetrySample_t sample;
+	for (uint32_t s = 0; Telemetry_GetSample(s, sample); s++) {
+		out.printf("%s{\"time\":%u,\"freeHeap\":%u,\"largestFreeBlock\":%u,\"freePsram\":%u,\"maxLoopMs\":%u,\"cpu\":[", s ? "," : "", sample.timestamp, sample.freeHeap, sample.largestFreeBlock, sample.freePsram, sample.maxLoopTime);
+		for (uint8_t i = 0; i < taskCount; i++) {
+			if (sample.cpuPermille[i] == telemetryNoValue) {
+				out.print(i ? ",null" : "null");
+			} else {
+				out.printf("%s%u.%u", i ? "," : "", sample.cpuPermille[i] / 10u, sample.cpuPermille[i] % 10u);
+			}
+		}
+		out.print("],\"stack\":[");
+		for (uint8_t i = 0; i < taskCount; i++) {
+			if (sample.stackHighWaterMark[i] == telemetryNoValue) {
+				out.print(i ? ",null" : "null");
+			} else {
+				out.printf("%s%u", i ? "," : "", sample.stackHighWaterMark[i]);
+			}
+		}
+		out.print("]}");
+	}
+	out.print("]}");
+	free(tasks);
+}
+
+// One line per sample: time,freeHeap,largestFreeBlock,freePsram,maxLoopMs,<task>.cpu,<task>.stack,...
+// Values of tasks that didn't exist at that time are left empty
+void Telemetry_PrintCsv(Print &out) {
+	telemetryTask_t *tasks = (telemetryTask_t *) malloc(sizeof(Telemetry_Tasks));
+	if (tasks == NULL) {
+		return;
+	}
+	Telemetry_GetTasks(tasks);
+
+	out.print("time,freeHeap,largestFreeBlock,freePsram,maxLoopMs");
+	for (uint8_t i = 0; i < telemetryMaxTasks; i++) {
+		if (tasks[i].used) {
+			out.printf(",%s.cpu,%s.stack", tasks[i].name, tasks[i].name);
+		}
+	}
+	out.print("\r\n");
+
+	telemetrySample_t sample;
+	for (uint32_t s = 0; Telemetry_GetSample(s, sample); s++) {
+		out.printf("%u,%u,%u,%u,%u", sample.timestamp, sample.freeHeap, sample.largestFreeBlock, sample.freePsram, sample.maxLoopTime);
+		for (uint8_t i = 0; i < telemetryMaxTasks; i++) {
+			if (!tasks[i].used) {
+				continue;
+			}
+			if (sample.cpuPermille[i] == telemetryNoValue) {
+				out.print(",");
+			} else {
+				out.printf(",%u.%u", sample.cpuPermille[i] / 10u, sample.cpuPermille[i] % 10u);
+			}
+			if (sample.stackHighWaterMark[i] == telemetryNoValue) {
+				out.print(",");
+			} else {
+				out.printf(",%u", sample.stackHighWaterMark[i]);
+			}
+		}
+		out.print("\r\n");
+	}
+	free(tasks);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+constexpr uint32_t telemetrySampleInterval = 5000u; // Interval in ms between two telemetry-samples
+constexpr uint8_t telemetryHistoryLength = 60u; // Number of samples kept in history (=> 5 minutes)
+constexpr uint8_t telemetryMaxTasks = 32u; // Maximum number of tasks tracked
+
+void Telemetry_Init(void);
+void Telemetry_Cyclic(void);
+
+// Writes the recorded history as time series (oldest sample first)
+void Telemetry_PrintJson(Print &out);
+void Telemetry_PrintCsv(Print &out);
@@ -7,6 +7,7 @@
 #include "AsyncJson.h"
 #include "AudioPlayer.h"
 #include "Battery.h"
+#include "Boot.h"
 #include "Cmd.h"
 #include "Common.h"
 #include "ESPAsyncWebServer.h"
@@ -17,9 +18,12 @@
 #include "Log.h"
 #include "MemX.h"
 #include "Mqtt.h"
+#include "Playlist.h"
 #include "Rfid.h"
 #include "SdCard.h"
 #include "System.h"
+#include "TapTrace.h"
+#include "Telemetry.h"
 #include "Wlan.h"
 #include "freertos/ringbuf.h"
 #include "revision.h"
@@ -79,6 +83,7 @@ static void handleGetInfo(AsyncWebServerRequest *request);
 static void handleGetSettings(AsyncWebServerRequest *request);
 static void handlePostSettings(AsyncWebServerRequest *request, JsonVariant &json);
 static void handleDebugRequest(AsyncWebServerRequest *request);
+static void handleLogRequest(AsyncWebServerRequest *request);
 
 static void onWebsocketEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len);
 static void settingsToJSON(JsonObject obj, const String section);
@@ -285,6 +290,48 @@ static void handleWiFiScanRequest(AsyncWebServerRequest *request) {
 }
 
 unsigned long lastCleanupClientsTimestamp;
+static uint32_t logLiveTailCursor = 0;
+
+// Pushes new log-data to all clients subscribed to /events (live-tail)
+static void Web_SendLogLiveTail(void) {
+	const uint32_t head = Log_GetRingBufferHead();
+	if (!webserverStarted || events.count() == 0) {
+		logLiveTailCursor = head;
+		return;
+	}
+	if ((int32_t) (Log_GetRingBufferTail() - logLiveTailCursor) > 0) {
+		// clients were too slow, data already overwritten
+		logLiveTailCursor = Log_GetRingBufferTail();
+	}
+	// limit data sent per cycle; the rest follows with the next cycle
+	char buf[513];
+	const size_t len = Log_ReadRingBuffer(logLiveTailCursor, (uint8_t *) buf, sizeof(buf) - 1);
+	if (len > 0) {
+		buf[len] = '\0';
+		logLiveTailCursor += len;
+		events.send(buf, "log", logLiveTailCursor);
+	}
+}
+
+// Pushes trackinfo to all websocket-clients if play-state has changed (progress is sent separately on request)
+static void Web_SendTrackInfoOnChange(void) {
+	static uint32_t lastGeneration = 0;
+	static playerState_t lastState;
+
+	const uint32_t generation = AudioPlayer_GetStateGeneration();
+	if (generation == lastGeneration) {
+		return;
+	}
+	lastGeneration = generation;
+
+	playerState_t state;
+	AudioPlayer_GetState(state);
+	const bool changed = (state.pausePlay != lastState.pausePlay) || (state.currentTrackNumber != lastState.currentTrackNumber) || (state.numberOfTracks != lastState.numberOfTracks) || (state.playMode != lastState.playMode) || (strcmp(state.title, lastState.title) != 0);
+	lastState = state;
+	if (changed) {
+		Web_SendWebsocketData(0, 30);
+	}
+}
 
 void Web_Cyclic(void) {
 	webserverStart();
@@ -293,7 +340,10 @@ void Web_Cyclic(void) {
 		lastCleanupClientsTimestamp = millis();
 		ws.cleanupClients();
 	}
+	Web_SendLogLiveTail();
+	Web_SendTrackInfoOnChange();
 }
+
 // handle not found
 void notFound(AsyncWebServerRequest *request) {
 	Log_Printf(LOGLEVEL_ERROR, "%s not found, redirect to startpage", request->url().c_str());
@@ -348,10 +398,7 @@ void webserverStart(void) {
 		WWWData::registerRoutes(serveProgmemFiles);
 
 		// Log
-		wServer.on("/log", HTTP_GET, [](AsyncWebServerRequest *request) {
-			request->send(200, "text/plain; charset=utf-8", Log_GetRingBuffer());
-			System_UpdateActivityTimer();
-		});
+		wServer.on("/log", HTTP_GET, handleLogRequest);
 
 		// info
 		wServer.on("/info", HTTP_GET, handleGetInfo);
@@ -453,12 +500,33 @@ void webserverStart(void) {
 		// debug info
 		wServer.on("/debug", HTTP_GET, handleDebugRequest);
 
+		// trace of the current & previous boot (Chrome trace-event-format)
+		wServer.on("/boottrace", HTTP_GET, [](AsyncWebServerRequest *request) {
+			AsyncResponseStream *response = request->beginResponseStream("application/json; charset=utf-8");
+			Boot_PrintTrace(*response);
+			request->send(response);
+		});
+
+		// telemetry history (time series of heap & per task cpu/stack)
+		wServer.on("/telemetry", HTTP_GET, [](AsyncWebServerRequest *request) {
+			if (request->hasParam("format") && request->getParam("format")->value() == "csv") {
+				AsyncResponseStream *response = request->beginResponseStream("text/csv");
+				Telemetry_PrintCsv(*response);
+				request->send(response);
+			} else {
+				AsyncResponseStream *response = request->beginResponseStream("application/json; charset=utf-8");
+				Telemetry_PrintJson(*response);
+				request->send(response);
+			}
+		});
+
 		// erase all RFID-assignments from NVS
 		wServer.on("/rfidnvserase", HTTP_POST, [](AsyncWebServerRequest *request) {
 			Log_Println(eraseRfidNvs, LOGLEVEL_NOTICE);
 			// make a backup first
 			Web_DumpNvsToSd("rfidTags", backupFile);
 			if (gPrefsRfid.clear()) {
+				Rfid_GesturesRebuild();
 				request->send(200);
 			} else {
 				request->send(500);
@@ -668,6 +736,7 @@ bool JSONToSettings(JsonObject doc) {
 				return false;
 			}
 		}
+		Rfid_GesturesRebuild();
 		Web_DumpNvsToSd("rfidTags", backupFile); // Store backup-file every time when a new rfid-tag is programmed
 	} else if (doc.containsKey("rfidAssign")) {
 		const char *_rfidIdAssinId = doc["rfidAssign"]["rfidIdMusic"];
@@ -689,6 +758,7 @@ bool JSONToSettings(JsonObject doc) {
 		if (s.compareTo(rfidString)) {
 			return false;
 		}
+		Rfid_GesturesRebuild();
 		Web_DumpNvsToSd("rfidTags", backupFile); // Store backup-file every time when a new rfid-tag is programmed
 	} else if (doc.containsKey("ping")) {
 		if ((millis() - lastPongTimestamp) > 1000u) {
@@ -972,27 +1042,123 @@ void handlePostSettings(AsyncWebServerRequest *request, JsonVariant &json) {
 	}
 }
 
+// Summary of a histogram (percentiles are upper bounds of the histogram buckets)
+static void histogramToJSON(JsonObject obj, const Histogram &hist) {
+	obj["count"] = hist.count;
+	obj["min"] = hist.count ? hist.min : 0u;
+	obj["mean"] = hist.mean();
+	obj["p50"] = hist.percentile(50);
+	obj["p90"] = hist.percentile(90);
+	obj["p99"] = hist.percentile(99);
+	obj["max"] = hist.max;
+}
+
+// Audio pipeline health (counters & histograms)
+static void audioStatsToJSON(JsonObject obj) {
+	obj["dropouts"] = gAudioStats.dropouts;
+	obj["bufferUnderruns"] = gAudioStats.bufferUnderruns;
+	obj["webstreamConnects"] = gAudioStats.webstreamConnects;
+	obj["webstreamReconnects"] = gAudioStats.webstreamReconnects;
+	obj["bufferFill"] = gAudioStats.bufferFill;
+	histogramToJSON(obj.createNestedObject("bufferFillPercent"), gAudioStats.bufferFillHist);
+	histogramToJSON(obj.createNestedObject("decodeTimeUs"), gAudioStats.decodeTimeHist);
+	histogramToJSON(obj.createNestedObject("trackOpenTimeUs"), gAudioStats.trackOpenTimeHist);
+}
+
+// RFID-reader statistics (scan rate, read errors, read duration)
+static void rfidStatsToJSON(JsonObject obj) {
+	const uint32_t duration = (millis() - gRfidStats.since) / 1000u;
+	obj["reader"] = Rfid_GetReaderName();
+	obj["scans"] = gRfidStats.scans;
+	obj["scansPerMin"] = duration ? (uint32_t) ((uint64_t) gRfidStats.scans * 60u / duration) : 0u;
+	obj["readErrors"] = gRfidStats.readErrors;
+	obj["cardsDetected"] = gRfidStats.cardsDetected;
+	obj["removals"] = gRfidStats.removals;
+	obj["flaps"] = gRfidStats.flaps;
+	histogramToJSON(obj.createNestedObject("readTimeUs"), gRfidStats.readTimeHist);
+	histogramToJSON(obj.createNestedObject("cardReadTimeUs"), gRfidStats.cardReadTimeHist);
+}
+
+// LED rendering statistics (frames sent, skipped as unchanged, deferred by frame-rate cap)
+static void ledStatsToJSON(JsonObject obj) {
+	const uint32_t duration = (millis() - gLedStats.since) / 1000u;
+	obj["framesRendered"] = gLedStats.framesRendered;
+	obj["framesSkipped"] = gLedStats.framesSkipped;
+	obj["framesDeferred"] = gLedStats.framesDeferred;
+	obj["wakeupsPerSec"] = duration ? (float) gLedStats.wakeups / duration : 0.0f;
+	obj["framesPerSec"] = duration ? (float) gLedStats.framesRendered / duration : 0.0f;
+}
+
+// Outbound MQTT statistics (sent, coalesced by the topic-table, failed, dropped)
+static void mqttStatsToJSON(JsonObject obj) {
+	obj["enabled"] = Mqtt_IsEnabled();
+	obj["published"] = gMqttStats.published;
+	obj["coalesced"] = gMqttStats.coalesced;
+	obj["failed"] = gMqttStats.failed;
+	obj["dropped"] = gMqttStats.dropped;
+	obj["connects"] = gMqttStats.connects;
+	obj["connectFailures"] = gMqttStats.connectFailures;
+	histogramToJSON(obj.createNestedObject("connectTimeMs"), gMqttStats.connectTimeHist);
+}
+
+// WiFi connection timing (boot-to-IP, fast connect via cached BSSID & channel)
+static void wifiStatsToJSON(JsonObject obj) {
+	obj["bootToIpMs"] = gWlanStats.bootToIp;
+	obj["connectTimeMs"] = gWlanStats.connectTime;
+	obj["connects"] = gWlanStats.connects;
+	obj["fastConnects"] = gWlanStats.fastConnects;
+	obj["cachedLease"] = gWlanStats.cachedLease;
+}
+
+// Runtime-switch of operation-mode (duration, free heap after tear-down compared to the first switch)
+static void modeSwitchStatsToJSON(JsonObject obj) {
+	obj["bootHeap"] = gModeSwitchStats.bootHeap;
+	obj["bootMode"] = gModeSwitchStats.bootMode;
+	obj["freeHeap"] = ESP.getFreeHeap();
+	obj["switches"] = gModeSwitchStats.switches;
+	obj["lastSwitchTimeMs"] = gModeSwitchStats.lastSwitchTime;
+	obj["maxSwitchTimeMs"] = gModeSwitchStats.maxSwitchTime;
+	obj["idleHeap"] = gModeSwitchStats.idleHeap;
+	obj["idleHeapBaseline"] = gModeSwitchStats.idleHeapBaseline;
+	obj["idleHeapDelta"] = gModeSwitchStats.idleHeapDelta;
+}
+
+// Latency from RFID-tap to first audio: duration of every stage (since the previous one) and in total
+static void tapLatencyToJSON(JsonObject obj) {
+	Histogram hist;
+	TapTrace_GetTotalHistogram(hist);
+	histogramToJSON(obj.createNestedObject("totalUs"), hist);
+	JsonObject stagesObj = obj.createNestedObject("stagesUs");
+	for (uint8_t i = TAP_TRACE_LOOKUP; i < TAP_TRACE_STAGE_COUNT; i++) {
+		TapTrace_GetHistogram((tapTraceStage_t) i, hist);
+		histogramToJSON(stagesObj.createNestedObject(TapTrace_StageName((tapTraceStage_t) i)), hist);
+	}
+}
+
 // handle debug request
 // returns memory and task runtime information as JSON
 void handleDebugRequest(AsyncWebServerRequest *request) {
 
 #ifdef BOARD_HAS_PSRAM
-	SpiRamJsonDocument doc(1000);
+	SpiRamJsonDocument doc(8192);
 #else
-	StaticJsonDocument<1000> doc;
+	DynamicJsonDocument doc(8192);
 #endif
 
 	JsonObject infoObj = doc.createNestedObject("info");
 #ifdef CONFIG_FREERTOS_USE_TRACE_FACILITY
 	// task runtime info
-	TaskStatus_t task_status_arr[20];
 	uint32_t pulTotalRunTime;
-	uint32_t taskNum = uxTaskGetNumberOfTasks();
+	uint32_t taskNum = uxTaskGetNumberOfTasks() + 2u; // some spare entries in case tasks are created in between
+	TaskStatus_t *task_status_arr = (TaskStatus_t *) malloc(taskNum * sizeof(TaskStatus_t));
+	if (task_status_arr == NULL) {
+		request->send(500);
+		return;
+	}
 
+	taskNum = uxTaskGetSystemState(task_status_arr, taskNum, &pulTotalRunTime);
 	Log_Printf(LOGLEVEL_DEBUG, "number of tasks: %u", taskNum);
 
-	uxTaskGetSystemState(task_status_arr, 20, &pulTotalRunTime);
-
 	JsonObject tasksObj = infoObj.createNestedObject("tasks");
 	tasksObj["taskCount"] = taskNum;
 	tasksObj["totalRunTime"] = pulTotalRunTime;
@@ -1009,7 +1175,23 @@ void handleDebugRequest(AsyncWebServerRequest *request) {
 		taskObj["runtimePercentage"] = ulStatsAsPercentage;
 		taskObj["stackHighWaterMark"] = task_status_arr[i].usStackHighWaterMark;
 	}
+	free(task_status_arr);
 #endif
+	// audio pipeline health
+	audioStatsToJSON(infoObj.createNestedObject("audio"));
+	tapLatencyToJSON(infoObj.createNestedObject("tapLatency"));
+	rfidStatsToJSON(infoObj.createNestedObject("rfid"));
+	ledStatsToJSON(infoObj.createNestedObject("led"));
+	mqttStatsToJSON(infoObj.createNestedObject("mqtt"));
+	wifiStatsToJSON(infoObj.createNestedObject("wifi"));
+	modeSwitchStatsToJSON(infoObj.createNestedObject("modeSwitch"));
+	if (request->hasParam("reset")) {
+		AudioPlayer_ResetStats();
+		TapTrace_Reset();
+		Rfid_ResetStats();
+		Led_ResetStats();
+		Mqtt_ResetStats();
+	}
 	String serializedJsonString;
 	serializeJson(infoObj, serializedJsonString);
 	if (doc.overflowed()) {
@@ -1019,6 +1201,33 @@ void handleDebugRequest(AsyncWebServerRequest *request) {
 	request->send(200, "application/json; charset=utf-8", serializedJsonString);
 }
 
+// handle log request
+// Streams the log ring buffer chunked (without copying it as a whole). Use "since" with the
+// cursor returned in header "X-Log-Cursor" of the previous request to get new data only.
+void handleLogRequest(AsyncWebServerRequest *request) {
+	const uint32_t head = Log_GetRingBufferHead();
+	uint32_t start = Log_GetRingBufferTail();
+	if (request->hasParam("since")) {
+		const uint32_t since = strtoul(request->getParam("since")->value().c_str(), NULL, 10);
+		// ignore cursors outside of the buffer (e.g. from before a reboot)
+		if ((int32_t) (since - start) >= 0 && (int32_t) (head - since) >= 0) {
+			start = since;
+		}
+	}
+
+	AsyncWebServerResponse *response = request->beginChunkedResponse("text/plain; charset=utf-8", [start, head](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+		const uint32_t pos = start + index;
+		if ((int32_t) (head - pos) <= 0) {
+			return 0;
+		}
+		return Log_ReadRingBuffer(pos, buffer, std::min<size_t>(maxLen, head - pos));
+	});
+	response->addHeader("X-Log-Cursor", String(head));
+	response->addHeader("Access-Control-Expose-Headers", "X-Log-Cursor");
+	request->send(response);
+	System_UpdateActivityTimer();
+}
+
 // Takes inputs from webgui, parses JSON and saves values in NVS
 // If operation was successful (NVS-write is verified) true is returned
 bool processJsonRequest(char *_serialJson) {
@@ -1076,20 +1285,24 @@ void Web_SendWebsocketData(uint32_t client, uint8_t code) {
 		object["status"] = "dropout";
 	} else if (code == 10) {
 		object["rfidId"] = gCurrentId;
+	} else if (code == 11) {
+		object["rfidId"] = Rfid_GetUnassignedGestureId();
 	} else if (code == 20) {
 		object["pong"] = "pong";
 		object["rssi"] = Wlan_GetRssi();
 		// todo: battery percent + loading status +++
 		// object["battery"] = Battery_GetVoltage();
 	} else if (code == 30) {
+		playerState_t state;
+		AudioPlayer_GetState(state);
 		JsonObject entry = object.createNestedObject("trackinfo");
-		entry["pausePlay"] = gPlayProperties.pausePlay;
-		entry["currentTrackNumber"] = gPlayProperties.currentTrackNumber + 1;
-		entry["numberOfTracks"] = gPlayProperties.numberOfTracks;
+		entry["pausePlay"] = state.pausePlay;
+		entry["currentTrackNumber"] = state.currentTrackNumber + 1;
+		entry["numberOfTracks"] = state.numberOfTracks;
 		entry["volume"] = AudioPlayer_GetCurrentVolume();
-		entry["name"] = gPlayProperties.title;
-		entry["posPercent"] = gPlayProperties.currentRelPos;
-		entry["playMode"] = gPlayProperties.playMode;
+		entry["name"] = state.title;
+		entry["posPercent"] = state.currentRelPos;
+		entry["playMode"] = state.playMode;
 	} else if (code == 40) {
 		object["coverimg"] = "coverimg";
 	} else if (code == 50) {
@@ -1101,10 +1314,14 @@ void Web_SendWebsocketData(uint32_t client, uint8_t code) {
 		JsonObject entry = object.createNestedObject("settings");
 		settingsToJSON(entry, "ssids");
 	} else if (code == 80) {
+		playerState_t state;
+		AudioPlayer_GetState(state);
 		JsonObject entry = object.createNestedObject("trackProgress");
-		entry["posPercent"] = gPlayProperties.currentRelPos;
+		entry["posPercent"] = state.currentRelPos;
 		entry["time"] = AudioPlayer_GetCurrentTime();
 		entry["duration"] = AudioPlayer_GetFileDuration();
+	} else if (code == 90) {
+		audioStatsToJSON(object.createNestedObject("audioStats"));
 	};
 
 	serializeJson(doc, jBuf, 1024);
@@ -1602,7 +1819,9 @@ void explorerHandleAudioRequest(AsyncWebServerRequest *request) {
 #ifdef DONT_ACCEPT_SAME_RFID_TWICE_ENABLE
 		Rfid_ResetOldRfid();
 #endif
+		Cmd_Lock();
 		AudioPlayer_TrackQueueDispatcher(filePath, 0, playMode, 0);
+		Cmd_Unlock();
 	} else {
 		Log_Println("AUDIO: No path variable set", LOGLEVEL_ERROR);
 	}
@@ -1612,8 +1831,10 @@ void explorerHandleAudioRequest(AsyncWebServerRequest *request) {
 
 // Handles track progress requests
 void handleTrackProgressRequest(AsyncWebServerRequest *request) {
+	playerState_t state;
+	AudioPlayer_GetState(state);
 	String json = "{\"trackProgress\":{";
-	json += "\"posPercent\":" + String(gPlayProperties.currentRelPos);
+	json += "\"posPercent\":" + String(state.currentRelPos);
 	json += ",\"time\":" + String(AudioPlayer_GetCurrentTime());
 	json += ",\"duration\":" + String(AudioPlayer_GetFileDuration());
 	json += "}}";
@@ -1737,34 +1958,16 @@ static bool tagIdToJSON(const String tagId, JsonObject entry) {
 	if (!s.compareTo("-1")) {
 		return false;
 	}
-	char _file[255];
-	uint32_t _lastPlayPos = 0;
-	uint16_t _trackLastPlayed = 0;
-	uint32_t _mode = 1;
-	char *token;
-	uint8_t i = 1;
-	token = strtok((char *) s.c_str(), stringDelimiter);
-	while (token != NULL) { // Try to extract data from string after lookup
-		if (i == 1) {
-			strncpy(_file, token, sizeof(_file) / sizeof(_file[0]));
-		} else if (i == 2) {
-			_lastPlayPos = strtoul(token, NULL, 10);
-		} else if (i == 3) {
-			_mode = strtoul(token, NULL, 10);
-		} else if (i == 4) {
-			_trackLastPlayed = strtoul(token, NULL, 10);
-		}
-		i++;
-		token = strtok(NULL, stringDelimiter);
-	}
+	rfidEntry_t rfidEntry;
+	Playlist_ParseRfidEntry(s.c_str(), stringDelimiter[0], rfidEntry);
 	entry["id"] = tagId;
-	if (_mode >= 100) {
-		entry["modId"] = _mode;
+	if (rfidEntry.playMode >= 100) {
+		entry["modId"] = rfidEntry.playMode;
 	} else {
-		entry["fileOrUrl"] = _file;
-		entry["playMode"] = _mode;
-		entry["lastPlayPos"] = _lastPlayPos;
-		entry["trackLastPlayed"] = _trackLastPlayed;
+		entry["fileOrUrl"] = rfidEntry.file;
+		entry["playMode"] = rfidEntry.playMode;
+		entry["lastPlayPos"] = rfidEntry.lastPlayPos;
+		entry["trackLastPlayed"] = rfidEntry.trackLastPlayed;
 	}
 	return true;
 }
@@ -1893,6 +2096,7 @@ static void handlePostRFIDRequest(AsyncWebServerRequest *request, JsonVariant &j
 		request->send(500, "text/plain; charset=utf-8", "/rfid (POST): cannot save assignment to NVS");
 		return;
 	}
+	Rfid_GesturesRebuild();
 	Web_DumpNvsToSd("rfidTags", backupFile); // Store backup-file every time when a new rfid-tag is programmed
 	// return the new/modified RFID assignment
 	AsyncJsonResponse *response = new AsyncJsonResponse(false);
@@ -1918,6 +2122,7 @@ static void handleDeleteRFIDRequest(AsyncWebServerRequest *request) {
 			Cmd_Action(CMD_STOP);
 		}
 		if (gPrefsRfid.remove(tagId.c_str())) {
+			Rfid_GesturesRebuild();
 			Log_Printf(LOGLEVEL_INFO, "/rfid (DELETE): tag %s removed successfuly", tagId);
 			request->send(200, "text/plain; charset=utf-8", tagId + " removed successfuly");
 		} else {
@@ -2025,6 +2230,7 @@ void Web_DumpSdToNvs(const char *_filename) {
 	}
 
 	Led_SetPause(false);
+	Rfid_GesturesRebuild();
 	Log_Printf(LOGLEVEL_NOTICE, importCountNokNvs, invalidCount);
 	tmpFile.close();
 	gFSystem.remove(_filename);
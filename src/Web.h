@@ -2,3 +2,4 @@
 
 void Web_Cyclic(void);
 void Web_SendWebsocketData(uint32_t client, uint8_t code);
+bool listNVSKeys(const char *_namespace, void *data, bool (*callback)(const char *key, void *data));
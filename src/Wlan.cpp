@@ -55,6 +55,30 @@ static size_t numKnownNetworks = 0;
 static WiFiSettings knownNetworks[maxSavedNetworks];
 static String hostname;
 
+// state for fast connect: last successful connection, kept in RTC-memory (survives deep-sleep)
+// and NVS (survives power-off; only written if network, BSSID or channel changed)
+struct FastConnectCache {
+	uint32_t magic;
+	char ssid[33];
+	uint8_t bssid[6];
+	uint8_t channel;
+	bool leaseValid; // lease below was received via DHCP and leaseTimestamp is valid (not after power-off)
+	time_t leaseTimestamp; // time() when lease was received
+	uint32_t ip;
+	uint32_t gateway;
+	uint32_t subnet;
+	uint32_t dns1;
+	uint32_t dns2;
+};
+static constexpr uint32_t fastConnectMagic = 0x57464331; // "WFC1"
+static const char *nvsFastConnectKey = "WIFI_FAST";
+RTC_DATA_ATTR static FastConnectCache fastConnectCache;
+static bool cachedLeaseApplied = false;
+static bool fastConnectTried = false;
+static bool fastConnectActive = false; // current connection-attempt uses cached BSSID & channel
+static uint32_t connectionInitTimestamp = 0;
+wlanStats_t gWlanStats;
+
 // state for AP
 DNSServer *dnsServer;
 constexpr uint8_t DNS_PORT = 53;
@@ -110,6 +134,14 @@ void Wlan_Init(void) {
 
 	// ******************* MIGRATION *******************
 
+	// RTC-memory is lost after power-off => take fast connect data from NVS (without lease, as time() restarted)
+	if (fastConnectCache.magic != fastConnectMagic) {
+		if (gPrefsSettings.getBytes(nvsFastConnectKey, &fastConnectCache, sizeof(fastConnectCache)) != sizeof(fastConnectCache) || fastConnectCache.magic != fastConnectMagic) {
+			memset(&fastConnectCache, 0, sizeof(fastConnectCache));
+		}
+		fastConnectCache.leaseValid = false;
+	}
+
 	if (OPMODE_NORMAL != System_GetOperationMode()) {
 		wifiState = WIFI_STATE_END;
 		return;
@@ -127,11 +159,20 @@ void Wlan_Init(void) {
 	handleWifiStateInit();
 }
 
-void connectToKnownNetwork(WiFiSettings settings, byte *bssid = nullptr) {
+void connectToKnownNetwork(WiFiSettings settings, byte *bssid = nullptr, int32_t channel = 0, const FastConnectCache *lease = nullptr) {
 	// set hostname on connect, because when resetting wifi config elsewhere it could be reset
 	if (hostname.compareTo("-1")) {
 		WiFi.setHostname(hostname.c_str());
 	}
+	fastConnectActive = false;
+
+	if (!settings.use_static_ip && lease) {
+		cachedLeaseApplied = WiFi.config(IPAddress(lease->ip), IPAddress(lease->gateway), IPAddress(lease->subnet), IPAddress(lease->dns1), IPAddress(lease->dns2));
+	} else if (cachedLeaseApplied) {
+		// cached lease didn't work => back to DHCP
+		WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+		cachedLeaseApplied = false;
+	}
 
 	if (settings.use_static_ip) {
 		Log_Println(tryStaticIpConfig, LOGLEVEL_NOTICE);
@@ -147,7 +188,48 @@ void connectToKnownNetwork(WiFiSettings settings, byte *bssid = nullptr) {
 
 	Log_Printf(LOGLEVEL_NOTICE, wifiConnectionInProgress, settings.ssid);
 
-	WiFi.begin(settings.ssid, settings.password, 0, bssid);
+	WiFi.begin(settings.ssid, settings.password, channel, bssid);
+}
+
+// Connects directly to BSSID & channel of the last connection (no scan needed).
+// After deep-sleep the last DHCP-lease is reused (if enabled by wifiCachedLeaseTime), so there's no DHCP-handshake either.
+static bool connectFast(const WiFiSettings &settings) {
+	if (fastConnectCache.magic != fastConnectMagic || fastConnectCache.channel == 0 || strncmp(fastConnectCache.ssid, settings.ssid, 32) != 0) {
+		return false;
+	}
+
+	const bool useLease = !settings.use_static_ip && fastConnectCache.leaseValid && wifiCachedLeaseTime > 0 && (uint32_t) (time(NULL) - fastConnectCache.leaseTimestamp) < wifiCachedLeaseTime;
+	Log_Printf(LOGLEVEL_NOTICE, wifiFastConnect, settings.ssid, fastConnectCache.channel, useLease ? ", cached lease" : "");
+	connectToKnownNetwork(settings, fastConnectCache.bssid, fastConnectCache.channel, useLease ? &fastConnectCache : nullptr);
+	fastConnectActive = true;
+	return true;
+}
+
+// Remembers the current connection for fast connect
+static void updateFastConnectCache(void) {
+	const uint8_t *bssid = WiFi.BSSID();
+	const String ssid = WiFi.SSID();
+	const bool networkChanged = fastConnectCache.magic != fastConnectMagic || strncmp(fastConnectCache.ssid, ssid.c_str(), 32) != 0 || (bssid && memcmp(fastConnectCache.bssid, bssid, sizeof(fastConnectCache.bssid)) != 0) || fastConnectCache.channel != WiFi.channel();
+
+	fastConnectCache.magic = fastConnectMagic;
+	strncpy(fastConnectCache.ssid, ssid.c_str(), 32);
+	fastConnectCache.ssid[32] = '\0';
+	if (bssid) {
+		memcpy(fastConnectCache.bssid, bssid, sizeof(fastConnectCache.bssid));
+	}
+	fastConnectCache.channel = WiFi.channel();
+	if (!cachedLeaseApplied) {
+		fastConnectCache.leaseValid = true;
+		fastConnectCache.leaseTimestamp = time(NULL);
+		fastConnectCache.ip = (uint32_t) WiFi.localIP();
+		fastConnectCache.gateway = (uint32_t) WiFi.gatewayIP();
+		fastConnectCache.subnet = (uint32_t) WiFi.subnetMask();
+		fastConnectCache.dns1 = (uint32_t) WiFi.dnsIP(0);
+		fastConnectCache.dns2 = (uint32_t) WiFi.dnsIP(1);
+	}
+	if (networkChanged) {
+		gPrefsSettings.putBytes(nvsFastConnectKey, &fastConnectCache, sizeof(fastConnectCache));
+	}
 }
 
 void handleWifiStateInit() {
@@ -162,6 +244,8 @@ void handleWifiStateInit() {
 	connectionAttemptCounter = 0;
 	connectStartTimestamp = 0;
 	connectionFailedTimestamp = 0;
+	connectionInitTimestamp = millis();
+	fastConnectTried = false;
 	bool scanWiFiOnStart = gPrefsSettings.getBool("ScanWiFiOnStart", false);
 	if (scanWiFiOnStart) {
 		// perform a scan to find the strongest network with same ssid (e.g. for mesh/repeater networks)
@@ -212,6 +296,14 @@ void handleWifiStateConnectLast() {
 	}
 
 	connectStartTimestamp = millis();
+	if (!fastConnectTried) {
+		// first attempt: directly to BSSID & channel of last connection
+		fastConnectTried = true;
+		if (connectFast(lastSettings.value())) {
+			connectionAttemptCounter++;
+			return;
+		}
+	}
 	connectToKnownNetwork(lastSettings.value());
 	connectionAttemptCounter++;
 }
@@ -260,7 +352,7 @@ void handleWifiStateScanConnect() {
 		// check if ssid name matches any saved ssid
 		for (int j = 0; j < numKnownNetworks; j++) {
 			if (strncmp(issid.c_str(), knownNetworks[j].ssid, 32) == 0) {
-				connectToKnownNetwork(knownNetworks[j], bssid);
+				connectToKnownNetwork(knownNetworks[j], bssid, WiFi.channel(i));
 
 				connectStartTimestamp = millis();
 
@@ -308,6 +400,18 @@ void handleWifiStateConnectionSuccess() {
 	Log_Printf(LOGLEVEL_NOTICE, wifiConnectionSuccess, mySSID.c_str(), WiFi.RSSI(), WiFi.channel(), WiFi.BSSIDstr().c_str());
 	Log_Printf(LOGLEVEL_NOTICE, wifiCurrentIp, myIP.toString().c_str());
 
+	gWlanStats.connects++;
+	gWlanStats.connectTime = millis() - connectionInitTimestamp;
+	if (!gWlanStats.bootToIp) {
+		gWlanStats.bootToIp = millis();
+	}
+	if (fastConnectActive) {
+		gWlanStats.fastConnects++;
+	}
+	gWlanStats.cachedLease = cachedLeaseApplied;
+	Log_Printf(LOGLEVEL_NOTICE, wifiBootToIp, gWlanStats.bootToIp, gWlanStats.connectTime);
+	updateFastConnectCache();
+
 	if (!gPrefsSettings.getString("LAST_SSID").equals(mySSID)) {
 		Log_Printf(LOGLEVEL_INFO, wifiSetLastSSID, mySSID.c_str());
 		gPrefsSettings.putString("LAST_SSID", mySSID);
@@ -593,6 +697,18 @@ void Wlan_ToggleEnable(void) {
 	writeWifiStatusToNVS(!wifiEnabled);
 }
 
+// Switch of operation-mode at runtime: WiFi can't be active together with BT
+void Wlan_Start(void) {
+	wifiState = WIFI_STATE_INIT;
+	handleWifiStateInit();
+}
+
+void Wlan_Stop(void) {
+	wifiState = WIFI_STATE_END;
+	WiFi.disconnect(true, true);
+	WiFi.mode(WIFI_OFF); // de-initializes WiFi-driver and frees its memory
+}
+
 // Writes to NVS whether WiFi should be activated
 void writeWifiStatusToNVS(bool wifiStatus) {
 	wifiEnabled = wifiStatus;
@@ -14,6 +14,17 @@ struct WiFiSettings {
 	uint32_t static_dns2;
 };
 
+// Connection timing (boot-to-IP instrumentation)
+typedef struct {
+	uint32_t bootToIp; // ms from boot (or wake-up from deep-sleep) to first IP-address; 0: not connected so far
+	uint32_t connectTime; // ms from start of last connection-attempt (incl. scan) to IP-address
+	uint32_t connects; // successful connections
+	uint32_t fastConnects; // connections via cached BSSID & channel (without scan)
+	bool cachedLease; // current IP-address is the cached DHCP-lease
+} wlanStats_t;
+
+extern wlanStats_t gWlanStats;
+
 void Wlan_Init(void);
 void Wlan_Cyclic(void);
 bool Wlan_AddNetworkSettings(WiFiSettings);
@@ -26,6 +37,8 @@ bool Wlan_ValidateHostname(String);
 bool Wlan_SetHostname(String);
 bool Wlan_IsConnected(void);
 void Wlan_ToggleEnable(void);
+void Wlan_Start(void);
+void Wlan_Stop(void);
 String Wlan_GetIpAddress(void);
 int8_t Wlan_GetRssi(void);
 bool Wlan_ConnectionTryInProgress(void);
@@ -51,6 +51,9 @@ extern const char rfidScannerReady[];
 extern const char rfidTagDetected[];
 extern const char rfid15693TagDetected[];
 extern const char rfidTagReceived[];
+extern const char rfidGestureDetected[];
+extern const char rfidGestureNotAssigned[];
+extern const char rfidGesturesLoaded[];
 extern const char dontAccepctSameRfid[];
 extern const char rfidTagUnknownInNvs[];
 extern const char goToSleepDueToIdle[];
@@ -111,6 +114,7 @@ extern const char unableToMountSd[];
 extern const char unableToCreateVolQ[];
 extern const char unableToCreateRfidQ[];
 extern const char unableToCreateButtonQ[];
+extern const char unableToCreateIdQSet[];
 extern const char unableToCreateMgmtQ[];
 extern const char unableToCreatePlayQ[];
 extern const char initialBrightnessfromNvs[];
@@ -149,6 +153,11 @@ extern const char wifiPwdNotFoundInNvs[];
 extern const char wifiStaticIpConfigNotFoundInNvs[];
 extern const char wifiHostnameNotSet[];
 extern const char mqttConnFailed[];
+extern const char mqttConnLost[];
+extern const char mqttDiscoveryPublished[];
+extern const char mqttBatchInvalid[];
+extern const char mqttTopicUnknown[];
+extern const char mqttShutdownTimeout[];
 extern const char restoredHostnameFromNvs[];
 extern const char currentBattVoltageMsg[];
 extern const char currentSysVoltageMsg[];
@@ -192,6 +201,8 @@ extern const char tryStaticIpConfig[];
 extern const char staticIPConfigFailed[];
 extern const char wakeUpRfidNoCard[];
 extern const char lowPowerCardSuccess[];
+extern const char rfidLpcdIdle[];
+extern const char rfidLpcdWakeup[];
 extern const char rememberLastVolume[];
 extern const char unableToStartFtpServer[];
 extern const char newPlayModeStereo[];
@@ -239,7 +250,23 @@ extern const char wroteLastTrackToNvs[];
 extern const char wifiConnectionInProgress[];
 extern const char wifiConnectionSuccess[];
 extern const char wifiCurrentIp[];
+extern const char wifiFastConnect[];
+extern const char wifiBootToIp[];
+extern const char bootStepTime[];
+extern const char bootReadyTime[];
+extern const char errorWritingFile[];
+extern const char playlistResumeSaved[];
+extern const char playlistResumed[];
+extern const char playlistResumeInvalid[];
+extern const char modeSwitchStarted[];
+extern const char modeSwitchDone[];
+extern const char modeSwitchHeap[];
+extern const char modeSwitchAborted[];
+extern const char audioTaskStopTimeoutMsg[];
+extern const char btClassicMemoryKept[];
 extern const char jsonErrorMsg[];
+extern const char ledAnimationLoaded[];
+extern const char ledAnimationInvalid[];
 extern const char jsonbufferOverflow[];
 extern const char wifiDeleteNetwork[];
 extern const char wifiNetworkLoaded[];
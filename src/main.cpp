@@ -7,6 +7,7 @@
 #include "AudioPlayer.h"
 #include "Battery.h"
 #include "Bluetooth.h"
+#include "Boot.h"
 #include "Button.h"
 #include "Cmd.h"
 #include "Common.h"
@@ -24,6 +25,7 @@
 #include "RotaryEncoder.h"
 #include "SdCard.h"
 #include "System.h"
+#include "Telemetry.h"
 #include "Web.h"
 #include "Wlan.h"
 #include "revision.h"
@@ -110,61 +112,87 @@ void recoverLastRfidPlayedFromNvs(bool force) {
 			return;
 		}
 		recoverLastRfid = false;
+		const uint8_t traceEvent = Boot_TraceBegin("recoverLastRfid");
 		String lastRfidPlayed = gPrefsSettings.getString("lastRfid", "-1");
 		if (!lastRfidPlayed.compareTo("-1")) {
 			Log_Println(unableToRestoreLastRfidFromNVS, LOGLEVEL_INFO);
 		} else {
-			xQueueSend(gRfidCardQueue, lastRfidPlayed.c_str(), 0);
+			Rfid_SendId(gRfidInjectQueue, lastRfidPlayed.c_str());
 			gPlayLastRfIdWhenWiFiConnected = !force;
 			Log_Printf(LOGLEVEL_INFO, restoredLastRfidFromNVS, lastRfidPlayed.c_str());
 		}
+		Boot_TraceEnd(traceEvent);
 	}
 }
 #endif
 
-void setup() {
+// Boot-steps; order has to match Boot_Steps[]
+enum bootStepId_t : uint8_t {
+	BOOT_CORE = 0,
+	BOOT_BUTTONS,
+	BOOT_SYSTEM,
+	BOOT_I2C,
+	BOOT_HALLSENSOR,
+	BOOT_PORT,
+	BOOT_POWER,
+	BOOT_BATTERY,
+	BOOT_AUDIO,
+	BOOT_PERIPHERALS,
+	BOOT_LED,
+	BOOT_CODEC,
+	BOOT_SDCARD,
+	BOOT_WLAN,
+	BOOT_INFO,
+	BOOT_FTP,
+	BOOT_MQTT,
+	BOOT_RFID,
+	BOOT_ROTARY,
+	BOOT_BLUETOOTH,
+	BOOT_IR,
+	BOOT_DISPATCHER,
+	BOOT_STEP_COUNT
+};
+
+static void Boot_Core(void) {
 	Log_Init();
 	Queues_Init();
+	Cmd_Init();
+	Telemetry_Init();
+}
 
-	// Make sure all wakeups can be enabled *before* initializing RFID, which can enter sleep immediately
+// Make sure all wakeups can be enabled *before* initializing RFID, which can enter sleep immediately
+static void Boot_Buttons(void) {
 	Button_Init(); // To preseed internal button-storage with values
 #ifdef PN5180_ENABLE_LPCD
 	Rfid_Init();
 #endif
-
-	System_Init();
+}
 
 // Init 2nd i2c-bus if RC522 is used with i2c or if port-expander is enabled
+static void Boot_I2c(void) {
 #ifdef I2C_2_ENABLE
 	i2cBusTwo.begin(ext_IIC_DATA, ext_IIC_CLK);
 	delay(50);
 	Log_Println(rfidScannerReady, LOGLEVEL_DEBUG);
 #endif
+}
 
+static void Boot_HallSensor(void) {
 #ifdef HALLEFFECT_SENSOR_ENABLE
 	gHallEffectSensor.init();
 #endif
+}
 
-	// Needs i2c first if port-expander is used
-	Port_Init();
-
-	// If port-expander is used, port_init has to be called first, as power can be (possibly) done by port-expander
-	Power_Init();
-
-	Battery_Init();
-
-	// Init audio before power on to avoid speaker noise
-	AudioPlayer_Init();
-
-	// All checks that could send us to sleep are done, power up fully
+// All checks that could send us to sleep are done, power up fully
+static void Boot_Peripherals(void) {
 	Power_PeripheralOn();
 
 	memset(&gPlayProperties, 0, sizeof(gPlayProperties));
 	gPlayProperties.playlistFinished = true;
-
-	Led_Init();
+}
 
 // Only used for ESP32-A1S-Audiokit
+static void Boot_Codec(void) {
 #if (HAL == 2)
 	i2cBusOne.begin(IIC_DATA, IIC_CLK, 40000);
 
@@ -178,10 +206,31 @@ void setup() {
 	digitalWrite(22, HIGH);
 	ac.SetVolumeHeadphone(80);
 #endif
+}
 
-	// Needs power first
+static void Boot_SdCard(void) {
+	uint8_t traceEvent = Boot_TraceBegin("SdCard_Init");
 	SdCard_Init();
+	Boot_TraceEnd(traceEvent);
+	// print SD card info
+	traceEvent = Boot_TraceBegin("SdCard_Info");
+	SdCard_PrintInfo();
+	Boot_TraceEnd(traceEvent);
+}
 
+// Association is started right away, so it runs in parallel to SD-mount and RFID-bring-up
+static void Boot_Wlan(void) {
+	uint8_t traceEvent = Boot_TraceBegin("Wlan_Init");
+	Wlan_Init();
+	Boot_TraceEnd(traceEvent);
+	if (OPMODE_NORMAL == System_GetOperationMode()) {
+		traceEvent = Boot_TraceBegin("Wlan_Connect");
+		Wlan_Cyclic();
+		Boot_TraceEnd(traceEvent);
+	}
+}
+
+static void Boot_Info(void) {
 	// welcome message
 	Serial.print(logo);
 
@@ -192,30 +241,60 @@ void setup() {
 	Log_Printf(LOGLEVEL_NOTICE, "ESP-IDF version: %s", ESP.getSdkVersion());
 
 	// print wake-up reason
+	const uint8_t traceEvent = Boot_TraceBegin("WakeUpReason");
 	System_ShowWakeUpReason();
-	// print SD card info
-	SdCard_PrintInfo();
+	Boot_TraceEnd(traceEvent);
+}
 
-	Ftp_Init();
-	Mqtt_Init();
+static void Boot_Rfid(void) {
 #ifndef PN5180_ENABLE_LPCD
 	#if defined(RFID_READER_TYPE_MFRC522_SPI) || defined(RFID_READER_TYPE_MFRC522_I2C) || defined(RFID_READER_TYPE_PN5180)
 	Rfid_Init();
 	#endif
 #endif
-	RotaryEncoder_Init();
-	Wlan_Init();
-	Bluetooth_Init();
+}
 
-	if (OPMODE_NORMAL == System_GetOperationMode()) {
-		Wlan_Cyclic();
-	}
+#ifdef SINGLE_SPI_ENABLE
+constexpr uint32_t bootRfidSpiDependency = BOOT_DEP(BOOT_SDCARD); // RFID-reader shares SPI-bus with SD
+#else
+constexpr uint32_t bootRfidSpiDependency = 0u;
+#endif
 
-	IrReceiver_Init();
+static const bootStep_t Boot_Steps[BOOT_STEP_COUNT] = {
+	{"core", Boot_Core, 0u, false},
+	{"buttons", Boot_Buttons, BOOT_DEP(BOOT_CORE), false},
+	{"system", System_Init, BOOT_DEP(BOOT_CORE), false},
+	{"i2c", Boot_I2c, BOOT_DEP(BOOT_CORE), false},
+	{"hallSensor", Boot_HallSensor, BOOT_DEP(BOOT_SYSTEM), false},
+	{"port", Port_Init, BOOT_DEP(BOOT_I2C), false}, // Needs i2c first if port-expander is used
+	{"power", Power_Init, BOOT_DEP(BOOT_PORT), false}, // Power can be (possibly) done by port-expander
+	{"battery", Battery_Init, BOOT_DEP(BOOT_SYSTEM), false},
+	{"audio", AudioPlayer_Init, BOOT_DEP(BOOT_SYSTEM), false},
+	{"peripherals", Boot_Peripherals, BOOT_DEP(BOOT_POWER) | BOOT_DEP(BOOT_BATTERY) | BOOT_DEP(BOOT_AUDIO), false}, // Init audio before power on to avoid speaker noise
+	{"led", Led_Init, BOOT_DEP(BOOT_PERIPHERALS), false},
+	{"codec", Boot_Codec, BOOT_DEP(BOOT_PERIPHERALS), false},
+	{"sdcard", Boot_SdCard, BOOT_DEP(BOOT_PERIPHERALS), true}, // Needs power first
+	{"wlan", Boot_Wlan, BOOT_DEP(BOOT_SYSTEM), false},
+	{"info", Boot_Info, BOOT_DEP(BOOT_SYSTEM), false},
+	{"ftp", Ftp_Init, BOOT_DEP(BOOT_SYSTEM), false},
+	{"mqtt", Mqtt_Init, BOOT_DEP(BOOT_SYSTEM), false},
+	{"rfid", Boot_Rfid, BOOT_DEP(BOOT_PERIPHERALS) | bootRfidSpiDependency, true},
+	{"rotary", RotaryEncoder_Init, BOOT_DEP(BOOT_PORT), false},
+	{"bluetooth", Bluetooth_Init, BOOT_DEP(BOOT_AUDIO), false},
+	{"ir", IrReceiver_Init, BOOT_DEP(BOOT_SYSTEM), false},
+	{"dispatcher", Rfid_DispatcherInit, BOOT_DEP(BOOT_SDCARD) | BOOT_DEP(BOOT_RFID), false}, // RFID-tags are handled from now on
+};
+static_assert(BOOT_STEP_COUNT <= bootMaxSteps, "Too many boot-steps");
+
+void setup() {
+	Boot_Run(Boot_Steps, BOOT_STEP_COUNT);
 	System_UpdateActivityTimer(); // initial set after boot
 	Led_Indicate(LedIndicatorType::BootComplete);
+	Led_LoadAnimations(); // needs SD; parsed here as the stack of the LED-task is too small
 
-	Log_Printf(LOGLEVEL_DEBUG, "%s: %u", freeHeapAfterSetup, ESP.getFreeHeap());
+	gModeSwitchStats.bootHeap = ESP.getFreeHeap();
+	gModeSwitchStats.bootMode = System_GetOperationMode();
+	Log_Printf(LOGLEVEL_DEBUG, "%s: %u", freeHeapAfterSetup, gModeSwitchStats.bootHeap);
 	if (psramFound()) {
 		Log_Printf(LOGLEVEL_DEBUG, "PSRAM: %u bytes", ESP.getPsramSize());
 	} else {
@@ -262,11 +341,13 @@ void loop() {
 	AudioPlayer_Cyclic();
 	vTaskDelay(portTICK_PERIOD_MS * 1u);
 	Battery_Cyclic();
+	Telemetry_Cyclic();
+	Rfid_Cyclic();
 	// Port_Cyclic(); // called by button (controlled via hw-timer)
 	Button_Cyclic();
+	Led_Cyclic();
 	vTaskDelay(portTICK_PERIOD_MS * 1u);
 	System_Cyclic();
-	Rfid_PreferenceLookupHandler();
 
 #ifdef PLAY_LAST_RFID_AFTER_REBOOT
 	recoverBootCountFromNvs();
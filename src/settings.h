@@ -53,6 +53,7 @@
 	//#define USE_LAST_VOLUME_AFTER_REBOOT  // Remembers the volume used at last shutdown after reboot
 	#define USEROTARY_ENABLE                // If rotary-encoder is used (don't forget to review WAKEUP_BUTTON if you disable this feature!)
 	#define BLUETOOTH_ENABLE                // If enabled and bluetooth-mode is active, you can stream to your ESPuino or to a headset via bluetooth (a2dp-sink & a2dp-source). Note: This feature consumes a lot of resources and the available flash/ram might not be sufficient.
+	//#define RUNTIME_MODE_SWITCH_ENABLE      // Switch between normal & BT-modes without reboot (needs BLUETOOTH_ENABLE). Costs heap in normal mode, as memory of classic BT isn't released (compare "bootHeap" in /debug with & without this option)
 	//#define IR_CONTROL_ENABLE             // Enables remote control (https://forum.espuino.de/t/neues-feature-fernsteuerung-per-infrarot-fernbedienung/265)
 	//#define PAUSE_WHEN_RFID_REMOVED       // Playback starts when card is applied and pauses automatically, when card is removed (https://forum.espuino.de/t/neues-feature-pausieren-wenn-rfid-karte-entfernt-wurde/541)
 	//#define PAUSE_ON_MIN_VOLUME           // When playback is active and volume is changed to zero, playback is paused automatically. Playback is continued if volume reaches 1. (https://forum.espuino.de/t/neues-feature-pausieren-wenn-rfid-karte-entfernt-wurde/541)
@@ -83,7 +84,7 @@
 	#endif
 
 	#ifdef RFID_READER_TYPE_PN5180
-		//#define PN5180_ENABLE_LPCD        // Wakes up ESPuino if RFID-tag was applied while deepsleep is active. Only ISO-14443-tags are supported for wakeup!
+		//#define PN5180_ENABLE_LPCD        // Wakes up ESPuino if RFID-tag was applied while deepsleep is active. Only ISO-14443-tags are supported for wakeup! Also used to save power while no RFID-tag is applied for some time.
 	#endif
 
 	#if defined(RFID_READER_TYPE_MFRC522_I2C) || defined(RFID_READER_TYPE_MFRC522_SPI)
@@ -205,6 +206,11 @@
 	// RFID-RC522
 	#define RFID_SCAN_INTERVAL 100                      // Interval-time in ms (how often is RFID read?)
 
+	// RFID-gestures: two cards applied one after another or a card held on the reader show up as their own RFID-id (starting with 91/92) in GUI & log.
+	// Assign it like a normal RFID-tag; if there's no assignment, it's only shown (playback isn't affected). Only cards from the reader are part of gestures (not RFID-ids sent via MQTT).
+	constexpr uint16_t rfidSequenceTimeout = 5000;      // Second card has to be applied within this time (in ms) to be recognized as sequence
+	constexpr uint16_t rfidHoldTime = 3000;             // Card has to be held on the reader for this time (in ms); needs a reader that detects removal (PN5180 or PAUSE_WHEN_RFID_REMOVED)
+
 	// Automatic restart
 	#ifdef SHUTDOWN_IF_SD_BOOT_FAILS
 		constexpr uint32_t deepsleepTimeAfterBootFails = 20;      // Automatic restart takes place if boot was not successful after this period (in seconds)
@@ -223,12 +229,14 @@
 	// ESPuino will create a WiFi if joing existing WiFi was not possible. Name and password can be configured here.
 	constexpr const char accessPointNetworkSSID[] = "ESPuino";     // Access-point's SSID
 	constexpr const char accessPointNetworkPassword[] = "";        // Access-point's Password, at least 8 characters! Set to an empty string to spawn an open WiFi.
+	constexpr uint32_t wifiCachedLeaseTime = 0;                    // (s) After deep-sleep the last DHCP-lease is reused without asking the DHCP-server if it isn't older. Only use if your router's lease-time is longer! 0 = disabled
 
 	// Bluetooth
 	constexpr const char nameBluetoothSinkDevice[] = "ESPuino";        // Name of your ESPuino as Bluetooth-device
 
 	// Where to store the backup-file for NVS-records
 	constexpr const char backupFile[] = "/backup.txt"; // File is written every time a (new) RFID-assignment via GUI is done
+	constexpr const char playlistResumeFile[] = "/.resume.m3u"; // (PLAY_LAST_RFID_AFTER_REBOOT) Playlist is written here before deep-sleep to resume without enumerating the directory again
 
 	//#################### Settings for optional Modules##############################
 	// (optinal) Neopixel
@@ -242,8 +250,8 @@
 		#define OFFSET_PAUSE_LEDS		false		// if true the pause-leds are centered in the mid of the LED-Strip
 		#define PROGRESS_HUE_START		85          	// Start and end hue of mulitple-LED progress indicator. Hue ranges from basically 0 - 255, but you can also set numbers outside this range to get the desired effect (e.g. 85-215 will go from green to purple via blue, 341-215 start and end at exactly the same color but go from green to purple via yellow and red)
 		#define PROGRESS_HUE_END		-1
-		#define DIMMABLE_STATES			50		// Number of dimmed values between two full LEDs (https://forum.espuino.de/t/led-verbesserungen-rework/1739)
 		//#define LED_OFFSET                		0           	// shifts the starting LED in the original direction of the neopixel ring
+		constexpr const char ledAnimationsFile[] = "/animations.json";	// (optional) replaces LED-animations by name, e.g. "error" or "idle" (names: LedAnimationDefaults.h, format: see Led_ParseAnimation() in Led.cpp)
 	#endif
 
 	#if defined(MEASURE_BATTERY_ESP32) || defined(MEASURE_BATTERY_MAX17055) || defined(MEASURE_BATTERY_BQ2589X)
@@ -304,8 +312,9 @@
 
 	// (optional) Topics for MQTT
 	#ifdef MQTT_ENABLE
-		constexpr uint16_t mqttRetryInterval = 60;                // Try to reconnect to MQTT-server every (n) seconds if connection is broken
-		constexpr uint8_t mqttMaxRetriesPerInterval = 1;          // Number of retries per time-interval (mqttRetryInterval). mqttRetryInterval 60 / mqttMaxRetriesPerInterval 1 => once every 60s
+		constexpr uint16_t mqttRetryInterval = 60;                // Max. interval (s) between attempts to reconnect to MQTT-server (exponential back-off, starting with 1s)
+		constexpr uint16_t mqttPublishBatchTime = 50;             // Outgoing MQTT-messages are collected for (n) ms and sent in one go (several updates of a topic => only the last one is sent)
+		constexpr const char mqttDiscoveryPrefix[] = "homeassistant";  // Prefix for Home Assistant MQTT-discovery (empty: discovery disabled)
 		#define DEVICE_HOSTNAME "ESP32-ESPuino"         // Name that is used for MQTT
 		constexpr const char topicSleepCmnd[] = "Cmnd/ESPuino/Sleep";
 		constexpr const char topicSleepState[] = "State/ESPuino/Sleep";
@@ -327,8 +336,11 @@
 		constexpr const char topicRepeatModeState[] = "State/ESPuino/RepeatMode";
 		constexpr const char topicLedBrightnessCmnd[] = "Cmnd/ESPuino/LedBrightness";
 		constexpr const char topicLedBrightnessState[] = "State/ESPuino/LedBrightness";
+		constexpr const char topicBatchCmnd[] = "Cmnd/ESPuino/Batch";
 		constexpr const char topicWiFiRssiState[] = "State/ESPuino/WifiRssi";
 		constexpr const char topicSRevisionState[] = "State/ESPuino/SoftwareRevision";
+		constexpr const char topicAudioStatsState[] = "State/ESPuino/AudioStats";
+		constexpr const char topicRfidStatsState[] = "State/ESPuino/RfidStats";
 		#ifdef BATTERY_MEASURE_ENABLE
 		constexpr const char topicBatteryVoltage[] = "State/ESPuino/Voltage";
 		constexpr const char topicBatterySOC[]     = "State/ESPuino/Battery";
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""Checks MQTT-reconnect against a local stand-in broker (mosquitto) on a running ESPuino.
+
+The device has to be configured to use this host as MQTT-server (port --port). The script
+ 1. starts mosquitto and waits until the device has connected,
+ 2. stops mosquitto for --down seconds and checks by /telemetry (maxLoopMs) that the
+    Arduino-loop isn't blocked while the broker is down and by /debug (mqtt.connectFailures)
+    that reconnects back off exponentially,
+ 3. starts mosquitto again and checks that the device reconnects within mqttRetryInterval.
+
+Usage: python3 check_backoff.py --device 192.168.1.50 [--port 1883] [--down 90] [--max-loop-ms 200]
+Needs python3 (stdlib only) and mosquitto in PATH. Exit-code 0 if all checks passed.
+"""
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+import urllib.request
+
+TELEMETRY_INTERVAL = 5  # s, telemetrySampleInterval
+BACKOFF_MIN = 1.0  # s, Mqtt_BackoffMin
+BACKOFF_JITTER = 0.25  # +-25%
+
+
+def get_json(device, path):
+    with urllib.request.urlopen("http://%s%s" % (device, path), timeout=10) as response:
+        return json.load(response)
+
+
+def mqtt_stats(device):
+    return get_json(device, "/debug")["mqtt"]
+
+
+def start_broker(port, workdir):
+    config = os.path.join(workdir, "mosquitto.conf")
+    with open(config, "w") as f:
+        f.write("listener %d 0.0.0.0\nallow_anonymous true\npersistence false\n" % port)
+    broker = subprocess.Popen(["mosquitto", "-c", config], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    time.sleep(1)
+    if broker.poll() is not None:
+        sys.exit("mosquitto didn't start (port %d in use?)" % port)
+    return broker
+
+
+def stop_broker(broker):
+    broker.terminate()
+    broker.wait(timeout=10)
+
+
+def wait_for_connect(device, connects, timeout):
+    """Returns seconds until mqtt.connects got bigger than connects (None on timeout)"""
+    start = time.monotonic()
+    while time.monotonic() - start < timeout:
+        if mqtt_stats(device)["connects"] > connects:
+            return time.monotonic() - start
+        time.sleep(0.5)
+    return None
+
+
+def max_attempts(down, retry_interval):
+    """Maximum number of connect-attempts within down seconds with the shortest possible back-off"""
+    attempts, elapsed, backoff = 1, 0.0, BACKOFF_MIN  # first attempt right after the connection was lost
+    while True:
+        elapsed += backoff * (1.0 - BACKOFF_JITTER)
+        if elapsed > down:
+            return attempts
+        attempts += 1
+        backoff = min(backoff * 2, retry_interval)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--device", required=True, help="IP or hostname of ESPuino")
+    parser.add_argument("--port", type=int, default=1883, help="port of the stand-in broker")
+    parser.add_argument("--down", type=int, default=90, help="seconds the broker is down")
+    parser.add_argument("--max-loop-ms", type=int, default=200, help="allowed longest Arduino-loop while the broker is down")
+    parser.add_argument("--retry-interval", type=int, default=60, help="mqttRetryInterval (s) of the firmware")
+    args = parser.parse_args()
+
+    if shutil.which("mosquitto") is None:
+        sys.exit("mosquitto not found")
+
+    failed = []
+
+    def check(ok, msg):
+        print("%s: %s" % ("PASS" if ok else "FAIL", msg))
+        if not ok:
+            failed.append(msg)
+
+    stats = mqtt_stats(args.device)
+    if not stats["enabled"]:
+        sys.exit("MQTT isn't enabled on %s" % args.device)
+
+    with tempfile.TemporaryDirectory() as workdir:
+        # no broker was running on this port before (mosquitto wouldn't start), so the device connects anew
+        broker = start_broker(args.port, workdir)
+        try:
+            if wait_for_connect(args.device, stats["connects"], args.retry_interval * (1.0 + BACKOFF_JITTER) + 10) is None:
+                sys.exit("%s doesn't connect to this host (MQTT-server set to it?)" % args.device)
+
+            # broker down
+            stop_broker(broker)
+            broker = None
+            down_start = time.monotonic()
+            failures_before = mqtt_stats(args.device)["connectFailures"]
+            time.sleep(args.down)
+            failures = mqtt_stats(args.device)["connectFailures"] - failures_before
+            down_duration = time.monotonic() - down_start
+
+            telemetry = get_json(args.device, "/telemetry")
+            # samples taken completely within the down-time
+            samples = telemetry["samples"][-max(1, int(down_duration) // TELEMETRY_INTERVAL - 1):]
+            max_loop = max(sample["maxLoopMs"] for sample in samples)
+            check(max_loop <= args.max_loop_ms, "longest loop while broker is down: %u ms (max. %u ms, %u samples)" % (max_loop, args.max_loop_ms, len(samples)))
+            check(failures >= 2, "failed reconnects while broker is down: %u (at least 2)" % failures)
+            limit = max_attempts(down_duration, args.retry_interval)
+            check(failures <= limit, "failed reconnects while broker is down: %u (back-off allows %u)" % (failures, limit))
+
+            # broker up again
+            connects = mqtt_stats(args.device)["connects"]
+            broker = start_broker(args.port, workdir)
+            timeout = args.retry_interval * (1.0 + BACKOFF_JITTER) + 10
+            reconnect = wait_for_connect(args.device, connects, timeout)
+            check(reconnect is not None, "reconnect after broker is back: %s (max. %u s)" % ("%.1f s" % reconnect if reconnect is not None else "none", timeout))
+        finally:
+            if broker:
+                stop_broker(broker)
+
+    print("%u check(s) failed" % len(failed) if failed else "all checks passed")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
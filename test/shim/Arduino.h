@@ -0,0 +1,227 @@
+// Host-shim of the Arduino-core (native env): only the parts that are used by the firmware-modules under test.
+// Clock is the host-clock plus an offset, so tests can skip timeouts (Shim_AdvanceMillis()) without waiting.
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "freertos/FreeRTOS.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH		 1
+#define LOW			 0
+#define INPUT		 0x01
+#define OUTPUT		 0x03
+#define INPUT_PULLUP 0x05
+
+inline uint32_t Shim_MillisOffset = 0;
+inline bool Shim_Psram = false; // psramInit()/psramFound()
+
+inline void Shim_AdvanceMillis(const uint32_t ms) {
+	Shim_MillisOffset += ms;
+}
+
+inline uint32_t micros(void) {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline uint32_t millis(void) {
+	return micros() / 1000u + Shim_MillisOffset;
+}
+
+inline void delay(const uint32_t ms) {
+	Shim_AdvanceMillis(ms);
+}
+
+inline void vTaskDelay(const TickType_t ticks) {
+	Shim_AdvanceMillis(ticks);
+}
+
+inline long random(const long max) {
+	return (max > 0) ? rand() % max : 0;
+}
+
+inline long random(const long min, const long max) {
+	return (max > min) ? min + rand() % (max - min) : min;
+}
+
+inline long map(const long x, const long inMin, const long inMax, const long outMin, const long outMax) {
+	return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+inline void pinMode(uint8_t, uint8_t) {
+}
+
+inline void digitalWrite(uint8_t, uint8_t) {
+}
+
+inline int digitalRead(uint8_t) {
+	return LOW;
+}
+
+inline void esp_deep_sleep_start(void) {
+}
+
+inline bool psramInit(void) {
+	return Shim_Psram;
+}
+
+inline bool psramFound(void) {
+	return Shim_Psram;
+}
+
+inline void *ps_malloc(const size_t size) {
+	return malloc(size);
+}
+
+inline void *ps_calloc(const size_t count, const size_t size) {
+	return calloc(count, size);
+}
+
+class String {
+public:
+	String() { }
+	String(const char *str)
+		: str(str ? str : "") { }
+	String(const std::string &str)
+		: str(str) { }
+	String(const char c)
+		: str(1, c) { }
+	String(const int value)
+		: str(std::to_string(value)) { }
+	String(const unsigned int value)
+		: str(std::to_string(value)) { }
+	String(const long value)
+		: str(std::to_string(value)) { }
+	String(const unsigned long value)
+		: str(std::to_string(value)) { }
+
+	const char *c_str() const { return str.c_str(); }
+	unsigned int length() const { return str.length(); }
+	bool isEmpty() const { return str.empty(); }
+	int compareTo(const String &other) const { return str.compare(other.str); }
+	bool equals(const String &other) const { return str == other.str; }
+	bool startsWith(const String &prefix) const { return str.compare(0, prefix.str.size(), prefix.str) == 0; }
+	bool endsWith(const String &suffix) const { return str.size() >= suffix.str.size() && str.compare(str.size() - suffix.str.size(), suffix.str.size(), suffix.str) == 0; }
+	int indexOf(const char c, const unsigned int from = 0) const {
+		const size_t pos = str.find(c, from);
+		return (pos == std::string::npos) ? -1 : (int) pos;
+	}
+	int indexOf(const String &s, const unsigned int from = 0) const {
+		const size_t pos = str.find(s.str, from);
+		return (pos == std::string::npos) ? -1 : (int) pos;
+	}
+	String substring(const unsigned int from) const { return (from < str.size()) ? String(str.substr(from)) : String(); }
+	String substring(const unsigned int from, const unsigned int to) const { return (from < to && from < str.size()) ? String(str.substr(from, to - from)) : String(); }
+	long toInt() const { return strtol(str.c_str(), nullptr, 10); }
+	void trim() {
+		const size_t start = str.find_first_not_of(" \t\r\n");
+		const size_t end = str.find_last_not_of(" \t\r\n");
+		str = (start == std::string::npos) ? std::string() : str.substr(start, end - start + 1);
+	}
+	bool concat(const String &other) {
+		str += other.str;
+		return true;
+	}
+
+	char operator[](const unsigned int index) const { return (index < str.size()) ? str[index] : '\0'; }
+	char &operator[](const unsigned int index) { return str[index]; }
+	String &operator+=(const String &other) {
+		str += other.str;
+		return *this;
+	}
+	String &operator+=(const char *other) {
+		str += other;
+		return *this;
+	}
+	String &operator+=(const char c) {
+		str += c;
+		return *this;
+	}
+	friend String operator+(const String &a, const String &b) { return String(a.str + b.str); }
+	friend String operator+(const String &a, const char *b) { return String(a.str + b); }
+	friend String operator+(const char *a, const String &b) { return String(a + b.str); }
+	bool operator==(const String &other) const { return str == other.str; }
+	bool operator==(const char *other) const { return str == other; }
+	bool operator!=(const String &other) const { return str != other.str; }
+	bool operator!=(const char *other) const { return str != other; }
+	bool operator<(const String &other) const { return str < other.str; }
+
+private:
+	std::string str;
+};
+
+class Print {
+public:
+	virtual ~Print() { }
+	virtual size_t write(uint8_t c) = 0;
+	virtual size_t write(const uint8_t *buffer, size_t size) {
+		size_t written = 0;
+		while (size-- && write(*buffer++)) {
+			written++;
+		}
+		return written;
+	}
+	size_t write(const char *str) { return write((const uint8_t *) str, strlen(str)); }
+	size_t print(const char *str) { return write(str); }
+	size_t print(const char c) { return write((uint8_t) c); }
+	size_t print(const String &str) { return write(str.c_str()); }
+	size_t print(const unsigned int value) { return print(String(value)); }
+	size_t print(const int value) { return print(String(value)); }
+	size_t println(const char *str = "") { return print(str) + print('\n'); }
+	size_t println(const String &str) { return print(str) + print('\n'); }
+	size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+		char buffer[256];
+		va_list args;
+		va_start(args, format);
+		const int length = vsnprintf(buffer, sizeof(buffer), format, args);
+		va_end(args);
+		if (length < 0) {
+			return 0;
+		}
+		if ((size_t) length < sizeof(buffer)) {
+			return write((const uint8_t *) buffer, length);
+		}
+		std::string large(length + 1, '\0');
+		va_start(args, format);
+		vsnprintf(&large[0], large.size(), format, args);
+		va_end(args);
+		return write((const uint8_t *) large.c_str(), length);
+	}
+};
+
+class Stream : public Print {
+public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+	String readStringUntil(const char terminator) {
+		std::string result;
+		for (int c = read(); c >= 0 && c != terminator; c = read()) {
+			result += (char) c;
+		}
+		return String(result);
+	}
+};
+
+// Heap isn't tracked on host
+class EspClass {
+public:
+	uint32_t getFreeHeap(void) { return 0; }
+	uint32_t getMinFreeHeap(void) { return 0; }
+	uint32_t getMaxAllocHeap(void) { return 0; }
+	uint32_t getFreePsram(void) { return 0; }
+	void restart(void) { }
+};
+
+inline EspClass ESP;
@@ -0,0 +1,173 @@
+// Host-shim of the Arduino-filesystem (native env): paths of the firmware are mapped to a directory of the host
+// (Shim_FsRoot), so SD-card-contents can be built by the test.
+#pragma once
+
+#include "Arduino.h"
+
+#include <dirent.h>
+#include <memory>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FILE_READ	"r"
+#define FILE_WRITE	"w"
+#define FILE_APPEND "a"
+
+inline std::string Shim_FsRoot = "/tmp";
+
+namespace fs {
+
+class File : public Stream {
+public:
+	File() { }
+	File(const char *path, const char *mode) {
+		struct stat info;
+		const std::string hostPath = Shim_FsRoot + path;
+		if (strcmp(mode, FILE_READ) == 0 && stat(hostPath.c_str(), &info) != 0) {
+			return;
+		}
+		impl = std::make_shared<Impl>();
+		impl->path = path;
+		if (strcmp(mode, FILE_READ) == 0 && S_ISDIR(info.st_mode)) {
+			impl->dir = opendir(hostPath.c_str());
+		} else {
+			impl->file = fopen(hostPath.c_str(), (strcmp(mode, FILE_READ) == 0) ? "rb" : (strcmp(mode, FILE_APPEND) == 0) ? "ab"
+																													  : "wb");
+		}
+		if (!impl->dir && !impl->file) {
+			impl.reset();
+		}
+	}
+
+	operator bool() const { return impl != nullptr; }
+	bool isDirectory() const { return impl && impl->dir; }
+	const char *path() const { return impl ? impl->path.c_str() : nullptr; }
+	const char *name() const {
+		const char *slash = impl ? strrchr(impl->path.c_str(), '/') : nullptr;
+		return slash ? slash + 1 : path();
+	}
+	size_t size() const {
+		struct stat info;
+		return (impl && impl->file && fstat(fileno(impl->file), &info) == 0) ? info.st_size : 0;
+	}
+	size_t position() const { return (impl && impl->file) ? ftell(impl->file) : 0; }
+	bool seek(const uint32_t pos) { return impl && impl->file && fseek(impl->file, pos, SEEK_SET) == 0; }
+	void close() { impl.reset(); }
+
+	int available() override { return (impl && impl->file) ? (int) (size() - position()) : 0; }
+	int read() override { return (impl && impl->file) ? fgetc(impl->file) : -1; }
+	size_t read(uint8_t *buffer, const size_t size) { return (impl && impl->file) ? fread(buffer, 1, size, impl->file) : 0; }
+	int peek() override {
+		const int c = read();
+		if (c >= 0) {
+			ungetc(c, impl->file);
+		}
+		return c;
+	}
+	using Print::write;
+	size_t write(uint8_t c) override { return (impl && impl->file && fputc(c, impl->file) != EOF) ? 1 : 0; }
+	size_t write(const uint8_t *buffer, size_t size) override { return (impl && impl->file) ? fwrite(buffer, 1, size, impl->file) : 0; }
+
+	// Next entry of a directory as full path (empty if there's none left)
+	String getNextFileName(bool *isDir = nullptr) {
+		if (!isDirectory()) {
+			return String();
+		}
+		for (struct dirent *entry = readdir(impl->dir); entry != nullptr; entry = readdir(impl->dir)) {
+			if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+				continue;
+			}
+			const std::string path = impl->path + (impl->path.back() == '/' ? "" : "/") + entry->d_name;
+			if (isDir) {
+				struct stat info;
+				*isDir = stat((Shim_FsRoot + path).c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+			}
+			return String(path);
+		}
+		return String();
+	}
+
+	File openNextFile(const char *mode = FILE_READ) {
+		const String path = getNextFileName();
+		return path.isEmpty() ? File() : File(path.c_str(), mode);
+	}
+
+	void rewindDirectory() {
+		if (isDirectory()) {
+			rewinddir(impl->dir);
+		}
+	}
+
+private:
+	struct Impl {
+		std::string path;
+		FILE *file = nullptr;
+		DIR *dir = nullptr;
+		~Impl() {
+			if (file) {
+				fclose(file);
+			}
+			if (dir) {
+				closedir(dir);
+			}
+		}
+	};
+	std::shared_ptr<Impl> impl;
+};
+
+class FS {
+public:
+	virtual ~FS() { }
+	File open(const char *path, const char *mode = FILE_READ, const bool /* create */ = false) { return File(path, mode); }
+	File open(const String &path, const char *mode = FILE_READ, const bool /* create */ = false) { return File(path.c_str(), mode); }
+	bool exists(const char *path) {
+		struct stat info;
+		return stat((Shim_FsRoot + path).c_str(), &info) == 0;
+	}
+	bool exists(const String &path) { return exists(path.c_str()); }
+	bool remove(const char *path) { return unlink((Shim_FsRoot + path).c_str()) == 0; }
+	bool rename(const char *from, const char *to) { return ::rename((Shim_FsRoot + from).c_str(), (Shim_FsRoot + to).c_str()) == 0; }
+	bool mkdir(const char *path) { return ::mkdir((Shim_FsRoot + path).c_str(), 0700) == 0; }
+	bool rmdir(const char *path) { return ::rmdir((Shim_FsRoot + path).c_str()) == 0; }
+};
+
+} // namespace fs
+
+using fs::File;
+
+typedef enum {
+	CARD_NONE,
+	CARD_MMC,
+	CARD_SD,
+	CARD_SDHC,
+	CARD_UNKNOWN
+} sdcard_type_t;
+
+#define HSPI 2
+#define VSPI 3
+
+class SPIClass {
+public:
+	SPIClass(const uint8_t /* bus */ = HSPI) { }
+	void begin(int8_t /* sck */ = -1, int8_t /* miso */ = -1, int8_t /* mosi */ = -1, int8_t /* ss */ = -1) { }
+	void end() { }
+	void setFrequency(const uint32_t /* frequency */) { }
+};
+
+inline SPIClass SPI;
+
+namespace fs {
+
+// SD and SD_MMC: always mounted, card is the directory Shim_FsRoot
+class SDFS : public FS {
+public:
+	template <typename... Args>
+	bool begin(Args...) { return true; }
+	void end() { }
+	sdcard_type_t cardType() { return CARD_SDHC; }
+	uint64_t cardSize() { return 0; }
+	uint64_t totalBytes() { return 0; }
+	uint64_t usedBytes() { return 0; }
+};
+
+} // namespace fs
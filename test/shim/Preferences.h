@@ -0,0 +1,71 @@
+// Host-shim of NVS-preferences (native env): all namespaces are kept in RAM (Shim_Nvs), so a test can set them up and
+// check what the firmware wrote.
+#pragma once
+
+#include "Arduino.h"
+
+#include <map>
+#include <vector>
+
+typedef std::map<std::string, std::vector<uint8_t>> Shim_NvsNamespace;
+inline std::map<std::string, Shim_NvsNamespace> Shim_Nvs;
+
+class Preferences {
+public:
+	bool begin(const char *name, const bool /* readOnly */ = false, const char * /* partitionLabel */ = nullptr) {
+		ns = &Shim_Nvs[name];
+		return true;
+	}
+	void end() { ns = nullptr; }
+	bool clear() {
+		ns->clear();
+		return true;
+	}
+	bool remove(const char *key) { return ns->erase(key) > 0; }
+	bool isKey(const char *key) { return ns->count(key) > 0; }
+	Shim_NvsNamespace &entries() { return *ns; }
+
+	size_t putBytes(const char *key, const void *value, const size_t length) {
+		const uint8_t *data = (const uint8_t *) value;
+		(*ns)[key] = std::vector<uint8_t>(data, data + length);
+		return length;
+	}
+	size_t getBytesLength(const char *key) { return isKey(key) ? (*ns)[key].size() : 0; }
+	size_t getBytes(const char *key, void *buffer, const size_t maxLength) {
+		if (!isKey(key) || (*ns)[key].size() > maxLength) {
+			return 0;
+		}
+		memcpy(buffer, (*ns)[key].data(), (*ns)[key].size());
+		return (*ns)[key].size();
+	}
+
+	size_t putString(const char *key, const char *value) { return putBytes(key, value, strlen(value) + 1); }
+	size_t putString(const char *key, const String &value) { return putString(key, value.c_str()); }
+	String getString(const char *key, const String defaultValue = String()) { return isKey(key) ? String((const char *) (*ns)[key].data()) : defaultValue; }
+
+	size_t putBool(const char *key, const bool value) { return put(key, (uint8_t) value); }
+	size_t putUChar(const char *key, const uint8_t value) { return put(key, value); }
+	size_t putUShort(const char *key, const uint16_t value) { return put(key, value); }
+	size_t putUInt(const char *key, const uint32_t value) { return put(key, value); }
+	size_t putULong(const char *key, const uint32_t value) { return put(key, value); }
+	size_t putFloat(const char *key, const float value) { return put(key, value); }
+	bool getBool(const char *key, const bool defaultValue = false) { return get(key, (uint8_t) defaultValue); }
+	uint8_t getUChar(const char *key, const uint8_t defaultValue = 0) { return get(key, defaultValue); }
+	uint16_t getUShort(const char *key, const uint16_t defaultValue = 0) { return get(key, defaultValue); }
+	uint32_t getUInt(const char *key, const uint32_t defaultValue = 0) { return get(key, defaultValue); }
+	uint32_t getULong(const char *key, const uint32_t defaultValue = 0) { return get(key, defaultValue); }
+	float getFloat(const char *key, const float defaultValue = NAN) { return get(key, defaultValue); }
+
+private:
+	Shim_NvsNamespace *ns = nullptr;
+
+	template <typename T>
+	size_t put(const char *key, const T value) {
+		return putBytes(key, &value, sizeof(T));
+	}
+	template <typename T>
+	T get(const char *key, const T defaultValue) {
+		T value;
+		return (getBytes(key, &value, sizeof(T)) == sizeof(T)) ? value : defaultValue;
+	}
+};
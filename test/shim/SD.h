@@ -0,0 +1,6 @@
+// Host-shim (native env): SD-card is a directory of the host, see FS.h
+#pragma once
+
+#include "FS.h"
+
+inline fs::SDFS SD;
@@ -0,0 +1,4 @@
+// Host-shim (native env): see FS.h
+#pragma once
+
+#include "FS.h"
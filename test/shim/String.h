@@ -0,0 +1,4 @@
+// Host-shim (native env): firmware includes "String.h" (resolved to string.h on case-insensitive file-systems)
+#pragma once
+
+#include <string.h>
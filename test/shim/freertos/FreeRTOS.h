@@ -0,0 +1,162 @@
+// Host-shim of FreeRTOS (native env). Single-threaded: tasks aren't started, nothing blocks.
+// Queues and queue-sets keep their items, so a test can send an item and run one iteration of the receiving task's body.
+#pragma once
+
+#include <deque>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void *TaskHandle_t;
+
+#define pdFALSE				 0
+#define pdTRUE				 1
+#define pdPASS				 pdTRUE
+#define pdFAIL				 pdFALSE
+#define errQUEUE_FULL		 0
+#define portMAX_DELAY		 0xffffffffu
+#define portTICK_PERIOD_MS	 1
+#define pdMS_TO_TICKS(ms)	 ((TickType_t) (ms))
+#define configMAX_TASK_NAME_LEN 16
+#define tskNO_AFFINITY		 0x7fffffff
+
+typedef struct {
+	uint32_t owner;
+	uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0, 0}
+#define portENTER_CRITICAL(mux)		 ((mux)->count++)
+#define portEXIT_CRITICAL(mux)		 ((mux)->count--)
+#define portENTER_CRITICAL_ISR(mux)	 portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)	 portEXIT_CRITICAL(mux)
+
+struct Shim_Queue {
+	size_t itemSize;
+	size_t length;
+	std::deque<std::vector<uint8_t>> items;
+	struct Shim_QueueSet *set = nullptr;
+};
+
+struct Shim_QueueSet {
+	std::vector<Shim_Queue *> members;
+};
+
+typedef Shim_Queue *QueueHandle_t;
+typedef Shim_QueueSet *QueueSetHandle_t;
+typedef Shim_Queue *QueueSetMemberHandle_t;
+typedef Shim_Queue *SemaphoreHandle_t;
+
+inline QueueHandle_t xQueueCreate(const UBaseType_t length, const UBaseType_t itemSize) {
+	QueueHandle_t queue = new Shim_Queue;
+	queue->itemSize = itemSize;
+	queue->length = length;
+	return queue;
+}
+
+inline void vQueueDelete(QueueHandle_t queue) {
+	delete queue;
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t) {
+	if (queue->items.size() >= queue->length) {
+		return errQUEUE_FULL;
+	}
+	const uint8_t *data = (const uint8_t *) item;
+	queue->items.emplace_back(data, data + queue->itemSize);
+	return pdPASS;
+}
+
+#define xQueueSendToBack(queue, item, ticks) xQueueSend(queue, item, ticks)
+
+inline BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item) {
+	queue->items.clear();
+	return xQueueSend(queue, item, 0);
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t) {
+	if (queue->items.empty()) {
+		return pdFAIL;
+	}
+	memcpy(item, queue->items.front().data(), queue->itemSize);
+	queue->items.pop_front();
+	return pdPASS;
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(const QueueHandle_t queue) {
+	return queue->items.size();
+}
+
+inline BaseType_t xQueueReset(QueueHandle_t queue) {
+	queue->items.clear();
+	return pdPASS;
+}
+
+inline QueueSetHandle_t xQueueCreateSet(const UBaseType_t) {
+	return new Shim_QueueSet;
+}
+
+inline BaseType_t xQueueAddToSet(QueueSetMemberHandle_t queue, QueueSetHandle_t set) {
+	queue->set = set;
+	set->members.push_back(queue);
+	return pdPASS;
+}
+
+inline QueueSetMemberHandle_t xQueueSelectFromSet(QueueSetHandle_t set, TickType_t) {
+	for (QueueSetMemberHandle_t queue : set->members) {
+		if (!queue->items.empty()) {
+			return queue;
+		}
+	}
+	return nullptr;
+}
+
+// Semaphores/mutexes: nobody else can hold them
+inline SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+	return xQueueCreate(1, 0);
+}
+
+#define xSemaphoreCreateRecursiveMutex()			xSemaphoreCreateMutex()
+#define xSemaphoreCreateBinary()					xSemaphoreCreateMutex()
+#define xSemaphoreTake(semaphore, ticks)			((void) (semaphore), pdTRUE)
+#define xSemaphoreGive(semaphore)					((void) (semaphore), pdTRUE)
+#define xSemaphoreTakeRecursive(semaphore, ticks) ((void) (semaphore), pdTRUE)
+#define xSemaphoreGiveRecursive(semaphore)		((void) (semaphore), pdTRUE)
+#define vSemaphoreDelete(semaphore)				vQueueDelete(semaphore)
+
+// Tasks aren't run: a test calls the functions of a task's body itself
+inline TaskHandle_t Shim_TaskHandle = (TaskHandle_t) &Shim_TaskHandle;
+
+inline BaseType_t xTaskCreatePinnedToCore(void (*)(void *), const char *, uint32_t, void *, UBaseType_t, TaskHandle_t *handle, BaseType_t) {
+	if (handle) {
+		*handle = Shim_TaskHandle;
+	}
+	return pdPASS;
+}
+
+inline BaseType_t xTaskCreate(void (*task)(void *), const char *name, uint32_t stackSize, void *parameter, UBaseType_t priority, TaskHandle_t *handle) {
+	return xTaskCreatePinnedToCore(task, name, stackSize, parameter, priority, handle, tskNO_AFFINITY);
+}
+
+inline void vTaskDelete(TaskHandle_t) {
+}
+
+inline void vTaskSuspend(TaskHandle_t) {
+}
+
+inline void vTaskResume(TaskHandle_t) {
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+	return Shim_TaskHandle;
+}
+
+inline void xTaskNotifyGive(TaskHandle_t) {
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) {
+	return 0;
+}
@@ -0,0 +1,4 @@
+// Host-shim (native env): everything is in freertos/FreeRTOS.h
+#pragma once
+
+#include "freertos/FreeRTOS.h"
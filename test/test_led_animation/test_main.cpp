@@ -0,0 +1,203 @@
+// Unit-tests of the LED-animation-engine and previews of the default animations (pio test -e native -f test_led_animation -v).
+// If LED_ANIMATION_PREVIEWS is set, every default animation is written as PPM (one row per frame of 20 ms, one pixel per LED)
+// to this directory, e.g. to check a changed animation without hardware.
+
+#include <stdint.h>
+
+// LED-settings of settings.h (defaults)
+#define NUM_INDICATOR_LEDS 16
+#define NUM_LEDS_IDLE_DOTS 3
+#define OFFSET_PAUSE_LEDS  false
+#define PROGRESS_HUE_START 85
+#define PROGRESS_HUE_END   -1
+constexpr uint16_t intervalToLongPress = 700;
+
+#include "LedAnimationDefaults.h"
+
+#include <algorithm>
+#include <stdlib.h>
+#include <unity.h>
+
+constexpr uint16_t previewFrameInterval = 20u;
+
+static ledRgb_t frame[NUM_INDICATOR_LEDS];
+
+static bool isLit(const ledRgb_t &led) {
+	return led.r || led.g || led.b;
+}
+
+void setUp(void) {
+	memset(frame, 0, sizeof(frame));
+}
+
+void tearDown(void) {
+}
+
+static void test_sample_interpolates(void) {
+	const ledAnimation_t anim = {LED_PATTERN_FILL, 0, 0, 2, 0, {{0, {0, 0, 0}, 0, 0}, {1000, {200, 100, 0}, 200, 64}}};
+
+	const ledKeyframe_t middle = LedAnimation_Sample(anim, 500);
+	TEST_ASSERT_EQUAL_UINT8(100, middle.color.r);
+	TEST_ASSERT_EQUAL_UINT8(50, middle.color.g);
+	TEST_ASSERT_EQUAL_UINT8(100, middle.level);
+	TEST_ASSERT_EQUAL_UINT8(32, middle.position);
+	// last keyframe is kept after the end
+	TEST_ASSERT_EQUAL_UINT8(200, LedAnimation_Sample(anim, 5000).level);
+	TEST_ASSERT_TRUE(LedAnimation_Finished(anim, 1000));
+	TEST_ASSERT_FALSE(LedAnimation_Finished(anim, 999));
+}
+
+static void test_sample_step_and_loop(void) {
+	const ledAnimation_t anim = {LED_PATTERN_FILL, LED_ANIMATION_STEP | LED_ANIMATION_LOOP, 0, 3, 0, {{0, {255, 0, 0}, 255, 0}, {100, {0, 0, 0}, 255, 0}, {200, {0, 0, 0}, 255, 0}}};
+
+	TEST_ASSERT_EQUAL_UINT8(255, LedAnimation_Sample(anim, 99).color.r);
+	TEST_ASSERT_EQUAL_UINT8(0, LedAnimation_Sample(anim, 100).color.r);
+	TEST_ASSERT_EQUAL_UINT8(255, LedAnimation_Sample(anim, 250).color.r); // second loop
+	TEST_ASSERT_FALSE(LedAnimation_Finished(anim, 100000));
+}
+
+static void test_bar(void) {
+	const ledAnimation_t anim = {LED_PATTERN_BAR, 0, 0, 1, 0, {{0, {0, 0, 255}, 255, 0}}};
+	ledAnimationInput_t input;
+	input.level = 136; // 8.5 LEDs
+
+	LedAnimation_Render(anim, input, frame, NUM_INDICATOR_LEDS);
+	for (uint8_t led = 0; led < 8; led++) {
+		TEST_ASSERT_EQUAL_UINT8(255, frame[led].b);
+	}
+	TEST_ASSERT_UINT8_WITHIN(16, 128, frame[8].b); // last LED dimmed
+	TEST_ASSERT_FALSE(isLit(frame[9]));
+	TEST_ASSERT_FALSE(isLit(frame[15]));
+}
+
+static void test_dots_rotate(void) {
+	const ledAnimation_t anim = {LED_PATTERN_DOTS, LED_ANIMATION_LOOP, 3, 1, 500, {{0, {255, 255, 255}, 255, 0}}};
+
+	LedAnimation_Render(anim, 0, frame, NUM_INDICATOR_LEDS);
+	for (uint8_t led = 0; led < NUM_INDICATOR_LEDS; led++) {
+		TEST_ASSERT_EQUAL(led == 0 || led == 5 || led == 10, isLit(frame[led]));
+	}
+	// one LED further every 500 ms
+	LedAnimation_Render(anim, 1000, frame, NUM_INDICATOR_LEDS);
+	for (uint8_t led = 0; led < NUM_INDICATOR_LEDS; led++) {
+		TEST_ASSERT_EQUAL(led == 2 || led == 7 || led == 12, isLit(frame[led]));
+	}
+	// position of the input starts the pattern exactly at the given LED
+	ledAnimationInput_t input;
+	input.position = LedAnimation_Position(15, NUM_INDICATOR_LEDS);
+	LedAnimation_Render(anim, input, frame, NUM_INDICATOR_LEDS);
+	TEST_ASSERT_TRUE(isLit(frame[15]));
+	TEST_ASSERT_TRUE(isLit(frame[4]));
+	TEST_ASSERT_FALSE(isLit(frame[0]));
+}
+
+static void test_mask(void) {
+	const ledAnimation_t anim = {LED_PATTERN_BAR, LED_ANIMATION_MASK, 0, 2, 0, {{0, {0, 0, 0}, 255, 0}, {1600, {0, 0, 0}, 0, 0}}};
+	for (uint8_t led = 0; led < NUM_INDICATOR_LEDS; led++) {
+		frame[led] = {10, 20, led};
+	}
+
+	LedAnimation_Render(anim, 400, frame, NUM_INDICATOR_LEDS); // 12 LEDs left, last one dimmed
+	TEST_ASSERT_EQUAL_UINT8(10, frame[0].r);
+	TEST_ASSERT_EQUAL_UINT8(10, frame[10].b);
+	TEST_ASSERT_LESS_THAN_UINT8(20, frame[11].g);
+	TEST_ASSERT_FALSE(isLit(frame[12]));
+	TEST_ASSERT_FALSE(isLit(frame[15]));
+}
+
+static void test_input_color_and_palette(void) {
+	const ledAnimation_t anim = LedAnimation_WithPalette({LED_PATTERN_FILL, 0, 0, 1, 0, {{0, {0, 0, 0}, 255, 0}}}, ledColorRed, ledColorRed, ledColorBlue, ledColorBlue);
+	ledAnimationInput_t input;
+
+	LedAnimation_Render(anim, input, frame, NUM_INDICATOR_LEDS);
+	TEST_ASSERT_EQUAL_UINT8(255, frame[0].r);
+	TEST_ASSERT_EQUAL_UINT8(255, frame[15].b);
+	TEST_ASSERT_EQUAL_UINT8(255, LedAnimation_Gradient(anim, 255).b);
+
+	input.overrideColor = true;
+	input.color = ledColorYellow;
+	LedAnimation_Render(anim, input, frame, NUM_INDICATOR_LEDS);
+	TEST_ASSERT_EQUAL_UINT8(255, frame[15].g);
+	TEST_ASSERT_EQUAL_UINT8(0, frame[15].b);
+}
+
+static void test_hue(void) {
+	TEST_ASSERT_EQUAL_UINT8(255, LedAnimation_Hue(0).r);
+	TEST_ASSERT_EQUAL_UINT8(255, LedAnimation_Hue(96).g);
+	TEST_ASSERT_EQUAL_UINT8(255, LedAnimation_Hue(160).b);
+	TEST_ASSERT_EQUAL_UINT8(0, LedAnimation_Hue(160).r);
+}
+
+static void test_next_change(void) {
+	const ledAnimation_t interpolated = {LED_PATTERN_FILL, 0, 0, 2, 0, {{0, {0, 0, 0}, 0, 0}, {1000, {0, 0, 0}, 255, 0}}};
+	const ledAnimation_t stepped = {LED_PATTERN_FILL, LED_ANIMATION_STEP, 0, 2, 0, {{0, {0, 0, 0}, 0, 0}, {1000, {0, 0, 0}, 255, 0}}};
+	const ledAnimation_t constant = {LED_PATTERN_FILL, LED_ANIMATION_LOOP, 0, 1, 0, {{0, {255, 0, 0}, 255, 0}}};
+	const ledAnimation_t rotating = {LED_PATTERN_DOTS, LED_ANIMATION_LOOP, 3, 1, 500, {{0, {255, 0, 0}, 255, 0}}};
+
+	TEST_ASSERT_EQUAL_UINT32(0, LedAnimation_NextChange(interpolated, 100));
+	TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, LedAnimation_NextChange(interpolated, 1000));
+	TEST_ASSERT_EQUAL_UINT32(900, LedAnimation_NextChange(stepped, 100));
+	TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, LedAnimation_NextChange(constant, 12345));
+	TEST_ASSERT_EQUAL_UINT32(380, LedAnimation_NextChange(rotating, 620));
+	// a looping animation changes with its first keyframe again
+	TEST_ASSERT_EQUAL_UINT32(100, LedAnimation_NextChange(LedAnimation_Defaults[LED_TIMELINE_BOOT], 900));
+}
+
+static void test_defaults_valid(void) {
+	for (uint8_t i = 0; i < LED_TIMELINE_COUNT; i++) {
+		const ledAnimation_t &anim = LedAnimation_Defaults[i];
+		TEST_ASSERT_GREATER_THAN_UINT8_MESSAGE(0, anim.numKeyframes, LedAnimation_TimelineNames[i]);
+		TEST_ASSERT_LESS_OR_EQUAL_UINT8_MESSAGE(ledAnimationMaxKeyframes, anim.numKeyframes, LedAnimation_TimelineNames[i]);
+		for (uint8_t k = 1; k < anim.numKeyframes; k++) {
+			TEST_ASSERT_GREATER_THAN_UINT16_MESSAGE(anim.keyframes[k - 1].time, anim.keyframes[k].time, LedAnimation_TimelineNames[i]);
+		}
+	}
+}
+
+// Writes every default animation as PPM; looping animations are shown for two cycles, all for at least 1 s
+static void test_write_previews(void) {
+	const char *dir = getenv("LED_ANIMATION_PREVIEWS");
+	if (dir == nullptr || *dir == '\0') {
+		TEST_IGNORE_MESSAGE("LED_ANIMATION_PREVIEWS not set, no previews written");
+	}
+	char path[256];
+	char msg[320];
+	for (uint8_t i = 0; i < LED_TIMELINE_COUNT; i++) {
+		const ledAnimation_t &anim = LedAnimation_Defaults[i];
+		uint32_t duration = LedAnimation_Duration(anim);
+		if (anim.flags & LED_ANIMATION_LOOP) {
+			duration = 2u * (anim.rotateInterval ? anim.rotateInterval * NUM_INDICATOR_LEDS : duration);
+		}
+		const uint16_t numFrames = std::max<uint32_t>(duration, 1000u) / previewFrameInterval;
+		// inputs of the state-dependent animations as shown by the device
+		ledAnimationInput_t input;
+		if (i == LED_TIMELINE_VOLUME || i == LED_TIMELINE_PROGRESS || i == LED_TIMELINE_BATTERY) {
+			input.level = 192;
+		}
+
+		snprintf(path, sizeof(path), "%s/led_%s.ppm", dir, LedAnimation_TimelineNames[i]);
+		FILE *file = fopen(path, "wb");
+		TEST_ASSERT_NOT_NULL_MESSAGE(file, path);
+		TEST_ASSERT_TRUE(LedAnimation_WritePpm(file, anim, input, NUM_INDICATOR_LEDS, previewFrameInterval, numFrames));
+		const long size = ftell(file);
+		fclose(file);
+		TEST_ASSERT_GREATER_OR_EQUAL((long) (numFrames * NUM_INDICATOR_LEDS * sizeof(ledRgb_t)), size);
+		snprintf(msg, sizeof(msg), "%s (%u frames)", path, numFrames);
+		TEST_MESSAGE(msg);
+	}
+}
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_sample_interpolates);
+	RUN_TEST(test_sample_step_and_loop);
+	RUN_TEST(test_bar);
+	RUN_TEST(test_dots_rotate);
+	RUN_TEST(test_mask);
+	RUN_TEST(test_input_color_and_palette);
+	RUN_TEST(test_hue);
+	RUN_TEST(test_next_change);
+	RUN_TEST(test_defaults_valid);
+	RUN_TEST(test_write_previews);
+	return UNITY_END();
+}
@@ -0,0 +1,168 @@
+// Unit-tests of the host-compilable playlist-helpers (pio test -e native)
+
+#include "Playlist.h"
+
+#include <unity.h>
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static void test_sort(void) {
+	char a[] = "/music/b.mp3", b[] = "/music/C.mp3", c[] = "/music/a.mp3", d[] = "/music/a.mp3";
+	char *files[] = {a, b, c, d};
+
+	Playlist_Sort(files, 4);
+	// strcmp(): upper case before lower case, duplicates are kept
+	TEST_ASSERT_EQUAL_STRING("/music/C.mp3", files[0]);
+	TEST_ASSERT_EQUAL_STRING("/music/a.mp3", files[1]);
+	TEST_ASSERT_EQUAL_STRING("/music/a.mp3", files[2]);
+	TEST_ASSERT_EQUAL_STRING("/music/b.mp3", files[3]);
+
+	Playlist_Sort(files, 0); // mustn't touch anything
+	TEST_ASSERT_EQUAL_STRING("/music/C.mp3", files[0]);
+}
+
+static void test_randomize_is_permutation(void) {
+	constexpr uint32_t count = 100;
+	char names[count][8];
+	char *files[count];
+	for (uint32_t i = 0; i < count; i++) {
+		snprintf(names[i], sizeof(names[i]), "%03u", i);
+		files[i] = names[i];
+	}
+
+	srand(1);
+	Playlist_Randomize(files, count);
+	uint32_t moved = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		moved += (files[i] != names[i]);
+	}
+	TEST_ASSERT_GREATER_THAN(count / 2, moved);
+
+	// every entry is still there exactly once
+	Playlist_Sort(files, count);
+	for (uint32_t i = 0; i < count; i++) {
+		TEST_ASSERT_TRUE(files[i] == names[i]);
+	}
+}
+
+static void test_randomize_small(void) {
+	char a[] = "a";
+	char *files[] = {a};
+
+	Playlist_Randomize(files, 0);
+	Playlist_Randomize(files, 1);
+	TEST_ASSERT_TRUE(files[0] == a);
+}
+
+static void test_parse_rfid_entry(void) {
+	rfidEntry_t entry;
+
+	TEST_ASSERT_TRUE(Playlist_ParseRfidEntry("#/music/abc#1234#3#7", '#', entry));
+	TEST_ASSERT_EQUAL_STRING("/music/abc", entry.file);
+	TEST_ASSERT_EQUAL_UINT32(1234, entry.lastPlayPos);
+	TEST_ASSERT_EQUAL_UINT32(3, entry.playMode);
+	TEST_ASSERT_EQUAL_UINT16(7, entry.trackLastPlayed);
+}
+
+static void test_parse_rfid_entry_skips_empty_fields(void) {
+	rfidEntry_t entry;
+
+	// like strtok(): consecutive delimiters don't make an empty field
+	TEST_ASSERT_TRUE(Playlist_ParseRfidEntry("##/music##0#5##1#", '#', entry));
+	TEST_ASSERT_EQUAL_STRING("/music", entry.file);
+	TEST_ASSERT_EQUAL_UINT32(0, entry.lastPlayPos);
+	TEST_ASSERT_EQUAL_UINT32(5, entry.playMode);
+	TEST_ASSERT_EQUAL_UINT16(1, entry.trackLastPlayed);
+}
+
+static void test_parse_rfid_entry_invalid(void) {
+	rfidEntry_t entry;
+
+	TEST_ASSERT_FALSE(Playlist_ParseRfidEntry("", '#', entry));
+	TEST_ASSERT_FALSE(Playlist_ParseRfidEntry("#/music#0#3", '#', entry));
+	TEST_ASSERT_FALSE(Playlist_ParseRfidEntry("#/music#0#3#1#9", '#', entry));
+
+	// file-name is truncated to the size of the buffer
+	char str[400] = "#";
+	memset(str + 1, 'x', 300);
+	strcpy(str + 301, "#0#3#1");
+	TEST_ASSERT_TRUE(Playlist_ParseRfidEntry(str, '#', entry));
+	TEST_ASSERT_EQUAL_size_t(sizeof(entry.file) - 1, strlen(entry.file));
+	TEST_ASSERT_EQUAL_UINT32(3, entry.playMode);
+}
+
+static void test_append_and_count(void) {
+	char list[64] = "";
+	size_t length = 0;
+
+	length = Playlist_Append(list, length, "/a.mp3", 6, '#');
+	length = Playlist_Append(list, length, "/b.mp3", 6, '#');
+	length = Playlist_Append(list, length, "/c.mp3", 6, '#');
+	TEST_ASSERT_EQUAL_STRING("#/a.mp3#/b.mp3#/c.mp3", list);
+	TEST_ASSERT_EQUAL_size_t(strlen(list), length);
+	TEST_ASSERT_EQUAL_UINT32(3, Playlist_Count(list, '#'));
+	TEST_ASSERT_EQUAL_UINT32(0, Playlist_Count("", '#'));
+}
+
+static void test_append_large_list(void) {
+	// 10000 entries as in a huge directory; length has to match what strcat() would have produced
+	constexpr uint32_t count = 10000;
+	char *list = (char *) malloc(count * 16 + 1);
+	TEST_ASSERT_NOT_NULL(list);
+	size_t length = 0;
+	size_t expectedLength = 0;
+	char name[16];
+	for (uint32_t i = 0; i < count; i++) {
+		const size_t nameLength = snprintf(name, sizeof(name), "/%u.mp3", i);
+		length = Playlist_Append(list, length, name, nameLength, '#');
+		expectedLength += nameLength + 1;
+	}
+	TEST_ASSERT_EQUAL_size_t(expectedLength, length);
+	TEST_ASSERT_EQUAL_size_t(length, strlen(list));
+	TEST_ASSERT_EQUAL_UINT32(count, Playlist_Count(list, '#'));
+	TEST_ASSERT_EQUAL_STRING("#/9999.mp3", strrchr(list, '#'));
+	free(list);
+}
+
+static void test_file_valid(void) {
+	TEST_ASSERT_TRUE(Playlist_FileValid("/music/a.mp3"));
+	TEST_ASSERT_TRUE(Playlist_FileValid("/music/B.FLAC"));
+	TEST_ASSERT_TRUE(Playlist_FileValid("/music/list.m3u8"));
+	TEST_ASSERT_TRUE(Playlist_FileValid("/.music/a.mp3")); // only the file-name counts
+	TEST_ASSERT_FALSE(Playlist_FileValid("/music/._a.mp3"));
+	TEST_ASSERT_FALSE(Playlist_FileValid("/music/cover.jpg"));
+	TEST_ASSERT_FALSE(Playlist_FileValid("/music/a.mp3.txt"));
+	TEST_ASSERT_FALSE(Playlist_FileValid("/music/mp3"));
+	TEST_ASSERT_FALSE(Playlist_FileValid(""));
+}
+
+static void test_hash(void) {
+	char a[] = "/a.mp3", b[] = "/b.mp3", ab[] = "/a.mp3/b.mp3";
+	char *files[] = {a, b};
+	char *swapped[] = {b, a};
+	char *joined[] = {ab};
+
+	TEST_ASSERT_EQUAL_UINT32(Playlist_Hash(files, 2), Playlist_Hash(files, 2));
+	TEST_ASSERT_NOT_EQUAL_UINT32(Playlist_Hash(files, 2), Playlist_Hash(swapped, 2));
+	// entries are separated, so splitting differently changes the hash
+	TEST_ASSERT_NOT_EQUAL_UINT32(Playlist_Hash(files, 2), Playlist_Hash(joined, 1));
+}
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_sort);
+	RUN_TEST(test_randomize_is_permutation);
+	RUN_TEST(test_randomize_small);
+	RUN_TEST(test_parse_rfid_entry);
+	RUN_TEST(test_parse_rfid_entry_skips_empty_fields);
+	RUN_TEST(test_parse_rfid_entry_invalid);
+	RUN_TEST(test_append_and_count);
+	RUN_TEST(test_append_large_list);
+	RUN_TEST(test_file_valid);
+	RUN_TEST(test_hash);
+	return UNITY_END();
+}
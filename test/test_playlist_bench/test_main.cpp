@@ -0,0 +1,187 @@
+// Host-benchmark of playlist-generation of the firmware: SdCard_ReturnPlaylist() in directory-mode + sort/shuffle for
+// synthetic directories of 10/100/1000 files (pio test -e native -f test_playlist_bench -v).
+// SD-card is a directory of the host (test/shim/FS.h), so only the CPU-part of the firmware-path is measured.
+// Timings are reported only; asserts are limited to scaling (time per file mustn't grow with the number of files).
+
+#include "LogMessages_DE.cpp"
+#include "LogMessages_EN.cpp"
+#include "MemX.cpp"
+#include "SdCard.cpp"
+
+#include <unity.h>
+
+constexpr uint8_t benchRuns = 25u; // per directory-size; minimum and median are reported
+
+enum benchStage_t : uint8_t {
+	BENCH_GENERATE = 0, // SdCard_ReturnPlaylist(): enumerate directory, filter, serialize and split
+	BENCH_SORT, // sort playlist alphabetically
+	BENCH_SHUFFLE, // randomize playlist
+	BENCH_STAGE_COUNT
+};
+
+static const char *benchStageNames[BENCH_STAGE_COUNT] = {"generate", "sort", "shuffle"};
+
+static char benchRoot[] = "/tmp/playlist_bench_XXXXXX";
+
+void Log_Println(const char *, const uint8_t) {
+}
+
+int Log_Printf(const uint8_t, const char *, ...) {
+	return 0;
+}
+
+void System_IndicateError(void) {
+}
+
+// Creates a directory with numFiles audio-files and some files that are filtered out (cover, hidden files of macOS)
+static void benchCreateDirectory(const char *path, const uint16_t numFiles) {
+	char fileName[255];
+	gFSystem.mkdir(path);
+	for (uint16_t i = 0; i < numFiles; i++) {
+		snprintf(fileName, sizeof(fileName), "%s/%04u - Track of an audiobook with a long title.mp3", path, (numFiles - i) * 7919u % 10000u);
+		gFSystem.open(fileName, FILE_WRITE).close();
+		if (i % 10 == 0) {
+			snprintf(fileName, sizeof(fileName), "%s/._%04u.mp3", path, i);
+			gFSystem.open(fileName, FILE_WRITE).close();
+		}
+	}
+	snprintf(fileName, sizeof(fileName), "%s/cover.jpg", path);
+	gFSystem.open(fileName, FILE_WRITE).close();
+}
+
+static void benchRemoveDirectory(const char *path) {
+	File dir = gFSystem.open(path);
+	for (String fileName = dir.getNextFileName(); !fileName.isEmpty(); fileName = dir.getNextFileName()) {
+		gFSystem.remove(fileName.c_str());
+	}
+	dir.close();
+	gFSystem.rmdir(path);
+}
+
+// Same steps as the firmware does for ALL_TRACKS_OF_DIR_RANDOM. Returns number of files of the playlist (or 0 on error).
+static uint32_t benchGeneratePlaylist(const char *path, uint32_t durations[BENCH_STAGE_COUNT]) {
+	uint32_t mark = micros();
+	auto markStage = [&](const benchStage_t stage) {
+		const uint32_t now = micros();
+		durations[stage] = now - mark;
+		mark = now;
+	};
+
+	char **files = SdCard_ReturnPlaylist(path, ALL_TRACKS_OF_DIR_RANDOM);
+	markStage(BENCH_GENERATE);
+	if (files == nullptr) {
+		return 0;
+	}
+	const uint32_t cnt = strtoul(files[-1], NULL, 10);
+	Playlist_Sort(files, cnt);
+	markStage(BENCH_SORT);
+	Playlist_Randomize(files, cnt);
+	markStage(BENCH_SHUFFLE);
+	return cnt;
+}
+
+static int benchCompare(const void *a, const void *b) {
+	const uint32_t x = *(const uint32_t *) a;
+	const uint32_t y = *(const uint32_t *) b;
+	return (x > y) - (x < y);
+}
+
+// Runs the firmware-path benchRuns times, reports every stage and returns median of the whole path (in µs)
+static uint32_t benchDirectory(const uint16_t numFiles) {
+	char path[16];
+	snprintf(path, sizeof(path), "/%u", numFiles);
+	benchCreateDirectory(path, numFiles);
+
+	uint32_t durations[BENCH_STAGE_COUNT][benchRuns];
+	uint32_t totals[benchRuns];
+	uint32_t run[BENCH_STAGE_COUNT];
+	benchGeneratePlaylist(path, run); // warm-up (directory-cache, heap)
+	for (uint8_t r = 0; r < benchRuns; r++) {
+		TEST_ASSERT_EQUAL_UINT32(numFiles, benchGeneratePlaylist(path, run));
+		totals[r] = 0;
+		for (uint8_t s = 0; s < BENCH_STAGE_COUNT; s++) {
+			durations[s][r] = run[s];
+			totals[r] += run[s];
+		}
+	}
+
+	char msg[160];
+	for (uint8_t s = 0; s < BENCH_STAGE_COUNT; s++) {
+		qsort(durations[s], benchRuns, sizeof(uint32_t), benchCompare);
+		snprintf(msg, sizeof(msg), "%4u files: %-8s min %6u us, median %6u us", numFiles, benchStageNames[s], durations[s][0], durations[s][benchRuns / 2]);
+		TEST_MESSAGE(msg);
+	}
+	qsort(totals, benchRuns, sizeof(uint32_t), benchCompare);
+	snprintf(msg, sizeof(msg), "%4u files: total    min %6u us, median %6u us", numFiles, totals[0], totals[benchRuns / 2]);
+	TEST_MESSAGE(msg);
+
+	benchRemoveDirectory(path);
+	return totals[benchRuns / 2];
+}
+
+// Serializes numFiles names (as the scan of SdCard_ReturnPlaylist() does, but without directory-access) and returns
+// minimum time per file (in ns)
+static uint32_t benchSerialize(const uint16_t numFiles) {
+	char *names = (char *) malloc((size_t) numFiles * 128u);
+	char *list = (char *) malloc((size_t) numFiles * 128u + 2u);
+	TEST_ASSERT_NOT_NULL(names);
+	TEST_ASSERT_NOT_NULL(list);
+	for (uint16_t i = 0; i < numFiles; i++) {
+		snprintf(names + i * 128u, 128u, "/audiobooks/%04u - Track of an audiobook with a long title.mp3", i);
+	}
+
+	uint32_t best = UINT32_MAX;
+	for (uint8_t r = 0; r < benchRuns; r++) {
+		const auto start = std::chrono::steady_clock::now();
+		size_t length = 0;
+		for (uint16_t i = 0; i < numFiles; i++) {
+			const char *name = names + i * 128u;
+			length = Playlist_Append(list, length, name, strlen(name), stringDelimiter[0]);
+		}
+		const uint32_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		TEST_ASSERT_EQUAL_UINT32(numFiles, Playlist_Count(list, stringDelimiter[0]));
+		if (duration < best) {
+			best = duration;
+		}
+	}
+	free(names);
+	free(list);
+	return best / numFiles;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static void test_playlist_generation(void) {
+	benchDirectory(10);
+	const uint32_t median100 = benchDirectory(100);
+	const uint32_t median1000 = benchDirectory(1000);
+
+	// sorting makes it n*log(n): ten times the files may take up to 20 times longer (quadratic would be ~100 times)
+	TEST_ASSERT_LESS_THAN_UINT32(median100 * 20u + 1u, median1000);
+}
+
+static void test_playlist_serialize_linear(void) {
+	const uint32_t perFile100 = benchSerialize(100);
+	const uint32_t perFile1000 = benchSerialize(1000);
+
+	char msg[80];
+	snprintf(msg, sizeof(msg), "serialize per file: %u ns (100 files), %u ns (1000 files)", perFile100, perFile1000);
+	TEST_MESSAGE(msg);
+	// has to stay linear: a quadratic one (e.g. strlen()/strcat() per file) takes about ten times longer per file
+	TEST_ASSERT_LESS_THAN_UINT32(perFile100 * 4u + 1u, perFile1000);
+}
+
+int main(void) {
+	TEST_ASSERT_NOT_NULL(mkdtemp(benchRoot));
+	Shim_FsRoot = benchRoot;
+	UNITY_BEGIN();
+	RUN_TEST(test_playlist_generation);
+	RUN_TEST(test_playlist_serialize_linear);
+	const int result = UNITY_END();
+	rmdir(benchRoot);
+	return result;
+}
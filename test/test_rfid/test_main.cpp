@@ -0,0 +1,331 @@
+// Tests of RFID-dispatching (gestures, lookup of RFID-tags in NVS and Cmd_Action()) on the host (pio test -e native -f test_rfid).
+// NVS is test/shim/Preferences.h, the modules that are called by the dispatcher are replaced by stubs that record the calls.
+
+#include "LogMessages_DE.cpp"
+#include "LogMessages_EN.cpp"
+#include "Cmd.cpp"
+#include "Queues.cpp"
+#include "RfidCommon.cpp"
+
+#include <unity.h>
+
+// Calls of the stubs
+typedef struct {
+	uint32_t trackQueued;
+	char file[255];
+	uint32_t playMode;
+	uint32_t errors;
+	uint32_t oks;
+	uint8_t sleepTimer;
+	bool controlsLocked;
+	uint8_t operationMode;
+	uint32_t websocketUpdates;
+} stubCalls_t;
+
+static stubCalls_t calls;
+
+playProps gPlayProperties;
+Preferences gPrefsRfid;
+TaskHandle_t rfidTaskHandle;
+
+void Log_Println(const char *, const uint8_t) {
+}
+int Log_Printf(const uint8_t, const char *, ...) {
+	return 0;
+}
+void AudioPlayer_VolumeToQueueSender(const int32_t, bool) {
+}
+void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t, const uint32_t _playMode, const uint16_t) {
+	calls.trackQueued++;
+	strncpy(calls.file, _itemToPlay, sizeof(calls.file) - 1);
+	calls.playMode = _playMode;
+}
+void AudioPlayer_TrackControlToQueueSender(const uint8_t) {
+}
+uint8_t AudioPlayer_GetCurrentVolume(void) {
+	return 5;
+}
+uint8_t AudioPlayer_GetInitVolume(void) {
+	return 5;
+}
+void Battery_PublishMQTT(void) {
+}
+void Battery_LogStatus(void) {
+}
+void Bluetooth_PlayPauseTrack(void) {
+}
+void Bluetooth_NextTrack(void) {
+}
+void Bluetooth_PreviousTrack(void) {
+}
+void Bluetooth_SetVolume(const int32_t, bool) {
+}
+void Ftp_EnableServer(void) {
+}
+void Led_Indicate(LedIndicatorType) {
+}
+void Led_SetNightmode(bool) {
+}
+void Led_ToggleNightmode() {
+}
+void Web_SendWebsocketData(uint32_t, uint8_t) {
+	calls.websocketUpdates++;
+}
+bool Wlan_IsConnected(void) {
+	return false;
+}
+void Wlan_ToggleEnable(void) {
+}
+void System_UpdateActivityTimer(void) {
+}
+void System_RequestSleep(void) {
+}
+void System_Restart(void) {
+}
+bool System_SetSleepTimer(uint8_t minutes) {
+	calls.sleepTimer = minutes;
+	return true;
+}
+void System_DisableSleepTimer() {
+	calls.sleepTimer = 0;
+}
+void System_ToggleLockControls(void) {
+	calls.controlsLocked = !calls.controlsLocked;
+}
+bool System_AreControlsLocked(void) {
+	return calls.controlsLocked;
+}
+void System_IndicateError(void) {
+	calls.errors++;
+}
+void System_IndicateOk(void) {
+	calls.oks++;
+}
+void System_SetOperationMode(uint8_t opMode) {
+	calls.operationMode = opMode;
+}
+uint8_t System_GetOperationMode(void) {
+	return calls.operationMode;
+}
+uint8_t System_GetOperationModeFromNvs(void) {
+	return calls.operationMode;
+}
+void System_esp_print_tasks(void) {
+}
+void TapTrace_Mark(const tapTraceStage_t) {
+}
+void TapTrace_Abort(void) {
+}
+bool listNVSKeys(const char *_namespace, void *data, bool (*callback)(const char *key, void *data)) {
+	for (const auto &entry : Shim_Nvs[_namespace]) {
+		if (!callback(entry.first.c_str(), data)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// One iteration of the dispatcher-task: takes the next id out of the id-queues and dispatches it
+static void dispatchNext(void) {
+	char newId[ID_STRING_SIZE];
+	QueueSetMemberHandle_t queue = xQueueSelectFromSet(gIdQueueSet, portMAX_DELAY);
+	TEST_ASSERT_NOT_NULL(queue);
+	TEST_ASSERT_EQUAL(pdPASS, xQueueReceive(queue, &newId, 0));
+	Rfid_Dispatch(queue, newId);
+}
+
+// Card applied: as sent by the reader
+static void applyCard(const char *cardId) {
+	TEST_ASSERT_EQUAL(pdPASS, xQueueSend(gRfidCardQueue, cardId, 0));
+	dispatchNext();
+}
+
+static const char cardA[] = "123045067089";
+static const char cardB[] = "200100050025";
+
+void setUp(void) {
+	memset(&calls, 0, sizeof(calls));
+	calls.operationMode = OPMODE_NORMAL;
+	memset(&gPlayProperties, 0, sizeof(gPlayProperties));
+	gPlayProperties.playMode = NO_PLAYLIST;
+	Shim_Nvs.clear();
+	gPrefsRfid.begin("rfidTags");
+	gPrefsRfid.putString(cardA, "#/cards/a#0#3#0");
+	gPrefsRfid.putString(cardB, "#/cards/b#0#3#0");
+	Shim_AdvanceMillis(rfidSequenceTimeout); // no sequence with the cards of the previous test
+}
+
+void tearDown(void) {
+}
+
+static void test_lookup_known_card(void) {
+	gPrefsRfid.putString("123045067089", "#/audiobooks/story#0#3#0");
+
+	Rfid_PreferenceLookupHandler("123045067089");
+	TEST_ASSERT_EQUAL_STRING("123045067089", gCurrentId);
+	TEST_ASSERT_EQUAL_UINT32(1, calls.trackQueued);
+	TEST_ASSERT_EQUAL_STRING("/audiobooks/story", calls.file);
+	TEST_ASSERT_EQUAL_UINT32(AUDIOBOOK, calls.playMode);
+	TEST_ASSERT_EQUAL_UINT32(0, calls.errors);
+	TEST_ASSERT_TRUE(calls.websocketUpdates > 0); // new id is shown in GUI
+}
+
+static void test_lookup_unknown_card(void) {
+	calls.operationMode = OPMODE_BLUETOOTH_SINK;
+
+	Rfid_PreferenceLookupHandler("001002003004");
+	TEST_ASSERT_EQUAL_STRING("001002003004", gCurrentId);
+	TEST_ASSERT_EQUAL_UINT32(0, calls.trackQueued);
+	TEST_ASSERT_EQUAL_UINT32(1, calls.errors);
+	TEST_ASSERT_EQUAL_UINT8(OPMODE_NORMAL, calls.operationMode); // unknown card escapes from BT-mode
+}
+
+static void test_lookup_invalid_entry(void) {
+	gPrefsRfid.putString("123045067089", "#/audiobooks/story#0");
+
+	Rfid_PreferenceLookupHandler("123045067089");
+	TEST_ASSERT_EQUAL_UINT32(0, calls.trackQueued);
+	TEST_ASSERT_EQUAL_UINT32(1, calls.errors);
+}
+
+// playmode >= 100: modification-card is executed by Cmd_Action()
+static void test_lookup_modification_card(void) {
+	char entry[32];
+	snprintf(entry, sizeof(entry), "#0#0#%u#0", CMD_SLEEP_TIMER_MOD_30);
+	gPrefsRfid.putString("200201202203", entry);
+	gPlayProperties.sleepAfterPlaylist = true;
+
+	Rfid_PreferenceLookupHandler("200201202203");
+	TEST_ASSERT_EQUAL_UINT32(0, calls.trackQueued);
+	TEST_ASSERT_EQUAL_UINT8(30, calls.sleepTimer);
+	TEST_ASSERT_FALSE(gPlayProperties.sleepAfterPlaylist); // overwritten by sleep-timer
+	TEST_ASSERT_EQUAL_UINT32(1, calls.oks);
+}
+
+static void test_cmd_action(void) {
+	Cmd_Action(CMD_LOCK_BUTTONS_MOD);
+	TEST_ASSERT_TRUE(calls.controlsLocked);
+	Cmd_Action(CMD_LOCK_BUTTONS_MOD);
+	TEST_ASSERT_FALSE(calls.controlsLocked);
+
+	// not allowed without playlist
+	Cmd_Action(CMD_SLEEP_AFTER_END_OF_TRACK);
+	TEST_ASSERT_FALSE(gPlayProperties.sleepAfterCurrentTrack);
+	TEST_ASSERT_EQUAL_UINT32(1, calls.errors);
+	gPlayProperties.playMode = ALL_TRACKS_OF_DIR_SORTED;
+	Cmd_Action(CMD_SLEEP_AFTER_END_OF_TRACK);
+	TEST_ASSERT_TRUE(gPlayProperties.sleepAfterCurrentTrack);
+}
+
+static void test_gesture_id(void) {
+	char gestureId[ID_STRING_SIZE];
+
+	Rfid_GestureId(gestureId, RFID_GESTURE_SEQUENCE, cardA, cardB);
+	TEST_ASSERT_EQUAL_UINT32(ID_STRING_SIZE - 1u, strlen(gestureId));
+	TEST_ASSERT_EQUAL_INT(0, strncmp(gestureId, "91", 2));
+	Rfid_GestureId(gestureId, RFID_GESTURE_HOLD, cardA, nullptr);
+	TEST_ASSERT_EQUAL_UINT32(ID_STRING_SIZE - 1u, strlen(gestureId));
+	TEST_ASSERT_EQUAL_INT(0, strncmp(gestureId, "92", 2));
+}
+
+// Card A followed by card B, the sequence is assigned: B is replaced by the sequence
+static void test_sequence_gesture(void) {
+	char gestureId[ID_STRING_SIZE];
+	Rfid_GestureId(gestureId, RFID_GESTURE_SEQUENCE, cardA, cardB);
+	gPrefsRfid.putString(gestureId, "#/cards/a-then-b#0#5#0");
+	Rfid_GesturesRebuild();
+
+	applyCard(cardA);
+	TEST_ASSERT_EQUAL_STRING("/cards/a", calls.file); // single card doesn't wait for a possible sequence
+	applyCard(cardB);
+	TEST_ASSERT_EQUAL_STRING(gestureId, gCurrentId);
+	TEST_ASSERT_EQUAL_STRING("/cards/a-then-b", calls.file);
+	TEST_ASSERT_EQUAL_UINT32(2, calls.trackQueued);
+
+	// the second card of a sequence doesn't start another one
+	applyCard(cardB);
+	TEST_ASSERT_EQUAL_STRING(cardB, gCurrentId);
+	TEST_ASSERT_EQUAL_STRING("/cards/b", calls.file);
+}
+
+static void test_sequence_timeout(void) {
+	char gestureId[ID_STRING_SIZE];
+	Rfid_GestureId(gestureId, RFID_GESTURE_SEQUENCE, cardA, cardB);
+	gPrefsRfid.putString(gestureId, "#/cards/a-then-b#0#5#0");
+	Rfid_GesturesRebuild();
+
+	applyCard(cardA);
+	Shim_AdvanceMillis(rfidSequenceTimeout);
+	applyCard(cardB);
+	TEST_ASSERT_EQUAL_STRING(cardB, gCurrentId);
+	TEST_ASSERT_EQUAL_STRING("/cards/b", calls.file);
+}
+
+// Unassigned sequence: card B is played, the sequence is offered in GUI for assignment
+static void test_sequence_not_assigned(void) {
+	char gestureId[ID_STRING_SIZE];
+	Rfid_GestureId(gestureId, RFID_GESTURE_SEQUENCE, cardB, cardA);
+	Rfid_GesturesRebuild();
+
+	applyCard(cardB);
+	applyCard(cardA);
+	TEST_ASSERT_EQUAL_STRING(cardA, gCurrentId);
+	TEST_ASSERT_EQUAL_STRING("/cards/a", calls.file);
+	TEST_ASSERT_EQUAL_STRING(gestureId, Rfid_GetUnassignedGestureId());
+}
+
+// Hold-gesture as sent by the reader (RfidReader.h) after rfidHoldTime
+static void test_hold_gesture(void) {
+	char holdId[ID_STRING_SIZE];
+	Rfid_GestureId(holdId, RFID_GESTURE_HOLD, cardA, nullptr);
+	gPrefsRfid.putString(holdId, "#/cards/a-hold#0#5#0");
+	Rfid_GesturesRebuild();
+
+	applyCard(cardA);
+	applyCard(holdId);
+	TEST_ASSERT_EQUAL_STRING(holdId, gCurrentId);
+	TEST_ASSERT_EQUAL_STRING("/cards/a-hold", calls.file);
+
+	// unassigned hold of card B doesn't touch playback
+	Rfid_GestureId(holdId, RFID_GESTURE_HOLD, cardB, nullptr);
+	applyCard(holdId);
+	TEST_ASSERT_EQUAL_STRING("/cards/a-hold", calls.file);
+	TEST_ASSERT_EQUAL_STRING(holdId, Rfid_GetUnassignedGestureId());
+}
+
+// Button-ids and injected ids are padded to the size of a queue-item and are no part of a sequence
+static void test_injected_ids(void) {
+	char gestureId[ID_STRING_SIZE];
+	Rfid_GestureId(gestureId, RFID_GESTURE_SEQUENCE, cardA, cardB);
+	gPrefsRfid.putString(gestureId, "#/cards/a-then-b#0#5#0");
+	gPrefsRfid.putString("BTN4_SHORT", "#/buttons/4#0#3#0");
+	Rfid_GesturesRebuild();
+
+	TEST_ASSERT_TRUE(Rfid_SendId(gRfidInjectQueue, cardA));
+	dispatchNext();
+	applyCard(cardB);
+	TEST_ASSERT_EQUAL_STRING(cardB, gCurrentId);
+
+	Cmd_Action(CMD_BUTTON_4_ID_SHORT);
+	dispatchNext();
+	TEST_ASSERT_EQUAL_STRING("BTN4_SHORT", gCurrentId);
+	TEST_ASSERT_EQUAL_STRING("/buttons/4", calls.file);
+}
+
+int main(void) {
+	Queues_Init();
+	Cmd_Init();
+	UNITY_BEGIN();
+	RUN_TEST(test_lookup_known_card);
+	RUN_TEST(test_lookup_unknown_card);
+	RUN_TEST(test_lookup_invalid_entry);
+	RUN_TEST(test_lookup_modification_card);
+	RUN_TEST(test_cmd_action);
+	RUN_TEST(test_gesture_id);
+	RUN_TEST(test_sequence_gesture);
+	RUN_TEST(test_sequence_timeout);
+	RUN_TEST(test_sequence_not_assigned);
+	RUN_TEST(test_hold_gesture);
+	RUN_TEST(test_injected_ids);
+	return UNITY_END();
+}
@@ -0,0 +1,165 @@
+// Tests of playlist-generation of the firmware (SdCard_ReturnPlaylist() & co.) on the host (pio test -e native -f test_sdcard).
+// SD-card is a temporary directory of the host (test/shim/FS.h).
+
+#include "LogMessages_DE.cpp"
+#include "LogMessages_EN.cpp"
+#include "MemX.cpp"
+#include "SdCard.cpp"
+
+#include <unity.h>
+
+static char sdRoot[] = "/tmp/sdcard_test_XXXXXX";
+static uint32_t indicatedErrors = 0;
+
+void Log_Println(const char *, const uint8_t) {
+}
+
+int Log_Printf(const uint8_t, const char *, ...) {
+	return 0;
+}
+
+void System_IndicateError(void) {
+	indicatedErrors++;
+}
+
+static void sdWriteFile(const char *path, const char *content = "") {
+	File file = gFSystem.open(path, FILE_WRITE);
+	TEST_ASSERT_TRUE_MESSAGE((bool) file, path);
+	file.print(content);
+	file.close();
+}
+
+static bool playlistContains(char **files, const uint32_t count, const char *path) {
+	for (uint32_t i = 0; i < count; i++) {
+		if (strcmp(files[i], path) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static uint32_t playlistCount(char **files) {
+	return strtoul(files[-1], nullptr, 10);
+}
+
+void setUp(void) {
+	indicatedErrors = 0;
+}
+
+void tearDown(void) {
+}
+
+static void test_directory(void) {
+	gFSystem.mkdir("/album");
+	gFSystem.mkdir("/album/bonus");
+	sdWriteFile("/album/01 - intro.mp3");
+	sdWriteFile("/album/02 - song.M4A");
+	sdWriteFile("/album/03 - live.flac");
+	sdWriteFile("/album/._01 - intro.mp3"); // hidden file of macOS
+	sdWriteFile("/album/cover.jpg");
+	sdWriteFile("/album/bonus/04 - bonus.mp3"); // subdirectories aren't part of the playlist
+
+	char **files = SdCard_ReturnPlaylist("/album", ALL_TRACKS_OF_DIR_SORTED);
+	TEST_ASSERT_NOT_NULL(files);
+	TEST_ASSERT_EQUAL_UINT32(3, playlistCount(files));
+	TEST_ASSERT_TRUE(playlistContains(files, 3, "/album/01 - intro.mp3"));
+	TEST_ASSERT_TRUE(playlistContains(files, 3, "/album/02 - song.M4A"));
+	TEST_ASSERT_TRUE(playlistContains(files, 3, "/album/03 - live.flac"));
+
+	// same order as the player does it
+	Playlist_Sort(files, playlistCount(files));
+	TEST_ASSERT_EQUAL_STRING("/album/01 - intro.mp3", files[0]);
+	TEST_ASSERT_EQUAL_STRING("/album/03 - live.flac", files[2]);
+	TEST_ASSERT_EQUAL_UINT32(0, indicatedErrors);
+}
+
+static void test_empty_directory(void) {
+	gFSystem.mkdir("/empty");
+	sdWriteFile("/empty/readme.txt");
+
+	char **files = SdCard_ReturnPlaylist("/empty", ALL_TRACKS_OF_DIR_SORTED);
+	TEST_ASSERT_NOT_NULL(files);
+	TEST_ASSERT_EQUAL_UINT32(0, playlistCount(files));
+}
+
+static void test_single_file(void) {
+	sdWriteFile("/single.mp3");
+
+	char **files = SdCard_ReturnPlaylist("/single.mp3", SINGLE_TRACK);
+	TEST_ASSERT_NOT_NULL(files);
+	TEST_ASSERT_EQUAL_UINT32(1, playlistCount(files));
+	TEST_ASSERT_EQUAL_STRING("/single.mp3", files[0]);
+}
+
+static void test_missing(void) {
+	TEST_ASSERT_NULL(SdCard_ReturnPlaylist("/doesnt/exist", ALL_TRACKS_OF_DIR_SORTED));
+}
+
+static void test_m3u(void) {
+	sdWriteFile("/list.m3u", "#EXTM3U\r\n#EXTINF:123,Intro\r\n/album/01 - intro.mp3\r\n\r\nhttp://radio.example/stream\n\n/album/02 - song.M4A\n");
+
+	char **files = SdCard_ReturnPlaylist("/list.m3u", LOCAL_M3U);
+	TEST_ASSERT_NOT_NULL(files);
+	TEST_ASSERT_EQUAL_UINT32(3, playlistCount(files));
+	TEST_ASSERT_EQUAL_STRING("/album/01 - intro.mp3", files[0]);
+	TEST_ASSERT_EQUAL_STRING("http://radio.example/stream", files[1]);
+	TEST_ASSERT_EQUAL_STRING("/album/02 - song.M4A", files[2]);
+}
+
+static void test_write_playlist_roundtrip(void) {
+	char a[] = "/album/01 - intro.mp3", b[] = "/album/03 - live.flac";
+	char *written[] = {a, b};
+
+	TEST_ASSERT_TRUE(SdCard_WritePlaylist("/resume.m3u", written, 2));
+	char **files = SdCard_ReturnPlaylist("/resume.m3u", LOCAL_M3U);
+	TEST_ASSERT_NOT_NULL(files);
+	TEST_ASSERT_EQUAL_UINT32(2, playlistCount(files));
+	TEST_ASSERT_EQUAL_STRING(a, files[0]);
+	TEST_ASSERT_EQUAL_STRING(b, files[1]);
+}
+
+static void test_random_subdirectory(void) {
+	gFSystem.mkdir("/stories");
+	gFSystem.mkdir("/stories/one");
+	gFSystem.mkdir("/stories/two");
+	sdWriteFile("/stories/not-a-directory.mp3");
+
+	char directory[255];
+	for (uint8_t i = 0; i < 10; i++) {
+		strncpy(directory, "/stories", sizeof(directory));
+		const char *picked = SdCard_pickRandomSubdirectory(directory);
+		TEST_ASSERT_NOT_NULL(picked);
+		TEST_ASSERT_TRUE_MESSAGE(strcmp(picked, "/stories/one") == 0 || strcmp(picked, "/stories/two") == 0, picked);
+	}
+}
+
+static void removeRecursive(const std::string &path) {
+	DIR *dir = opendir(path.c_str());
+	if (dir == nullptr) {
+		unlink(path.c_str());
+		return;
+	}
+	for (struct dirent *entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+		if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, "..")) {
+			removeRecursive(path + "/" + entry->d_name);
+		}
+	}
+	closedir(dir);
+	rmdir(path.c_str());
+}
+
+int main(void) {
+	TEST_ASSERT_NOT_NULL(mkdtemp(sdRoot));
+	Shim_FsRoot = sdRoot;
+	UNITY_BEGIN();
+	RUN_TEST(test_directory);
+	RUN_TEST(test_empty_directory);
+	RUN_TEST(test_single_file);
+	RUN_TEST(test_missing);
+	RUN_TEST(test_m3u);
+	RUN_TEST(test_write_playlist_roundtrip);
+	RUN_TEST(test_random_subdirectory);
+	const int result = UNITY_END();
+	removeRecursive(sdRoot);
+	return result;
+}